@@ -59,15 +59,25 @@ namespace bufr {
         File file_;
 
         /// \brief Exports collected data into a DataContainer
-        /// \param srcData Data to export
-        std::shared_ptr<DataContainer> exportData(const BufrDataMap& srcData);
+        /// \param srcData Data to export (taken by value since it is filtered and split in
+        ///        place)
+        std::shared_ptr<DataContainer> exportData(BufrDataMap srcData);
+
+        /// \brief Let the filters drop subsets while the file is read (only possible when every
+        ///        subset makes one row, so not when any of the queries is grouped).
+        /// \param querySet The query set that is executed to collect the data.
+        void pushDownFilters(QuerySet& querySet) const;
 
         /// \brief Function responsible for dividing the data into subcategories.
-        /// \details This function is intended to be called over and over for each specified Split
-        ///          object, sub-splitting the data given into all the possible subcategories.
-        /// \param splitMaps Pre-split map of data.
-        /// \param split Object that knows how to split data.
-        CatDataMap splitData(CatDataMap& splitMaps, Split& split);
+        /// \details The categories of all the splits are combined into one key per row, so every
+        ///          field is sliced once into the final subcategories (rather than once per
+        ///          split). Only the subcategories that have rows are in the result.
+        /// \param srcData Data to split.
+        /// \param splits Objects that know how to split data.
+        /// \param catMap The categories of the splits (gives the order of the category keys).
+        CatDataMap splitData(const BufrDataMap& srcData,
+                             const Export::Splits& splits,
+                             const CategoryMap& catMap);
 
         /// \brief Opens a BUFR file using the Fortran BUFR interface.
         /// \param filepath Path to bufr file.
@@ -6,6 +6,9 @@
 */
 
 
+#include <list>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -16,52 +19,62 @@
 
 namespace bufr {
 
+  /// \brief Counters that describe how the DataCache has been used (see DataCache::getStats).
+  struct DataCacheStats
+  {
+    /// Number of has or get calls that found an entry (in memory or spilled to disk)
+    size_t hits = 0;
+
+    /// Number of has or get calls that found no entry
+    size_t misses = 0;
+
+    /// Number of times an entry was spilled to disk to stay within the memory budget
+    size_t evictions = 0;
+
+    /// Number of times a spilled entry was read back from disk by get
+    size_t reloads = 0;
+
+    /// Number of entries in the cache (in memory or spilled)
+    size_t numEntries = 0;
+
+    /// Number of bytes of data held in memory (including spilled entries whose data is still
+    /// used outside the cache)
+    size_t memoryBytes = 0;
+
+    /// Number of bytes of data held in spill files
+    size_t spilledBytes = 0;
+  };
+
   /// \brief A singleton class that holds the data cache. The cache is a map of unique keys
   /// (srcPath + mapPath) to a "CacheEntry" which contains a DataContainer and some metadata. The
   /// clients can mark a category as finished, and when all categories are finished, the entry is
   /// removed from the cache. If the application finishes running and there are still entries in the
   /// cache, a warning is printed.
+  ///
+  /// The cache is safe to use from several threads. The data held in memory is kept within a byte
+  /// budget (see setMemoryBudget): when it is exceeded the least recently used entries are
+  /// spilled to a binary file (see setSpillDir) and read back the next time they are requested.
+  /// Spilling an entry only frees its memory once nothing outside the cache uses its data, so
+  /// until then it is still counted as memory (and get hands out the same data again).
   class DataCache {
     public:
       DataCache(DataCache const&) = delete;
       void operator=(DataCache const&) = delete;
 
-      ~DataCache()
-      {
-        if (!cache_.empty())
-        {
-//          log::info() << "DataCache destructor called with non-empty cache.";
-        }
-      }
+      ~DataCache();
 
       /// \brief Check if the cache contains an entry for the given srcPath and mapPath.
       /// \param srcPath The path to the source file.
       /// \param mapPath The path to the map file.
       /// \return True if the cache contains an entry for the given srcPath and mapPath.
-      static bool has(const std::string& srcPath, const std::string& mapPath)
-      {
-          auto& cache = instance().cache_;
-          auto key = makeKey(srcPath, mapPath);
+      static bool has(const std::string& srcPath, const std::string& mapPath);
 
-          return cache.find(key) != cache.end();
-      }
-
-      /// \brief Get the DataContainer for the given srcPath and mapPath.
+      /// \brief Get the DataContainer for the given srcPath and mapPath (read back from its
+      ///        spill file if it was evicted).
       /// \param srcPath The path to the source file.
       /// \param mapPath The path to the map file.
       static std::shared_ptr<DataContainer> get(const std::string& srcPath,
-                                                const std::string& mapPath)
-      {
-          auto& cache = instance().cache_;
-          auto key = makeKey(srcPath, mapPath);
-
-          if (cache.find(key) == cache.end())
-          {
-            throw eckit::BadParameter("DataCache::get: No cache entry for key " + key);
-          }
-
-          return cache[key].data;
-      }
+                                                const std::string& mapPath);
 
       /// \brief Add a DataContainer to the cache.
       /// \param srcPath The path to the source file.
@@ -71,19 +84,7 @@ namespace bufr {
       static void add(const std::string& srcPath,
                       const std::string& mapPath,
                       const std::vector<std::vector<std::string>>& cachedCategories,
-                      std::shared_ptr<DataContainer> data)
-      {
-          auto& cache = instance().cache_;
-          auto key = makeKey(srcPath, mapPath);
-
-          if (cache.find(key) != cache.end())
-          {
-            return;
-          }
-
-          cache[key].data = data;
-          cache[key].cachedCategories = cachedCategories;
-      }
+                      std::shared_ptr<DataContainer> data);
 
       /// \brief Mark a category as finished. Delete entry when all "cachedCategories" are finished.
       /// \param srcPath The path to the source file.
@@ -91,59 +92,116 @@ namespace bufr {
       /// \param category The category to mark as finished.
       static void markFinished(const std::string& srcPath,
                                const std::string& mapPath,
-                               const std::vector<std::string>& category)
-      {
-          auto& cache = instance().cache_;
-          auto key = makeKey(srcPath, mapPath);
-
-          if (cache.find(key) == cache.end())
-          {
-            throw eckit::BadParameter("DataCache::markFinished: No cache entry for key " + key);
-          }
-
-          if (std::find(cache[key].cachedCategories.begin(),
-                        cache[key].cachedCategories.end(), category)
-              == cache[key].cachedCategories.end())
-          {
-//                log::info() << "DataCache::markFinished called with category that " \
-//                                     "is not cached.";
-                return;
-          }
-
-          cache[key].finishedCategories.push_back(category);
-
-          if (cache[key].finishedCategories.size() == cache[key].cachedCategories.size())
-          {
-            cache.erase(key);
-          }
-      }
+                               const std::vector<std::string>& category);
 
-    private:
+      /// \brief Set the number of bytes of data the cache may hold in memory (unlimited by
+      ///        default). Least recently used entries are spilled to disk until the cache fits.
+      ///        The entry that was just added or requested is never spilled, so it may exceed
+      ///        the budget on its own.
+      /// \param bytes The memory budget in bytes.
+      static void setMemoryBudget(size_t bytes);
 
-      /// \brief Get the singleton instance of the DataCache.
-      static DataCache& instance()
-      {
-        static DataCache instance;
-        return instance;
-      }
+      /// \brief Get the number of bytes of data the cache may hold in memory.
+      static size_t getMemoryBudget();
+
+      /// \brief Set the directory spill files are written to ($TMPDIR or /tmp by default).
+      /// \param path The path to the directory.
+      static void setSpillDir(const std::string& path);
+
+      /// \brief Get the usage counters of the cache.
+      static DataCacheStats getStats();
+
+      /// \brief Reset the hit, miss, eviction and reload counters.
+      static void resetStats();
 
+    private:
       typedef std::string Key;
 
+      /// \brief Where the data of an object went in a spill file.
+      struct SpilledObject {
+        SubCategory category;
+        std::string fieldName;
+        Dimensions dims;
+        size_t bytes = 0;
+      };
+
       struct CacheEntry {
         std::vector<std::vector<std::string>> cachedCategories;
         std::vector<std::vector<std::string>> finishedCategories;
+
+        /// The data (null while the entry is spilled)
         std::shared_ptr<DataContainer> data;
+
+        /// Number of bytes of data in the container
+        size_t bytes = 0;
+
+        /// Copy of the container with empty objects (only set while the entry is spilled)
+        std::shared_ptr<DataContainer> emptyData;
+
+        /// The spilled data, which is still counted as memory while it is used outside the cache
+        std::weak_ptr<DataContainer> spilledData;
+        bool spilledDataInUse = false;
+        std::string spillPath;
+        std::vector<SpilledObject> spilledObjects;
+
+        /// Position of the key in the LRU list
+        std::list<Key>::iterator lruPos;
       };
 
-      DataCache() {}
+      DataCache();
 
+      std::mutex mutex_;
       std::unordered_map<Key, CacheEntry> cache_;
 
+      /// Keys ordered from most to least recently used
+      std::list<Key> lru_;
+
+      size_t memoryBudget_;
+      std::string spillDir_;
+      size_t numSpillFiles_ = 0;
+      DataCacheStats stats_;
+
+      /// \brief Get the singleton instance of the DataCache.
+      static DataCache& instance()
+      {
+        static DataCache instance;
+        return instance;
+      }
+
       /// \brief Make a unique key from the given srcPath and mapPath.
       static std::string makeKey(const std::string& srcPath, const std::string& mapPath)
       {
         return srcPath + " " + mapPath;
       }
+
+      /// \brief Get the number of bytes of data held by the objects of a container, counted the
+      ///        way their spill file stores them (views and broadcast objects count the values
+      ///        they read, not the buffer they point into).
+      static size_t containerBytes(const DataContainer& data);
+
+      /// \brief Move an entry to the front of the LRU list.
+      void touch(CacheEntry& entry);
+
+      /// \brief Spill the least recently used entries until the data in memory fits the budget.
+      /// \param keep The key of an entry that must stay in memory.
+      void evict(const Key& keep);
+
+      /// \brief Write the data of an entry to a spill file and drop it from memory.
+      void spill(CacheEntry& entry);
+
+      /// \brief Read the data of a spilled entry back from its spill file (or take it back if it
+      ///        is still used outside the cache).
+      void reload(CacheEntry& entry);
+
+      /// \brief Count the memory of spilled entries whose data is no longer used outside the
+      ///        cache as freed.
+      void releaseSpilled();
+
+      /// \brief Drop the spill file and spill state of an entry.
+      void clearSpill(CacheEntry& entry);
+
+      /// \brief Remove an entry (and its spill file).
+      void erase(const Key& key);
   };
 
 }  // namespace bufr
@@ -2,9 +2,11 @@
 
 #pragma once
 
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "BufrTypes.h"
@@ -25,6 +27,13 @@ namespace bufr {
   /// Map category combo (ex: SatId/sat_1, GeoBox/lat_25_30__lon_23_26) to the relevant DataSetMap
   typedef std::map<std::vector<std::string>, DataSetMap> DataSets;
 
+  /// \brief Hash for subcategories (so they can be looked up without comparing them string by
+  ///        string like a std::map does).
+  struct SubCategoryHash
+  {
+    size_t operator()(const SubCategory& categoryId) const;
+  };
+
   /// \brief Collection of DataObjects that a Parser collected identified by their exported name
   class DataContainer {
   public:
@@ -59,6 +68,14 @@ namespace bufr {
     std::shared_ptr<DataObjectBase> get(const std::string& fieldName,
                                         const SubCategory& categoryId = {}) const;
 
+    /// \brief Get a DataObject only to look at its metadata (dims, dim paths, type, field
+    ///        names). Unlike get, it doesn't wait for a gather started with gatherAsync: the
+    ///        dims are already the gathered ones but the data may not have arrived yet.
+    /// \param fieldName The name of the data object to get
+    /// \param categoryId The vector<string> for the subcategory
+    std::shared_ptr<const DataObjectBase> getMetadata(const std::string& fieldName,
+                                                      const SubCategory& categoryId = {}) const;
+
     /// \brief Get list of dimensioning paths for the field
     /// \param fieldName The name of the data object to get
     /// \param categoryId The vector<string> for the subcategory
@@ -71,6 +88,13 @@ namespace bufr {
     std::shared_ptr<DataObjectBase> getGroupByObject(const std::string& fieldName,
                                                      const SubCategory& categoryId = {}) const;
 
+    /// \brief Get the DataObject for the group by field only to look at its metadata (see
+    ///        getMetadata).
+    /// \param fieldName The name of the data object to get
+    /// \param categoryId The vector<string> for the subcategory
+    std::shared_ptr<const DataObjectBase> getGroupByMetadata(
+      const std::string& fieldName, const SubCategory& categoryId = {}) const;
+
     /// \brief Check if DataObject with name is available
     /// \param fieldName The name of the object
     /// \param categoryId The vector<string> for the subcategory
@@ -80,16 +104,19 @@ namespace bufr {
     /// \param categoryId The vector<string> for the subcategory
     bool hasCategory(const SubCategory& categoryId) const;
 
-    /// \brief Get a new data-container for the specified sub-category
+    /// \brief Get a new data-container for the specified sub-category. It is a view that shares
+    ///        the fields of this container (nothing is copied) until either of them adds or
+    ///        replaces a field.
     /// \param categoryId The vector<string> for the subcategory
     std::shared_ptr<DataContainer> getSubContainer(const SubCategory& categoryId) const;
 
-    /// \brief Get the number of rows of the specified sub category
+    /// \brief Get the number of rows of the specified sub category (worked out once and then
+    ///        remembered until the fields change).
     /// \param categoryId The vector<string> for the subcategory
     size_t size(const SubCategory& categoryId = {}) const;
 
-    /// \brief Get the number of rows of the specified sub category
-    std::vector<SubCategory> allSubCategories() const;
+    /// \brief Get all the sub categories (in sorted order).
+    const std::vector<SubCategory>& allSubCategories() const { return subCategories_; }
 
     /// \brief Get the map of categories
     inline CategoryMap getCategoryMap() const { return categoryMap_; }
@@ -105,6 +132,14 @@ namespace bufr {
     /// \param other DataContainer to append.
     void append(const DataContainer& other);
 
+    /// \brief Make a container with the data of several containers one after the other (ex:
+    ///        the containers of several BUFR files). Unlike appending them one at a time, the
+    ///        category maps, fields and dimensions are checked up front and every field is
+    ///        sized once and filled in parallel. Empty containers are skipped.
+    /// \param containers The containers to concatenate.
+    static std::shared_ptr<DataContainer> concat(
+      const std::vector<std::shared_ptr<DataContainer>>& containers);
+
     /// \brief Gather data from all ranks into rank 0.
     /// \param comm MPI communicator to use.
     void gather(const eckit::mpi::Comm& comm);
@@ -113,15 +148,114 @@ namespace bufr {
     /// \param comm MPI communicator to use.
     void allGather(const eckit::mpi::Comm& comm);
 
+    /// \brief Start gathering data from all ranks into rank 0 without waiting for it to arrive.
+    ///        Each object is moved with its own non-blocking MPI_Igatherv. On rank 0 an object
+    ///        is unpacked the first time it is accessed (get, getGroupByObject, size), so an
+    ///        encoder can write the first variables while the rest are still arriving. The
+    ///        dims of the objects on rank 0 are the gathered ones right away, so getMetadata
+    ///        never waits. Every
+    ///        rank must call waitForGather before MPI is finalized (a container destroyed
+    ///        after that gives up on the gather). The data is unpacked into copies of the
+    ///        objects, so sub containers that share them keep the data they had.
+    /// \param comm MPI communicator to use.
+    void gatherAsync(const eckit::mpi::Comm& comm);
+
+    /// \brief Wait for a gather started with gatherAsync to finish (does nothing if there
+    ///        isn't one).
+    void waitForGather() const;
+
+    /// \brief Pad the dimensions of every object to the largest ones on any rank (missing
+    ///        values fill the gaps), without moving any data between the ranks. After this all
+    ///        the ranks agree on every dimension except the number of rows, so they can write
+    ///        their own rows into one shared file. The objects are replaced with padded copies,
+    ///        so sub containers (and anyone else holding the objects) keep the dims they had.
+    /// \param comm MPI communicator to use.
+    void alignDims(const eckit::mpi::Comm& comm);
+
   private:
     /// Category map given (see constructor).
     CategoryMap categoryMap_;
 
-    /// Map of data for each possible subcategory
-    DataSets dataSets_;
+    /// Value of DataSet::numRows before the number of rows is known.
+    static constexpr size_t UnknownRows = std::numeric_limits<size_t>::max();
+
+    /// \brief The fields of a subcategory. Sub containers share them with the container they
+    ///        came from until one of the two changes them (copy on write).
+    struct DataSet
+    {
+      DataSetMap fields;
+
+      /// Number of rows (worked out the first time size() needs it)
+      mutable size_t numRows = UnknownRows;
+    };
+
+    /// All the possible subcategories (sorted)
+    std::vector<SubCategory> subCategories_;
+
+    /// Data for each subcategory (in the order of subCategories_)
+    std::vector<std::shared_ptr<DataSet>> dataSets_;
+
+    /// Index of each subcategory in subCategories_
+    std::unordered_map<SubCategory, size_t, SubCategoryHash> categoryIdxs_;
+
+    /// Objects still being received by a gather started with gatherAsync
+    struct PendingGather;
+    mutable std::shared_ptr<PendingGather> pendingGather_;
 
     /// \brief Uses category map to generate listings of all possible subcategories.
     void makeDataSets();
+
+    /// \brief Make empty data sets for a list of subcategories and index them.
+    /// \param subCategories The subcategories.
+    void setSubCategories(std::vector<SubCategory> subCategories);
+
+    /// \brief Find the data set of a subcategory.
+    /// \param categoryId The vector<string> for the subcategory
+    /// \return The data set or nullptr if there is no such subcategory.
+    const DataSet* findDataSet(const SubCategory& categoryId) const;
+
+    /// \brief Find an object (throws if there is no such field or subcategory).
+    /// \param fieldName The name of the data object
+    /// \param categoryId The vector<string> for the subcategory
+    const std::shared_ptr<DataObjectBase>& findObject(const std::string& fieldName,
+                                                      const SubCategory& categoryId) const;
+
+    /// \brief Find the object of the group by field of an object (the object itself if it
+    ///        has no group by field).
+    /// \param fieldName The name of the data object
+    /// \param categoryId The vector<string> for the subcategory
+    const std::shared_ptr<DataObjectBase>& findGroupByObject(const std::string& fieldName,
+                                                             const SubCategory& categoryId) const;
+
+    /// \brief Get the fields of a subcategory for changing them (makes our own copy of the
+    ///        data set if it is shared with a sub container).
+    /// \param categoryId The vector<string> for the subcategory (must exist)
+    DataSetMap& mutableFields(const SubCategory& categoryId);
+
+    /// \brief Forget the number of rows of every subcategory (call when objects change size).
+    void resetRowCounts();
+
+    /// \brief Gather the data objects of every subcategory. The dims of all the objects are
+    ///        agreed on with one allReduce and one allGatherv, and the data is packed into a
+    ///        single buffer per rank and moved with one gatherv (or allGatherv), instead of
+    ///        several collectives per object. Falls back to gathering the objects one at a
+    ///        time if the data is too big for one MPI message.
+    /// \param comm MPI communicator to use.
+    /// \param toAllRanks Distribute the data to all the ranks (allGather) instead of rank 0.
+    void gatherObjects(const eckit::mpi::Comm& comm, bool toAllRanks);
+
+    /// \brief Get the objects of every subcategory in the order gather sends them.
+    std::vector<std::shared_ptr<DataObjectBase>> allObjects() const;
+
+    /// \brief Replace every object with a copy only this container holds (the copies share
+    ///        the data until it is replaced), so gathering into them leaves the objects of
+    ///        sub containers alone.
+    /// \return The copies in the same order as allObjects.
+    std::vector<std::shared_ptr<DataObjectBase>> detachObjects();
+
+    /// \brief Wait for an object that is part of a gather started with gatherAsync.
+    /// \param object The object.
+    void completeGather(const std::shared_ptr<DataObjectBase>& object) const;
   };
 }  // namespace bufr
 
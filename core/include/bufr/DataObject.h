@@ -8,16 +8,25 @@
 #pragma once
 
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <type_traits>
 #include <memory>
 #include <iostream>
+#include <string_view>
 #include <vector>
 #include <netcdf>
 
+#include <gsl/gsl-lite.hpp>
+
 #include "eckit/mpi/Comm.h"
 
 #include "QueryParser.h"
 #include "Data.h"
+#include "PackedStrings.h"
+#include "TakeRows.h"
+#include "ValidityBitmap.h"
 
 namespace nc = netCDF;
 
@@ -36,6 +45,73 @@ namespace bufr {
     {
      public:
         virtual void write(const std::vector<T>& data) = 0;
+
+        /// \brief Write values that are not in a std::vector (ex: values in shared memory). The
+        ///        default implementation copies them and calls write.
+        /// \param data The values.
+        /// \param size The number of values.
+        virtual void writeValues(const T* data, size_t size)
+        {
+            write(std::vector<T>(data, data + size));
+        }
+
+        /// \brief Write broadcast data (each value repeated a number of times). The default
+        ///        implementation expands the data and calls write. Writers that can stream the
+        ///        expanded data should override this.
+        /// \param data The stored (unexpanded) values.
+        /// \param repeats The number of times each value is repeated.
+        virtual void writeRepeated(const std::vector<T>& data, size_t repeats)
+        {
+            std::vector<T> expanded;
+            expanded.reserve(data.size() * repeats);
+            for (const auto& val : data)
+            {
+                expanded.insert(expanded.end(), repeats, val);
+            }
+
+            write(expanded);
+        }
+    };
+
+    template<>
+    class ObjectWriter<std::string> : public ObjectWriterBase
+    {
+     public:
+        virtual void write(const std::vector<std::string>& data) = 0;
+
+        /// \brief Write broadcast data (each value repeated a number of times). The default
+        ///        implementation expands the data and calls write.
+        /// \param data The stored (unexpanded) values.
+        /// \param repeats The number of times each value is repeated.
+        virtual void writeRepeated(const std::vector<std::string>& data, size_t repeats)
+        {
+            std::vector<std::string> expanded;
+            expanded.reserve(data.size() * repeats);
+            for (const auto& val : data)
+            {
+                expanded.insert(expanded.end(), repeats, val);
+            }
+
+            write(expanded);
+        }
+
+        /// \brief Write strings straight from the packed storage of a DataObject. The default
+        ///        implementation copies them into std::strings and calls write (or
+        ///        writeRepeated). Writers that can use the NUL terminated strings in place
+        ///        should override this.
+        /// \param data The stored (unexpanded) values.
+        /// \param repeats The number of times each value is repeated.
+        virtual void writePacked(const PackedStrings& data, size_t repeats)
+        {
+            if (repeats == 1)
+            {
+                write(data.toVector());
+            }
+            else
+            {
+                writeRepeated(data.toVector(), repeats);
+            }
+        }
     };
 
   struct Data;
@@ -155,6 +231,17 @@ namespace bufr {
       /// \param val Scalar to add to the data..
       virtual void offsetBy(double val) = 0;
 
+      /// \brief Apply y = scale * x + offset to the stored values and clamp the result to
+      ///        [lowerBound, upperBound], all in a single pass (missing values are skipped).
+      /// \param scale Scalar to multiply the data by.
+      /// \param offset Scalar to add to the data after scaling.
+      /// \param lowerBound Smallest allowed result.
+      /// \param upperBound Largest allowed result.
+      virtual void applyAffine(double scale,
+                               double offset,
+                               double lowerBound = -std::numeric_limits<double>::infinity(),
+                               double upperBound = std::numeric_limits<double>::infinity()) = 0;
+
       /// \brief Write the data out using a writer.
       /// \param writer The writer to use.
       virtual void write(std::shared_ptr<ObjectWriterBase> writer) = 0;
@@ -167,6 +254,37 @@ namespace bufr {
       /// \param comm The MPI communicator to use.
       virtual void allGather(const eckit::mpi::Comm& comm) = 0;
 
+      /// \brief Pad the dimensions with 1s up to a number of dimensions, the same way gather
+      ///        lines up objects that have fewer dimensions on some ranks.
+      /// \param numDims The number of dimensions.
+      void padDims(size_t numDims);
+
+      /// \brief Get the number of bytes the data takes when packed into the single message
+      ///        DataContainer::gather sends for all of its objects. Views and broadcast data
+      ///        are counted the way they read (as if they were materialized).
+      virtual size_t packedSize() const = 0;
+
+      /// \brief Copy the data into a buffer of packedSize() bytes. Views and broadcast data
+      ///        are packed the way they read, so they don't need to be materialized first.
+      /// \param buffer The buffer to write to (no alignment is needed).
+      virtual void pack(char* buffer) const = 0;
+
+      /// \brief Replace the data with the packed data from several ranks (in rank order). Parts
+      ///        whose extra dimensions are smaller than the result are padded with missing
+      ///        values.
+      /// \param parts The packed data of each rank.
+      /// \param partDims The dimensions of the data of each rank.
+      /// \param dims The dimensions of the result.
+      virtual void unpack(const std::vector<const char*>& parts,
+                          const std::vector<Dimensions>& partDims,
+                          const Dimensions& dims) = 0;
+
+      /// \brief Replace the data with the values of several objects of the same type one after
+      ///        the other (see DataContainer::concat). The result is sized once, instead of
+      ///        growing with every object like append does.
+      /// \param objects The objects to concatenate (they must have the same extra dimensions).
+      virtual void concat(const std::vector<std::shared_ptr<DataObjectBase>>& objects) = 0;
+
       /// \brief Makes a new dimension scale using this data object as the source
       /// \param name The name of the dimension variable.
       /// \param dimIdx The idx of the data dimension to use.
@@ -176,8 +294,19 @@ namespace bufr {
 
       virtual std::shared_ptr<DataObjectBase> slice(const std::vector<std::size_t>& rows) const = 0;
 
+      /// \brief Slice the data object with a mask that has one bit per row (set for the rows to
+      ///        keep).
+      /// \param rowMask The row mask (ex: the result of a filter).
+      /// \return Sliced DataObject.
+      std::shared_ptr<DataObjectBase> sliceByMask(const ValidityBitmap& rowMask) const;
+
       virtual size_t size() const = 0;
 
+      /// \brief Expand a broadcast data object (see setRepeats) or copy out the rows of a row
+      ///        selection view (see slice) into dense data. Does nothing if the data is already
+      ///        dense.
+      virtual void materialize() = 0;
+
       size_t idxFromLoc(const Location& loc) const
       {
         size_t dim_prod = 1;
@@ -211,6 +340,11 @@ namespace bufr {
       void setDims(const std::vector<int> dims);
       void setQuery(const std::string& query);
       void setDimPaths(const std::vector<Query>& dimPaths);
+
+      /// \brief Make this object a broadcast view where each stored value is repeated
+      ///        `repeats` times (stride 0). The stored data must hold the unexpanded values.
+      void setRepeats(size_t repeats);
+
       virtual void setData(const Data& data) = 0;
       virtual void append(const std::shared_ptr<DataObjectBase>& data) = 0;
 
@@ -220,6 +354,29 @@ namespace bufr {
       Dimensions getDims() const { return dims_; }
       std::string getPath() const { return query_; }
       std::vector<Query> getDimPaths() const { return dimPaths_; }
+      size_t getRepeats() const { return repeats_; }
+
+      /// \brief Is this object a broadcast view (every stored value is repeated getRepeats()
+      ///        times instead of being physically duplicated).
+      bool isBroadcast() const { return repeats_ > 1; }
+
+      /// \brief Is this object a row selection view (made by slice). It shares the (read only)
+      ///        data of the object it was sliced from and only copies the selected rows out
+      ///        when it is materialized. Note that it keeps all of the source data alive.
+      bool isView() const { return rowSelection_ != nullptr; }
+
+      /// \brief Get the validity bitmap of the stored values (broadcast values are stored once,
+      ///        so index it with idx / getRepeats()). It is computed the first time it is needed
+      ///        and then shared by all consumers until the data changes.
+      const ValidityBitmap& getValidity() const;
+
+      /// \brief Get the validity bitmap for the expanded values (one bit per value even if the
+      ///        object is a broadcast view).
+      ValidityBitmap getExpandedValidity() const;
+
+      /// \brief Set the validity bitmap of the stored values when it is already known (it must
+      ///        agree with the missing values in the data). Saves recomputing it.
+      void setValidity(ValidityBitmap validity);
 
 
     protected:
@@ -228,6 +385,109 @@ namespace bufr {
       std::vector<int> dims_;
       std::string query_;
       std::vector<Query> dimPaths_;
+      size_t repeats_ = 1;
+      mutable std::shared_ptr<const ValidityBitmap> validity_;
+
+      /// Rows of the shared data selected by a view and the number of values in a row
+      std::shared_ptr<const std::vector<size_t>> rowSelection_;
+      size_t rowLength_ = 1;
+
+      /// \brief Map an index into the values of a view to an index into the shared data.
+      size_t storedIdx(size_t idx) const
+      {
+        return (*rowSelection_)[idx / rowLength_] * rowLength_ + idx % rowLength_;
+      }
+
+      /// \brief Get the row selection for slicing this object (the rows of a view are mapped
+      ///        through its own selection, so views never stack).
+      /// \param rows The rows to select.
+      std::shared_ptr<const std::vector<size_t>> composeRows(const std::vector<size_t>& rows) const;
+
+      /// \brief Walk the runs of values in data with some dimensions that stay contiguous in
+      ///        data with larger (or equal) dimensions. The trailing dimensions that match are
+      ///        copied as one block, so the cost is per run and not per value.
+      /// \param fromDims The dimensions of the source data.
+      /// \param toDims The dimensions of the padded data (only the extra dimensions are used).
+      /// \param copy Called as copy(srcIdx, dstIdx, length) for each run, in source order.
+      template<typename Copy>
+      static void forEachPaddedRun(const Dimensions& fromDims,
+                                   const Dimensions& toDims,
+                                   Copy&& copy)
+      {
+        size_t numValues = 1;
+        for (const auto dim : fromDims)
+        {
+          numValues *= dim;
+        }
+
+        if (numValues == 0) return;
+
+        // A run covers the trailing dimensions that match plus the innermost one that doesn't.
+        size_t runDim = fromDims.size() - 1;
+        while (runDim > 0 && fromDims[runDim] == toDims[runDim])
+        {
+          --runDim;
+        }
+
+        size_t runLength = 1;
+        for (size_t dimIdx = runDim; dimIdx < fromDims.size(); ++dimIdx)
+        {
+          runLength *= fromDims[dimIdx];
+        }
+
+        std::vector<size_t> toStrides(fromDims.size(), 1);
+        for (size_t dimIdx = fromDims.size() - 1; dimIdx-- > 0;)
+        {
+          toStrides[dimIdx] = toStrides[dimIdx + 1] * toDims[dimIdx + 1];
+        }
+
+        // Step through the outer dimensions like an odometer.
+        std::vector<size_t> counters(runDim, 0);
+        size_t dstIdx = 0;
+        for (size_t srcIdx = 0; srcIdx < numValues; srcIdx += runLength)
+        {
+          copy(srcIdx, dstIdx, runLength);
+
+          for (size_t dimIdx = runDim; dimIdx-- > 0;)
+          {
+            dstIdx += toStrides[dimIdx];
+            if (++counters[dimIdx] < static_cast<size_t>(fromDims[dimIdx])) break;
+
+            dstIdx -= counters[dimIdx] * toStrides[dimIdx];
+            counters[dimIdx] = 0;
+          }
+        }
+      }
+
+      /// \brief Drop the row selection (call when the data is replaced).
+      void resetView()
+      {
+        rowSelection_.reset();
+        rowLength_ = 1;
+      }
+
+      /// \brief Compute the validity bitmap for the stored values.
+      virtual ValidityBitmap computeValidity() const = 0;
+
+      /// \brief Forget the cached validity bitmap (call whenever the stored values change).
+      void resetValidity() { validity_.reset(); }
+
+      /// \brief Expand the cached validity bitmap (if any) for materialize.
+      void expandValidity();
+
+      /// \brief Update the cached validity bitmap after the values of another object were
+      ///        appended. It is only carried over if both bitmaps were already known.
+      void appendValidity(const DataObjectBase& other);
+
+      /// \brief Get the dimensions of the objects concatenated one after the other (throws if
+      ///        their extra dimensions differ).
+      /// \param objects The objects to concatenate.
+      Dimensions concatDims(const std::vector<std::shared_ptr<DataObjectBase>>& objects) const;
+
+      /// \brief Set the cached validity bitmap to the bitmaps of concatenated objects. It is
+      ///        only carried over if all the bitmaps were already known.
+      /// \param objects The concatenated objects.
+      void concatValidity(const std::vector<std::shared_ptr<DataObjectBase>>& objects);
   };
 
   template <typename T>
@@ -235,17 +495,24 @@ namespace bufr {
   {
     public:
 
-      /// \brief Make a copy of the data object.
+      /// \brief Make a copy of the data object. The copy shares the data (copy on write), so
+      ///        this is cheap.
       /// \return copy
       std::shared_ptr<DataObjectBase> copy() const final
       {
         auto copy = std::make_shared<DataObject<T>>();
-        copy->data_ = data_;
+        copy->data_ = data_;  // shared until one of them writes to it
+        copy->externalData_ = externalData_;
+        copy->externalSize_ = externalSize_;
+        copy->rowSelection_ = rowSelection_;
+        copy->rowLength_ = rowLength_;
         copy->fieldName_ = fieldName_;
         copy->groupByFieldName_ = groupByFieldName_;
         copy->dims_ = dims_;
         copy->query_ = query_;
         copy->dimPaths_ = dimPaths_;
+        copy->repeats_ = repeats_;
+        copy->validity_ = validity_;
         return copy;
       }
 
@@ -261,12 +528,12 @@ namespace bufr {
       void print(std::ostream& out) const final
       {
         out << "DataObject " << fieldName_ << " " << groupByFieldName_ << " ";
-        out << "size " << data_.size() << std::endl;
+        out << "size " << size() << std::endl;
 
         // print data to output stream
-        for (size_t i = 0; i < data_.size(); i++)
+        for (size_t i = 0; i < size(); i++)
         {
-          out << data_[i] << " ";
+          out << valueAt(i) << " ";
 
           if (i % 25 == 0)
           {
@@ -307,28 +574,28 @@ namespace bufr {
       /// \return Int data.
       int getAsInt(size_t idx) const final
       {
-        return static_cast<int>(data_[idx]);
+        return static_cast<int>(valueAt(idx));
       }
 
       /// \brief Get the data at the index as an float.
       /// \return Float data.
       float getAsFloat(size_t idx) const final
       {
-        return static_cast<float>(data_[idx]);
+        return static_cast<float>(valueAt(idx));
       }
 
       /// \brief Get the data at the index as an string.
       /// \return String data.
       std::string getAsString(size_t idx) const final
       {
-        return std::to_string(data_[idx]);
+        return std::to_string(valueAt(idx));
       }
 
       /// \brief Is the element at the index the missing value.
       /// \return bool data.
       bool isMissing(size_t idx) const final
       {
-        return data_[idx] == missingValue();
+        return valueAt(idx) == missingValue();
       }
 
       /// \brief Get data associated with a given location.
@@ -336,45 +603,80 @@ namespace bufr {
       /// \return The data at the given location.
       T get(const Location& loc) const
       {
-        return data_[idxFromLoc(loc)];
+        return valueAt(idxFromLoc(loc));
       };
 
       /// \brief Multiply the stored values in this data object by a scalar.
       /// \param val Scalar to multiply to the data..
       void multiplyBy(double val) final
       {
-        if (typeid(T) == typeid(float) ||   // NOLINT
-            typeid(T) == typeid(double) ||  // NOLINT
-            trunc(val) == val)
-        {
-          for (size_t i = 0; i < data_.size(); i++)
-          {
-            if (data_[i] != missingValue())
-            {
-              data_[i] = static_cast<T>(static_cast<double>(data_[i]) * val);
-            }
-          }
-        }
-        else
+        applyAffine(val, 0.0);
+      }
+
+      /// \brief Add a scalar to the stored values in this data object.
+      /// \param val Scalar to add to the data.
+      void offsetBy(double val) final
+      {
+        applyAffine(1.0, val);
+      }
+
+      /// \brief Apply y = scale * x + offset to the stored values and clamp the result to
+      ///        [lowerBound, upperBound], all in a single pass (missing values are skipped).
+      ///        Scaling is done in double precision and the offset in the data type, so a
+      ///        single scale or offset gives exactly the same result as multiplyBy/offsetBy.
+      /// \param scale Scalar to multiply the data by.
+      /// \param offset Scalar to add to the data after scaling.
+      /// \param lowerBound Smallest allowed result.
+      /// \param upperBound Largest allowed result.
+      void applyAffine(double scale,
+                       double offset,
+                       double lowerBound = -std::numeric_limits<double>::infinity(),
+                       double upperBound = std::numeric_limits<double>::infinity()) final
+      {
+        if (!std::is_floating_point<T>::value && trunc(scale) != scale)
         {
           std::ostringstream str;
           str << "Multiplying integer field \"" << fieldName_ << "\" with a non-integer is ";
           str << "illegal. Please convert it to a float or double.";
           throw eckit::BadParameter(str.str());
         }
-      }
 
-      /// \brief Add a scalar to the stored values in this data object.
-      /// \param val Scalar to add to the data.
-      void offsetBy(double val) final
-      {
-        for (size_t i = 0; i < data_.size(); i++)
+        const T typedOffset = static_cast<T>(offset);
+        const bool clamp = (lowerBound > -std::numeric_limits<double>::infinity() ||
+                            upperBound < std::numeric_limits<double>::infinity());
+
+        resolveView();
+
+        // The runs of valid values are contiguous, so the loops below vectorize.
+        T* data = mutableData().data();
+        getValidity().forEachValidRun([=](size_t begin, size_t end)
         {
-          if (data_[i] != missingValue())
+          if (scale != 1.0)
           {
-            data_[i] = data_[i] + static_cast<T>(val);
+            for (size_t i = begin; i < end; ++i)
+            {
+              data[i] = static_cast<T>(static_cast<double>(data[i]) * scale);
+            }
           }
-        }
+
+          if (offset != 0.0)
+          {
+            for (size_t i = begin; i < end; ++i)
+            {
+              data[i] = data[i] + typedOffset;
+            }
+          }
+
+          if (clamp)
+          {
+            for (size_t i = begin; i < end; ++i)
+            {
+              const double val = static_cast<double>(data[i]);
+              data[i] = (val < lowerBound) ? static_cast<T>(lowerBound)
+                      : (val > upperBound) ? static_cast<T>(upperBound) : data[i];
+            }
+          }
+        });
       }
 
       /// \brief Set the data associated with this data object (numeric DataObject).
@@ -390,25 +692,57 @@ namespace bufr {
         }
         else
         {
-          data_ = std::vector<T>(data.size());
-          for (size_t idx = 0; idx < data.size(); ++idx)
+          repeats_ = 1;
+          resetView();
+
+          // The octet validity is also the validity of the converted data, so keep it.
+          auto validity = std::make_shared<ValidityBitmap>(
+            ValidityBitmap::fromOctets(data.value.octets.data(), data.size()));
+
+          auto values = std::make_shared<std::vector<T>>(data.size(), missingValue());
+          validity->forEachValid([&values, &data](size_t idx)
           {
-            if (!data.isMissing(idx))
-            {
-              data_[idx] = data.value.octets[idx];
-            }
-            else
-            {
-              data_[idx] = missingValue();
-            }
-          }
+            (*values)[idx] = data.value.octets[idx];
+          });
+
+          setValues(std::move(values));
+          validity_ = std::move(validity);
         }
       }
 
       // \brief Set the data associated with this data object.
       void setData(const std::vector<T>& data)
       {
-        data_ = data;
+        setValues(std::make_shared<std::vector<T>>(data));
+        repeats_ = 1;
+        resetView();
+        resetValidity();
+      }
+
+      /// \brief Set the data associated with this data object (takes ownership of the data).
+      /// \param data The raw data
+      void setData(std::vector<T>&& data)
+      {
+        setValues(std::make_shared<std::vector<T>>(std::move(data)));
+        repeats_ = 1;
+        resetView();
+        resetValidity();
+      }
+
+      /// \brief Use values that live in memory this object doesn't own (ex: a read only shared
+      ///        memory mapping) instead of copying them. The pointer keeps the memory alive (its
+      ///        deleter releases it). The values are copied into the object's own data the
+      ///        first time the object is written to.
+      /// \param data The values.
+      /// \param size The number of values.
+      void setExternalData(std::shared_ptr<const T> data, size_t size)
+      {
+        data_ = std::make_shared<std::vector<T>>();
+        externalData_ = std::move(data);
+        externalSize_ = size;
+        repeats_ = 1;
+        resetView();
+        resetValidity();
       }
 
       /// \brief Write the data out using a writer.
@@ -417,7 +751,21 @@ namespace bufr {
       {
         if (auto writerPtr = std::dynamic_pointer_cast<ObjectWriter<T>>(writer))
         {
-          writerPtr->write(data_);
+          resolveView();
+
+          if (isBroadcast())
+          {
+            ownValues();
+            writerPtr->writeRepeated(*data_, repeats_);
+          }
+          else if (externalData_)
+          {
+            writerPtr->writeValues(storedData(), storedSize());
+          }
+          else
+          {
+            writerPtr->write(*data_);
+          }
         }
         else
         {
@@ -432,6 +780,10 @@ namespace bufr {
       /// \param comm The MPI communicator to use.
       void gather(const eckit::mpi::Comm& comm) final
       {
+        materialize();
+        ownValues();
+        resetValidity();
+
         size_t numDims = dims_.size();
         comm.reduce(numDims, numDims, eckit::mpi::Operation::MAX, 0);
 
@@ -473,7 +825,7 @@ namespace bufr {
         bool adjustDims = false;
         for (size_t idx = 1; idx < rcvDims.size(); idx++)
         {
-          adjustDims = (rcvDims[idx] != getDims()[idx]);
+          adjustDims = adjustDims || (rcvDims[idx] != dims_[idx]);
         }
 
         // Resize the dimensions to match the global dimensions
@@ -481,30 +833,14 @@ namespace bufr {
         {
           std::vector<T> sendBuffer(sendSize, missingValue());
 
-          // Map the local data into the sendBuffer using the dimensions
-          for (size_t i = 0; i < data_.size(); ++i)
+          // Copy the local data into the sendBuffer in blocks of whole inner rows
+          forEachPaddedRun(dims_, rcvDims, [&](size_t srcIdx, size_t dstIdx, size_t length)
           {
-            Location loc;
-
-            // Compute the location coordinate in the old data
-            size_t idx = i;
-            for (size_t dimIdx = 0; dimIdx < dims_.size(); ++dimIdx)
-            {
-              loc.push_back(idx % dims_[dimIdx]);
-              idx /= dims_[dimIdx];
-            }
-
-            // Map that location into the new data (compute the new index)
-            idx = 0;
-            for (size_t dimIdx = 0; dimIdx < rcvDims.size(); ++dimIdx)
-            {
-              idx += loc[dimIdx] * rcvDims[dimIdx];
-            }
+            std::copy_n(data_->data() + srcIdx, length, sendBuffer.data() + dstIdx);
+          });
 
-            sendBuffer[idx] = data_[i];
-          }
-
-          data_ = std::move(sendBuffer);
+          data_ = std::make_shared<std::vector<T>>(std::move(sendBuffer));
+          std::copy(rcvDims.begin() + 1, rcvDims.end(), dims_.begin() + 1);
         }
 
         auto sizeArray = std::vector<int>(comm.size());
@@ -521,13 +857,13 @@ namespace bufr {
 
         if constexpr (!std::is_same_v<T, unsigned long long> && !std::is_same_v<T, unsigned int>)
         {
-          comm.gatherv(data_, rcvBuffer, sizeArray, displacement, 0);
+          comm.gatherv(*data_, rcvBuffer, sizeArray, displacement, 0);
         }
         else
         {
           // Use unsigned long as the type and use that to gatherv back to the correct type. This is
           // necessary because eckit MPI does not support unsigned long long or unsigned int
-          std::vector<unsigned long> ulData(data_.begin(), data_.end());
+          std::vector<unsigned long> ulData(data_->begin(), data_->end());
           std::vector<unsigned long> ulRcvBuffer(rcvSize, DataObject<unsigned long>::missingValue());
           comm.gatherv(ulData, ulRcvBuffer, sizeArray, displacement, 0);
 
@@ -544,7 +880,7 @@ namespace bufr {
         if (comm.rank() == 0)
         {
           dims_ = rcvDims;
-          data_ = std::move(rcvBuffer);
+          data_ = std::make_shared<std::vector<T>>(std::move(rcvBuffer));
         }
       }
 
@@ -552,6 +888,10 @@ namespace bufr {
       /// \param comm The MPI communicator to use.
       void allGather(const eckit::mpi::Comm& comm) final
       {
+        materialize();
+        ownValues();
+        resetValidity();
+
         size_t numDims = dims_.size();
         comm.allReduce(numDims, numDims, eckit::mpi::Operation::MAX);
 
@@ -593,7 +933,7 @@ namespace bufr {
         bool adjustDims = false;
         for (size_t idx = 1; idx < rcvDims.size(); idx++)
         {
-          adjustDims = (rcvDims[idx] != getDims()[idx]);
+          adjustDims = adjustDims || (rcvDims[idx] != dims_[idx]);
         }
 
         // Resize the dimensions to match the global dimensions
@@ -601,30 +941,14 @@ namespace bufr {
         {
           std::vector<T> sendBuffer(sendSize, missingValue());
 
-          // Map the local data into the sendBuffer using the dimensions
-          for (size_t i = 0; i < data_.size(); ++i)
+          // Copy the local data into the sendBuffer in blocks of whole inner rows
+          forEachPaddedRun(dims_, rcvDims, [&](size_t srcIdx, size_t dstIdx, size_t length)
           {
-            Location loc;
+            std::copy_n(data_->data() + srcIdx, length, sendBuffer.data() + dstIdx);
+          });
 
-            // Compute the location coordinate in the old data
-            size_t idx = i;
-            for (size_t dimIdx = 0; dimIdx < dims_.size(); ++dimIdx)
-            {
-              loc.push_back(idx % dims_[dimIdx]);
-              idx /= dims_[dimIdx];
-            }
-
-            // Map that location into the new data (compute the new index)
-            idx = 0;
-            for (size_t dimIdx = 0; dimIdx < rcvDims.size(); ++dimIdx)
-            {
-              idx += loc[dimIdx] * rcvDims[dimIdx];
-            }
-
-            sendBuffer[idx] = data_[i];
-          }
-
-          data_ = std::move(sendBuffer);
+          data_ = std::make_shared<std::vector<T>>(std::move(sendBuffer));
+          std::copy(rcvDims.begin() + 1, rcvDims.end(), dims_.begin() + 1);
         }
 
         auto sizeArray = std::vector<int>(comm.size());
@@ -641,14 +965,14 @@ namespace bufr {
 
         if constexpr (!std::is_same_v<T, unsigned long long> && !std::is_same_v<T, unsigned int>)
         {
-          comm.allGatherv(data_.begin(), data_.end(), rcvBuffer.begin(),
+          comm.allGatherv(data_->begin(), data_->end(), rcvBuffer.begin(),
                           sizeArray.data(), displacement.data());
         }
         else
         {
           // Use unsigned long as the type and use that to gatherv back to the correct type. This is
           // necessary because eckit MPI does not support unsigned long long or unsigned int
-          std::vector<unsigned long> ulData(data_.begin(), data_.end());
+          std::vector<unsigned long> ulData(data_->begin(), data_->end());
           std::vector<unsigned long> ulRcvBuffer(rcvSize, DataObject<unsigned long>::missingValue());
           comm.allGatherv(ulData.begin(), ulData.end(), ulRcvBuffer.begin(),
                           sizeArray.data(), displacement.data());
@@ -664,7 +988,111 @@ namespace bufr {
         }
 
         dims_ = rcvDims;
-        data_ = std::move(rcvBuffer);
+        data_ = std::make_shared<std::vector<T>>(std::move(rcvBuffer));
+      }
+
+      /// \brief Get the number of bytes the data takes when packed for DataContainer::gather.
+      size_t packedSize() const final
+      {
+        return size() * sizeof(T);
+      }
+
+      /// \brief Copy the data into a buffer of packedSize() bytes (the selected rows of a
+      ///        view, broadcast values repeated).
+      /// \param buffer The buffer to write to.
+      void pack(char* buffer) const final
+      {
+        if (isView())
+        {
+          takeRows(storedData(), buffer, *rowSelection_, rowLength_ * sizeof(T));
+        }
+        else if (isBroadcast())
+        {
+          for (const auto& val : gsl::span<const T>(storedData(), storedSize()))
+          {
+            for (size_t repeat = 0; repeat < repeats_; ++repeat)
+            {
+              std::memcpy(buffer, &val, sizeof(T));
+              buffer += sizeof(T);
+            }
+          }
+        }
+        else if (storedSize() > 0)
+        {
+          std::memcpy(buffer, storedData(), packedSize());
+        }
+      }
+
+      /// \brief Replace the data with the packed data from several ranks (in rank order).
+      /// \param parts The packed data of each rank.
+      /// \param partDims The dimensions of the data of each rank.
+      /// \param dims The dimensions of the result.
+      void unpack(const std::vector<const char*>& parts,
+                  const std::vector<Dimensions>& partDims,
+                  const Dimensions& dims) final
+      {
+        size_t rowLength = 1;
+        for (size_t dimIdx = 1; dimIdx < dims.size(); ++dimIdx)
+        {
+          rowLength *= dims[dimIdx];
+        }
+
+        std::vector<T> data(dims[0] * rowLength, missingValue());
+
+        size_t rowOffset = 0;
+        for (size_t partIdx = 0; partIdx < parts.size(); ++partIdx)
+        {
+          const auto& fromDims = partDims[partIdx];
+          T* dst = data.data() + rowOffset * rowLength;
+          const char* src = parts[partIdx];
+          forEachPaddedRun(fromDims, dims, [&](size_t srcIdx, size_t dstIdx, size_t length)
+          {
+            std::memcpy(dst + dstIdx, src + srcIdx * sizeof(T), length * sizeof(T));
+          });
+
+          rowOffset += fromDims[0];
+        }
+
+        resetView();
+        resetValidity();
+        repeats_ = 1;
+        dims_ = dims;
+        setValues(std::make_shared<std::vector<T>>(std::move(data)));
+      }
+
+      /// \brief Replace the data with the values of several objects one after the other.
+      /// \param objects The objects to concatenate.
+      void concat(const std::vector<std::shared_ptr<DataObjectBase>>& objects) final
+      {
+        size_t numValues = 0;
+        for (const auto& object : objects)
+        {
+          if (!std::dynamic_pointer_cast<DataObject<T>>(object))
+          {
+            std::ostringstream str;
+            str << "Cannot concatenate data of type " << typeid(*object).name();
+            throw eckit::BadParameter(str.str());
+          }
+
+          numValues += object->size();
+        }
+
+        auto dims = concatDims(objects);
+
+        std::vector<T> data(numValues);
+        T* dst = data.data();
+        for (const auto& object : objects)
+        {
+          const auto& part = static_cast<const DataObject<T>&>(*object);
+          part.copyValues(dst);
+          dst += part.size();
+        }
+
+        concatValidity(objects);
+        resetView();
+        repeats_ = 1;
+        dims_ = std::move(dims);
+        setValues(std::make_shared<std::vector<T>>(std::move(data)));
       }
 
       /// \brief Append the data from another DataObject to this one.
@@ -689,7 +1117,26 @@ namespace bufr {
             throw eckit::BadParameter(str.str());
           }
         }
-        data_.insert(data_.end(), other->data_.begin(), other->data_.end());
+
+        resolveView();
+
+        if (repeats_ == other->repeats_ && !other->isView())
+        {
+          // Objects with the same repeat factor can be appended without expanding them.
+          const auto otherData = other->sharedValues();  // keeps it alive if it is our own data
+          const auto otherSize = other->storedSize();
+          auto& data = mutableData();
+          data.insert(data.end(), otherData.get(), otherData.get() + otherSize);
+        }
+        else
+        {
+          materialize();
+          const auto otherData = other->getRawData();
+          auto& data = mutableData();
+          data.insert(data.end(), otherData.begin(), otherData.end());
+        }
+
+        appendValidity(*other);
       }
 
       /// \brief Makes a new dimension scale using this data object as the source
@@ -698,24 +1145,32 @@ namespace bufr {
       std::shared_ptr<DimensionDataBase> createDimensionFromData(const std::string& name,
                                                                  std::size_t dimIdx) const final
       {
+        if (isBroadcast() || isView())
+        {
+          auto denseObj = std::static_pointer_cast<DataObject<T>>(copy());
+          denseObj->materialize();
+          return denseObj->createDimensionFromData(name, dimIdx);
+        }
+
         auto dimData = std::make_shared<DimensionData<T>>(name, getDims()[dimIdx]);
 
-        if (data_.empty())
+        const auto data = getDataView();
+        if (data.empty())
         {
           return dimData;
         }
 
-        std::copy(data_.begin(),
-                  data_.begin() + dimData->data.size(),
+        std::copy(data.begin(),
+                  data.begin() + dimData->data.size(),
                   dimData->data.begin());
 
         // Validate this data object is a valid (has values that repeat for each frame
-        for (size_t idx = 0; idx < data_.size(); idx += dimData->data.size())
+        for (size_t idx = 0; idx < data.size(); idx += dimData->data.size())
         {
-          if (!std::equal(data_.begin(),
-                          data_.begin() + dimData->data.size(),
-                          data_.begin() + idx,
-                          data_.begin() + idx + dimData->data.size()))
+          if (!std::equal(data.begin(),
+                          data.begin() + dimData->data.size(),
+                          data.begin() + idx,
+                          data.begin() + idx + dimData->data.size()))
           {
             std::stringstream errStr;
             errStr << "Dimension " << name << " has an invalid source field. ";
@@ -727,18 +1182,74 @@ namespace bufr {
         return dimData;
       }
 
-      /// \brief Get the raw data associated with this data object.
+      /// \brief Get a read only view of the data without copying it. The view points into
+      ///        this object's storage, so it is only valid while the object is alive and its
+      ///        data is not changed (setData, append, gather, allGather or materialize).
+      ///        Broadcast objects and row selection views must be materialized first.
+      /// \return View of the data.
+      gsl::span<const T> getDataView() const
+      {
+        if (isBroadcast() || isView())
+        {
+          std::ostringstream errStr;
+          errStr << "Can not view broadcast or sliced field \"" << fieldName_ << "\" without ";
+          errStr << "materializing it first.";
+          throw eckit::BadValue(errStr.str());
+        }
+
+        return gsl::span<const T>(storedData(), storedSize());
+      }
+
+      /// \brief Get a writable view of the data without copying it (broadcast data is
+      ///        materialized first). Same lifetime rules as getDataView. The cached validity
+      ///        bitmap is dropped, so finish writing before anything asks for getValidity().
+      /// \return View of the data.
+      gsl::span<T> getMutableDataView()
+      {
+        materialize();
+        resetValidity();
+
+        auto& data = mutableData();
+        return gsl::span<T>(data.data(), data.size());
+      }
+
+      /// \brief Get a copy of the data associated with this data object (broadcast data is
+      ///        expanded). Prefer getDataView unless a copy is really needed.
       /// \return The raw data.
-      std::vector<T> getRawData() const { return data_; }
+      std::vector<T> getRawData() const
+      {
+        if (!isBroadcast() && !isView())
+        {
+          return std::vector<T>(storedData(), storedData() + storedSize());
+        }
+
+        std::vector<T> data(size());
+        copyValues(data.data());
+        return data;
+      }
+
+      /// \brief Expand broadcast data or copy out the rows of a view into dense data.
+      void materialize() final
+      {
+        resolveView();
+
+        if (isBroadcast())
+        {
+          setValues(std::make_shared<std::vector<T>>(getRawData()));
+          expandValidity();
+          repeats_ = 1;
+        }
+      }
 
       /// \brief Get the size of the data object.
       /// \return The size of the data object.
       size_t size() const final
       {
-        return data_.size();
+        return isView() ? rowSelection_->size() * rowLength_ : storedSize() * repeats_;
       }
 
-      /// \brief Slice the data object according to a list of indices.
+      /// \brief Slice the data object according to a list of indices. Dense data is not
+      ///        copied, the result is a view of the selected rows (see isView).
       /// \param rows The indices to slice the data object by.
       /// \return Sliced DataObject.
       std::shared_ptr<DataObjectBase> slice(const std::vector<std::size_t>& rows) const final
@@ -750,35 +1261,155 @@ namespace bufr {
           extraDims *= dims_[i];
         }
 
-        // Make new DataObject with the rows we want
-        std::vector<T> newData;
-        newData.reserve(rows.size() * extraDims);
-        for (std::size_t i = 0; i < rows.size(); ++i)
+        auto slicedDataObject = std::make_shared<DataObject<T>>();
+
+        if (isBroadcast())
         {
-          newData.insert(newData.end(),
-                         data_.begin() + rows[i] * extraDims,
-                         data_.begin() + (rows[i] + 1) * extraDims);
+          // Make new DataObject with the rows we want
+          std::vector<T> newData;
+          newData.reserve(rows.size() * extraDims);
+          for (std::size_t i = 0; i < rows.size(); ++i)
+          {
+            for (std::size_t j = 0; j < extraDims; ++j)
+            {
+              newData.push_back(valueAt(rows[i] * extraDims + j));
+            }
+          }
+
+          slicedDataObject->setData(std::move(newData));
+        }
+        else
+        {
+          slicedDataObject->data_ = data_;
+          slicedDataObject->externalData_ = externalData_;
+          slicedDataObject->externalSize_ = externalSize_;
+          slicedDataObject->rowSelection_ = composeRows(rows);
+          slicedDataObject->rowLength_ = extraDims;
         }
 
         auto sliceDims = dims_;
         sliceDims[0] = rows.size();
 
-        auto slicedDataObject = std::make_shared<DataObject<T>>();
-
-        slicedDataObject->setData(newData);
         slicedDataObject->setFieldName(fieldName_);
         slicedDataObject->setGroupByFieldName(groupByFieldName_);
         slicedDataObject->setDims(sliceDims);
         slicedDataObject->setQuery(query_);
         slicedDataObject->setDimPaths(dimPaths_);
 
+        // Carry the validity over instead of recomputing it from the sliced values.
+        slicedDataObject->validity_ = std::make_shared<const ValidityBitmap>(
+          isBroadcast() ? getExpandedValidity().selectRows(rows, extraDims)
+                        : getValidity().selectRows(rows, extraDims));
+
         return slicedDataObject;
       }
 
+      /// \brief Get the value for an index, taking broadcasting into account.
+      /// \param idx The index into the (expanded) data.
+      /// \return The value.
+      inline const T& valueAt(size_t idx) const
+      {
+        if (rowSelection_) return storedData()[storedIdx(idx)];
+        return (repeats_ == 1) ? storedData()[idx] : storedData()[idx / repeats_];
+      }
+
       friend class DataObjectBuilder;
 
+    protected:
+      /// \brief Compute the validity bitmap for the stored values.
+      ValidityBitmap computeValidity() const final
+      {
+        auto validity = ValidityBitmap::fromValues(storedData(), storedSize(), missingValue());
+        return isView() ? validity.selectRows(*rowSelection_, rowLength_) : validity;
+      }
+
     private:
-      std::vector<T> data_;
+      /// Values (shared with copies and views, so it is copied before it is written to)
+      std::shared_ptr<std::vector<T>> data_ = std::make_shared<std::vector<T>>();
+
+      /// Values in memory this object doesn't own (see setExternalData). Used instead of data_
+      /// when set.
+      std::shared_ptr<const T> externalData_;
+      size_t externalSize_ = 0;
+
+      /// \brief Get the stored (unexpanded) values.
+      inline const T* storedData() const
+      {
+        return externalData_ ? externalData_.get() : data_->data();
+      }
+
+      /// \brief Get the number of stored (unexpanded) values.
+      inline size_t storedSize() const
+      {
+        return externalData_ ? externalSize_ : data_->size();
+      }
+
+      /// \brief Get the stored values along with whatever keeps them alive.
+      std::shared_ptr<const T> sharedValues() const
+      {
+        return externalData_ ? externalData_ : std::shared_ptr<const T>(data_, data_->data());
+      }
+
+      /// \brief Replace the stored values (drops any external values).
+      void setValues(std::shared_ptr<std::vector<T>> values)
+      {
+        data_ = std::move(values);
+        externalData_.reset();
+        externalSize_ = 0;
+      }
+
+      /// \brief Copy external values into our own data (so data_ holds the values).
+      void ownValues()
+      {
+        if (externalData_)
+        {
+          setValues(std::make_shared<std::vector<T>>(storedData(), storedData() + storedSize()));
+        }
+      }
+
+      /// \brief Copy the (expanded) values into a buffer with room for size() values.
+      /// \param dst The buffer to write to.
+      void copyValues(T* dst) const
+      {
+        if (isView())
+        {
+          takeRows(storedData(), dst, *rowSelection_, rowLength_ * sizeof(T));
+        }
+        else if (isBroadcast())
+        {
+          for (const auto& val : gsl::span<const T>(storedData(), storedSize()))
+          {
+            dst = std::fill_n(dst, repeats_, val);
+          }
+        }
+        else
+        {
+          std::copy_n(storedData(), storedSize(), dst);
+        }
+      }
+
+      /// \brief Get the data for writing (makes our own copy if it is shared).
+      std::vector<T>& mutableData()
+      {
+        ownValues();
+        if (data_.use_count() > 1)
+        {
+          data_ = std::make_shared<std::vector<T>>(*data_);
+        }
+
+        return *data_;
+      }
+
+      /// \brief Copy the selected rows of a view into our own data. The validity bitmap
+      ///        already describes the selected values, so it is kept.
+      void resolveView()
+      {
+        if (isView())
+        {
+          setValues(std::make_shared<std::vector<T>>(getRawData()));
+          resetView();
+        }
+      }
   };
 
   template<>
@@ -787,17 +1418,22 @@ namespace bufr {
     public:
       DataObject() = default;
 
-      /// \brief Make a copy of the data object.
+      /// \brief Make a copy of the data object. The copy shares the data (copy on write), so
+      ///        this is cheap.
       /// \return copy
       std::shared_ptr<DataObjectBase> copy() const final
       {
         auto copy = std::make_shared<DataObject<std::string>>();
-        copy->data_ = data_;
+        copy->data_ = data_;  // shared until one of them writes to it
+        copy->rowSelection_ = rowSelection_;
+        copy->rowLength_ = rowLength_;
         copy->fieldName_ = fieldName_;
         copy->groupByFieldName_ = groupByFieldName_;
         copy->dims_ = dims_;
         copy->query_ = query_;
         copy->dimPaths_ = dimPaths_;
+        copy->repeats_ = repeats_;
+        copy->validity_ = validity_;
         return copy;
       }
 
@@ -837,7 +1473,7 @@ namespace bufr {
       /// \return bool data.
       bool isMissing(const Location& loc) const final
       {
-        return get(loc) == "";
+        return valueAt(idxFromLoc(loc)).empty();
       }
 
       /// \brief Get the data at the index as an int.
@@ -858,14 +1494,14 @@ namespace bufr {
       /// \return String data.
       std::string getAsString(size_t idx) const final
       {
-        return data_[idx];
+        return std::string(valueAt(idx));
       }
 
       /// \brief Is the element at the index the missing value.
       /// \return bool data.
       bool isMissing(size_t idx) const final
       {
-        return data_.at(idx) == "";
+        return valueAt(idx).empty();
       }
 
       /// \brief Get data associated with a given location.
@@ -873,7 +1509,7 @@ namespace bufr {
       /// \return The data at the given location.
       std::string get(const Location& loc) const
       {
-        return data_[idxFromLoc(loc)];
+        return std::string(valueAt(idxFromLoc(loc)));
       };
 
       /// \brief Multiply the stored values in this data object by a scalar (string version).
@@ -890,38 +1526,55 @@ namespace bufr {
         throw eckit::BadParameter("Trying to offset a string by a number");
       }
 
+      /// \brief Apply an affine transform to the data (string version).
+      void applyAffine(double scale,
+                       double offset,
+                       double lowerBound = -std::numeric_limits<double>::infinity(),
+                       double upperBound = std::numeric_limits<double>::infinity()) final
+      {
+        throw eckit::BadParameter("Trying to transform a string with numbers");
+      }
+
       /// \brief Set the data associated with this data object (string DataObject).
       /// \param data The raw data
       /// \param dataMissingValue The number that represents missing values within the raw data
       void setData( const Data& data) final
       {
-        data_ = std::vector<std::string>();
+        repeats_ = 1;
+        resetView();
+        resetValidity();
         if (data.isLongStr())
         {
-          data_ = data.value.strings;
+          data_ = std::make_shared<PackedStrings>(data.value.strings);
         }
         else
         {
+          // Each octet holds up to 8 characters, so these all land in fixed width slots.
+          auto strings = std::make_shared<PackedStrings>();
+          strings->reserve(data.size());
+
           auto charPtr = reinterpret_cast<const char *>(data.value.octets.data());
           for (size_t row_idx = 0; row_idx < data.size(); row_idx++)
           {
             if (!data.isMissing(row_idx))
             {
-              std::string str = std::string(
-                charPtr + row_idx * sizeof(double), sizeof(double));
+              std::string_view str(charPtr + row_idx * sizeof(double), sizeof(double));
 
               // trim trailing whitespace from str
-              str.erase(std::find_if(str.rbegin(), str.rend(),
-                                     [](char c) { return !std::isspace(c); }).base(),
-                        str.end());
+              while (!str.empty() && std::isspace(static_cast<unsigned char>(str.back())))
+              {
+                str.remove_suffix(1);
+              }
 
-              data_.push_back(str);
+              strings->push_back(str);
             }
             else
             {
-              data_.push_back("");
+              strings->push_back(missingValue());
             }
           }
+
+          data_ = std::move(strings);
         }
       }
 
@@ -929,7 +1582,28 @@ namespace bufr {
       /// \param data The raw data
       void setData(const std::vector<std::string>& data)
       {
-        data_ = data;
+        data_ = std::make_shared<PackedStrings>(data);
+        repeats_ = 1;
+        resetView();
+        resetValidity();
+      }
+
+      /// \brief Set the data associated with this data object (the strings are packed, so
+      ///        there is nothing to take ownership of).
+      /// \param data The raw data
+      void setData(std::vector<std::string>&& data)
+      {
+        setData(static_cast<const std::vector<std::string>&>(data));
+      }
+
+      /// \brief Set the data associated with this data object (takes ownership of the data).
+      /// \param data The packed strings
+      void setData(PackedStrings&& data)
+      {
+        data_ = std::make_shared<PackedStrings>(std::move(data));
+        repeats_ = 1;
+        resetView();
+        resetValidity();
       }
 
       /// \brief Write the data out using a writer.
@@ -938,7 +1612,8 @@ namespace bufr {
       {
         if (auto writerPtr = std::dynamic_pointer_cast<ObjectWriter<std::string>>(writer))
         {
-          writerPtr->write(data_);
+          resolveView();
+          writerPtr->writePacked(*data_, repeats_);
         }
         else
         {
@@ -953,6 +1628,9 @@ namespace bufr {
       /// \param comm The MPI communicator to use.
       void gather(const eckit::mpi::Comm& comm) final
       {
+        materialize();
+        resetValidity();
+
         size_t numDims = dims_.size();
         comm.reduce(numDims, numDims, eckit::mpi::Operation::MAX, 0);
 
@@ -988,46 +1666,39 @@ namespace bufr {
         bool adjustDims = false;
         for (size_t idx = 1; idx < rcvDims.size(); idx++)
         {
-          adjustDims = (rcvDims[idx] != getDims()[idx]);
+          adjustDims = adjustDims || (rcvDims[idx] != dims_[idx]);
         }
 
         // Resize the dimensions to match the global dimensions
         if (adjustDims)
         {
-          std::vector<std::string> sendBuffer(sendSize, missingValue());
+          std::vector<std::string_view> sendBuffer(sendSize);
 
-          // Map the local data into the sendBuffer using the dimensions
-          for (size_t i = 0; i < data_.size(); ++i)
+          // Copy the local data into the sendBuffer in blocks of whole inner rows
+          forEachPaddedRun(dims_, rcvDims, [&](size_t srcIdx, size_t dstIdx, size_t length)
           {
-            Location loc;
-
-            // Compute the location coordinate in the old data
-            size_t idx = i;
-            for (size_t dimIdx = 0; dimIdx < dims_.size(); ++dimIdx)
+            for (size_t idx = 0; idx < length; ++idx)
             {
-              loc.push_back(idx % dims_[dimIdx]);
-              idx /= dims_[dimIdx];
+              sendBuffer[dstIdx + idx] = (*data_)[srcIdx + idx];
             }
+          });
 
-            // Map that location into the new data (compute the new index)
-            idx = 0;
-            for (size_t dimIdx = 0; dimIdx < rcvDims.size(); ++dimIdx)
-            {
-              idx += loc[dimIdx] * rcvDims[dimIdx];
-            }
-
-            sendBuffer[idx] = data_[i];
-          }
-
-          data_ = std::move(sendBuffer);
+          data_ = std::make_shared<PackedStrings>(sendBuffer);
+          std::copy(rcvDims.begin() + 1, rcvDims.end(), dims_.begin() + 1);
         }
 
-        size_t charsToSend = 0;
-        for (const auto& str : data_)
+        // Flatten the strings (without the terminators) and their sizes
+        std::vector<char> charSendBuffer;
+        std::vector<int> myStrSizes(data_->size());
+        for (size_t idx = 0; idx < data_->size(); ++idx)
         {
-          charsToSend += str.size();
+          const auto str = (*data_)[idx];
+          charSendBuffer.insert(charSendBuffer.end(), str.begin(), str.end());
+          myStrSizes[idx] = static_cast<int>(str.size());
         }
 
+        size_t charsToSend = charSendBuffer.size();
+
         size_t charsToReceive = charsToSend;
         comm.reduce(charsToReceive, charsToReceive, eckit::mpi::Operation::SUM, 0);
 
@@ -1043,20 +1714,8 @@ namespace bufr {
           displacement[i] =  displacement[i - 1] + sizeArray[i - 1];
         }
 
-        std::vector<char> charSendBuffer;
-        for (const auto& str : data_)
-        {
-          charSendBuffer.insert(charSendBuffer.end(), str.begin(), str.end());
-        }
-
         comm.gatherv(charSendBuffer, rcvBuffer, sizeArray, displacement, 0);
 
-        std::vector<int> myStrSizes(data_.size());
-        for (size_t idx=0; idx < data_.size(); ++idx)
-        {
-          myStrSizes[idx] = data_[idx].size();
-        }
-
         comm.allGather(static_cast<int>(myStrSizes.size()), sizeArray.begin(), sizeArray.end());
 
         for (size_t i = 1; i < comm.size(); i++)
@@ -1064,7 +1723,7 @@ namespace bufr {
           displacement[i] =  displacement[i - 1] + sizeArray[i - 1];
         }
 
-        size_t numStrs = data_.size();
+        size_t numStrs = data_->size();
         comm.reduce(numStrs, numStrs, eckit::mpi::Operation::SUM, 0);
         std::vector<int> strSizes(numStrs);
         comm.gatherv(myStrSizes, strSizes, sizeArray, displacement, 0);
@@ -1074,14 +1733,16 @@ namespace bufr {
           dims_ = rcvDims;
 
           // write rcvBuffer back to data
-          data_.resize(numStrs);
+          auto strings = std::make_shared<PackedStrings>();
+          strings->reserve(numStrs, charsToReceive);
           size_t offset = 0;
           for (size_t idx = 0; idx < numStrs; ++idx)
           {
-            std::string str(rcvBuffer.begin() + offset, rcvBuffer.begin() + offset + strSizes[idx]);
-            data_[idx] = str;
+            strings->push_back(std::string_view(rcvBuffer.data() + offset, strSizes[idx]));
             offset += strSizes[idx];
           }
+
+          data_ = std::move(strings);
         }
       }
 
@@ -1089,6 +1750,9 @@ namespace bufr {
       /// \param comm The MPI communicator to use.
       void allGather(const eckit::mpi::Comm& comm) final
       {
+        materialize();
+        resetValidity();
+
         size_t numDims = dims_.size();
         comm.allReduce(numDims, numDims, eckit::mpi::Operation::MAX);
 
@@ -1124,46 +1788,39 @@ namespace bufr {
         bool adjustDims = false;
         for (size_t idx = 1; idx < rcvDims.size(); idx++)
         {
-          adjustDims = (rcvDims[idx] != getDims()[idx]);
+          adjustDims = adjustDims || (rcvDims[idx] != dims_[idx]);
         }
 
         // Resize the dimensions to match the global dimensions
         if (adjustDims)
         {
-          std::vector<std::string> sendBuffer(sendSize, missingValue());
+          std::vector<std::string_view> sendBuffer(sendSize);
 
-          // Map the local data into the sendBuffer using the dimensions
-          for (size_t i = 0; i < data_.size(); ++i)
+          // Copy the local data into the sendBuffer in blocks of whole inner rows
+          forEachPaddedRun(dims_, rcvDims, [&](size_t srcIdx, size_t dstIdx, size_t length)
           {
-            Location loc;
-
-            // Compute the location coordinate in the old data
-            size_t idx = i;
-            for (size_t dimIdx = 0; dimIdx < dims_.size(); ++dimIdx)
+            for (size_t idx = 0; idx < length; ++idx)
             {
-              loc.push_back(idx % dims_[dimIdx]);
-              idx /= dims_[dimIdx];
+              sendBuffer[dstIdx + idx] = (*data_)[srcIdx + idx];
             }
+          });
 
-            // Map that location into the new data (compute the new index)
-            idx = 0;
-            for (size_t dimIdx = 0; dimIdx < rcvDims.size(); ++dimIdx)
-            {
-              idx += loc[dimIdx] * rcvDims[dimIdx];
-            }
-
-            sendBuffer[idx] = data_[i];
-          }
-
-          data_ = std::move(sendBuffer);
+          data_ = std::make_shared<PackedStrings>(sendBuffer);
+          std::copy(rcvDims.begin() + 1, rcvDims.end(), dims_.begin() + 1);
         }
 
-        size_t charsToSend = 0;
-        for (const auto& str : data_)
+        // Flatten the strings (without the terminators) and their sizes
+        std::vector<char> charSendBuffer;
+        std::vector<int> myStrSizes(data_->size());
+        for (size_t idx = 0; idx < data_->size(); ++idx)
         {
-          charsToSend += str.size();
+          const auto str = (*data_)[idx];
+          charSendBuffer.insert(charSendBuffer.end(), str.begin(), str.end());
+          myStrSizes[idx] = static_cast<int>(str.size());
         }
 
+        size_t charsToSend = charSendBuffer.size();
+
         size_t charsToReceive = charsToSend;
         comm.allReduce(charsToReceive, charsToReceive, eckit::mpi::Operation::SUM);
 
@@ -1179,21 +1836,9 @@ namespace bufr {
           displacement[i] =  displacement[i - 1] + sizeArray[i - 1];
         }
 
-        std::vector<char> charSendBuffer;
-        for (const auto& str : data_)
-        {
-          charSendBuffer.insert(charSendBuffer.end(), str.begin(), str.end());
-        }
-
         comm.allGatherv(charSendBuffer.begin(), charSendBuffer.end(), rcvBuffer.begin(),
                         sizeArray.data(), displacement.data());
 
-        std::vector<int> myStrSizes(data_.size());
-        for (size_t idx=0; idx < data_.size(); ++idx)
-        {
-          myStrSizes[idx] = data_[idx].size();
-        }
-
         comm.allGather(static_cast<int>(myStrSizes.size()), sizeArray.begin(), sizeArray.end());
 
         for (size_t i = 1; i < comm.size(); i++)
@@ -1201,7 +1846,7 @@ namespace bufr {
           displacement[i] =  displacement[i - 1] + sizeArray[i - 1];
         }
 
-        size_t numStrs = data_.size();
+        size_t numStrs = data_->size();
         comm.allReduce(numStrs, numStrs, eckit::mpi::Operation::SUM);
         std::vector<int> strSizes(numStrs);
         comm.allGatherv(myStrSizes.begin(), myStrSizes.end(), strSizes.begin(),
@@ -1210,14 +1855,154 @@ namespace bufr {
         dims_ = rcvDims;
 
         // write rcvBuffer back to data
-        data_.resize(numStrs);
+        auto strings = std::make_shared<PackedStrings>();
+        strings->reserve(numStrs, charsToReceive);
         size_t offset = 0;
         for (size_t idx = 0; idx < numStrs; ++idx)
         {
-          std::string str(rcvBuffer.begin() + offset, rcvBuffer.begin() + offset + strSizes[idx]);
-          data_[idx] = str;
+          strings->push_back(std::string_view(rcvBuffer.data() + offset, strSizes[idx]));
           offset += strSizes[idx];
         }
+
+        data_ = std::move(strings);
+      }
+
+      /// \brief Get the number of bytes the data takes when packed for DataContainer::gather
+      ///        (the length of each string followed by the characters).
+      size_t packedSize() const final
+      {
+        const size_t numStrs = size();
+        size_t numChars = 0;
+        for (size_t idx = 0; idx < numStrs; ++idx)
+        {
+          numChars += valueAt(idx).size();
+        }
+
+        return numStrs * sizeof(int) + numChars;
+      }
+
+      /// \brief Copy the data into a buffer of packedSize() bytes (the selected rows of a
+      ///        view, broadcast values repeated).
+      /// \param buffer The buffer to write to.
+      void pack(char* buffer) const final
+      {
+        const size_t numStrs = size();
+        char* chars = buffer + numStrs * sizeof(int);
+        for (size_t idx = 0; idx < numStrs; ++idx)
+        {
+          const auto str = valueAt(idx);
+          const auto length = static_cast<int>(str.size());
+          std::memcpy(buffer + idx * sizeof(int), &length, sizeof(int));
+          std::memcpy(chars, str.data(), str.size());
+          chars += str.size();
+        }
+      }
+
+      /// \brief Replace the data with the packed data from several ranks (in rank order).
+      /// \param parts The packed data of each rank.
+      /// \param partDims The dimensions of the data of each rank.
+      /// \param dims The dimensions of the result.
+      void unpack(const std::vector<const char*>& parts,
+                  const std::vector<Dimensions>& partDims,
+                  const Dimensions& dims) final
+      {
+        size_t rowLength = 1;
+        for (size_t dimIdx = 1; dimIdx < dims.size(); ++dimIdx)
+        {
+          rowLength *= dims[dimIdx];
+        }
+
+        // The views point into the packed parts, which outlive them.
+        std::vector<std::string_view> strs(dims[0] * rowLength);
+
+        size_t rowOffset = 0;
+        for (size_t partIdx = 0; partIdx < parts.size(); ++partIdx)
+        {
+          const auto& fromDims = partDims[partIdx];
+          size_t numStrs = 1;
+          for (const auto dim : fromDims)
+          {
+            numStrs *= dim;
+          }
+
+          // The runs come in source order, so the characters are read straight through.
+          const char* lengths = parts[partIdx];
+          const char* chars = lengths + numStrs * sizeof(int);
+          std::string_view* dst = strs.data() + rowOffset * rowLength;
+          forEachPaddedRun(fromDims, dims, [&](size_t srcIdx, size_t dstIdx, size_t numInRun)
+          {
+            for (size_t idx = 0; idx < numInRun; ++idx)
+            {
+              int length;
+              std::memcpy(&length, lengths + (srcIdx + idx) * sizeof(int), sizeof(int));
+              dst[dstIdx + idx] = std::string_view(chars, length);
+              chars += length;
+            }
+          });
+
+          rowOffset += fromDims[0];
+        }
+
+        resetView();
+        resetValidity();
+        repeats_ = 1;
+        dims_ = dims;
+        data_ = std::make_shared<PackedStrings>(strs);
+      }
+
+      /// \brief Replace the data with the values of several objects one after the other.
+      /// \param objects The objects to concatenate.
+      void concat(const std::vector<std::shared_ptr<DataObjectBase>>& objects) final
+      {
+        size_t numStrs = 0;
+        for (const auto& object : objects)
+        {
+          if (!std::dynamic_pointer_cast<DataObject<std::string>>(object))
+          {
+            std::ostringstream str;
+            str << "Cannot concatenate data of type " << typeid(*object).name();
+            throw eckit::BadParameter(str.str());
+          }
+
+          numStrs += object->size();
+        }
+
+        auto dims = concatDims(objects);
+
+        auto data = std::make_shared<PackedStrings>();
+        data->reserve(numStrs);
+        for (const auto& object : objects)
+        {
+          const auto& part = static_cast<const DataObject<std::string>&>(*object);
+          const auto& partData = *part.data_;
+          if (part.isView())
+          {
+            for (const auto row : *part.rowSelection_)
+            {
+              data->appendRange(partData, row * part.rowLength_, part.rowLength_);
+            }
+          }
+          else if (part.isBroadcast())
+          {
+            for (size_t idx = 0; idx < partData.size(); ++idx)
+            {
+              for (size_t repeat = 0; repeat < part.repeats_; ++repeat)
+              {
+                data->push_back(partData[idx]);
+              }
+            }
+          }
+          else
+          {
+            data->append(partData);
+          }
+        }
+
+        concatValidity(objects);
+        resetView();
+        repeats_ = 1;
+        dims_ = std::move(dims);
+        data_ = std::move(data);
       }
 
       /// \brief Append the data from another DataObject to this one.
@@ -1242,7 +2027,24 @@ namespace bufr {
             throw eckit::BadParameter(str.str());
           }
         }
-        data_.insert(data_.end(), other->data_.begin(), other->data_.end());
+
+        resolveView();
+
+        if (repeats_ == other->repeats_ && !other->isView())
+        {
+          // Objects with the same repeat factor can be appended without expanding them.
+          const auto otherData = other->data_;  // keeps it alive if it is our own data
+          mutableData().append(*otherData);
+        }
+        else
+        {
+          materialize();
+          const auto otherObj = std::static_pointer_cast<DataObject<std::string>>(other->copy());
+          otherObj->materialize();
+          mutableData().append(*otherObj->data_);
+        }
+
+        appendValidity(*other);
       }
 
       /// \brief Makes a new dimension scale using this data object as the source
@@ -1251,19 +2053,32 @@ namespace bufr {
       std::shared_ptr<DimensionDataBase> createDimensionFromData(const std::string& name,
                                                                  std::size_t dimIdx) const final
       {
+        if (isBroadcast() || isView())
+        {
+          auto denseObj = std::static_pointer_cast<DataObject<std::string>>(copy());
+          denseObj->materialize();
+          return denseObj->createDimensionFromData(name, dimIdx);
+        }
+
         auto dimData = std::make_shared<DimensionData<std::string>>(name, getDims()[dimIdx]);
 
-        std::copy(data_.begin(),
-                  data_.begin() + dimData->data.size(),
-                  dimData->data.begin());
+        const auto& data = *data_;
+        const size_t dimSize = dimData->data.size();
+        for (size_t idx = 0; idx < dimSize && idx < data.size(); ++idx)
+        {
+          dimData->data[idx] = std::string(data[idx]);
+        }
 
         // Validate this data object (has values that repeat for each frame
-        for (size_t idx = 0; idx < data_.size(); idx += dimData->data.size())
+        for (size_t idx = 0; idx < data.size(); idx += dimSize)
         {
-          if (!std::equal(data_.begin(),
-                          data_.begin() + dimData->data.size(),
-                          data_.begin() + idx,
-                          data_.begin() + idx + dimData->data.size()))
+          bool repeats = true;
+          for (size_t valIdx = 0; valIdx < dimSize && repeats; ++valIdx)
+          {
+            repeats = (idx + valIdx < data.size()) && (data[valIdx] == data[idx + valIdx]);
+          }
+
+          if (!repeats)
           {
             std::stringstream errStr;
             errStr << "Dimension " << name << " has an invalid source field. ";
@@ -1275,7 +2090,8 @@ namespace bufr {
         return dimData;
       }
 
-      /// \brief Slice the data object according to a list of indices.
+      /// \brief Slice the data object according to a list of indices. Dense data is not
+      ///        copied, the result is a view of the selected rows (see isView).
       /// \param rows The indices to slice the data object by.
       /// \return Sliced DataObject.
       std::shared_ptr<DataObjectBase> slice(const std::vector<std::size_t>& rows) const final
@@ -1287,45 +2103,149 @@ namespace bufr {
           extraDims *= dims_[i];
         }
 
-        // Make new DataObject with the rows we want
-        std::vector<std::string> newData;
-        newData.reserve(rows.size() * extraDims);
-        for (std::size_t i = 0; i < rows.size(); ++i)
+        auto slicedDataObject = std::make_shared<DataObject<std::string>>();
+
+        if (isBroadcast())
         {
-          newData.insert(newData.end(),
-                         data_.begin() + rows[i] * extraDims,
-                         data_.begin() + (rows[i] + 1) * extraDims);
+          // Make new DataObject with the rows we want
+          PackedStrings newData;
+          newData.reserve(rows.size() * extraDims);
+          for (std::size_t i = 0; i < rows.size(); ++i)
+          {
+            for (std::size_t j = 0; j < extraDims; ++j)
+            {
+              newData.push_back(valueAt(rows[i] * extraDims + j));
+            }
+          }
+
+          slicedDataObject->setData(std::move(newData));
+        }
+        else
+        {
+          slicedDataObject->data_ = data_;
+          slicedDataObject->rowSelection_ = composeRows(rows);
+          slicedDataObject->rowLength_ = extraDims;
         }
 
         auto sliceDims = dims_;
         sliceDims[0] = rows.size();
 
-        auto slicedDataObject = std::make_shared<DataObject<std::string>>();
-
-        slicedDataObject->setData(newData);
         slicedDataObject->setFieldName(fieldName_);
         slicedDataObject->setGroupByFieldName(groupByFieldName_);
         slicedDataObject->setDims(sliceDims);
         slicedDataObject->setQuery(query_);
         slicedDataObject->setDimPaths(dimPaths_);
 
+        // Carry the validity over instead of recomputing it from the sliced values.
+        slicedDataObject->validity_ = std::make_shared<const ValidityBitmap>(
+          isBroadcast() ? getExpandedValidity().selectRows(rows, extraDims)
+                        : getValidity().selectRows(rows, extraDims));
+
         return slicedDataObject;
       }
 
-      /// \brief Get the raw data associated with this data object.
+      /// \brief Get the packed strings without copying them. Only valid while the object is
+      ///        alive and its data is not changed (setData, append, gather, allGather or
+      ///        materialize). Broadcast objects and row selection views must be materialized
+      ///        first. There is no mutable view for strings since the packed characters can't
+      ///        be resized in place.
+      /// \return The packed strings.
+      const PackedStrings& getDataView() const
+      {
+        if (isBroadcast() || isView())
+        {
+          std::ostringstream errStr;
+          errStr << "Can not view broadcast or sliced field \"" << fieldName_ << "\" without ";
+          errStr << "materializing it first.";
+          throw eckit::BadValue(errStr.str());
+        }
+
+        return *data_;
+      }
+
+      /// \brief Get a copy of the data associated with this data object (broadcast data is
+      ///        expanded). Prefer getDataView unless a copy is really needed.
       /// \return The raw data.
-      std::vector<std::string> getRawData() const { return data_; }
+      std::vector<std::string> getRawData() const
+      {
+        if (!isBroadcast() && !isView())
+        {
+          return data_->toVector();
+        }
+
+        std::vector<std::string> data;
+        data.reserve(size());
+        for (size_t idx = 0; idx < size(); ++idx)
+        {
+          data.emplace_back(valueAt(idx));
+        }
+
+        return data;
+      }
+
+      /// \brief Expand broadcast data or copy out the rows of a view into dense data.
+      void materialize() final
+      {
+        resolveView();
+
+        if (isBroadcast())
+        {
+          data_ = std::make_shared<PackedStrings>(data_->repeat(repeats_));
+          expandValidity();
+          repeats_ = 1;
+        }
+      }
 
       /// \brief Get the size of the data object.
       /// \return The size of the data object.
       size_t size() const final
       {
-        return data_.size();
+        return isView() ? rowSelection_->size() * rowLength_ : data_->size() * repeats_;
+      }
+
+      /// \brief Get the value for an index, taking broadcasting into account.
+      /// \param idx The index into the (expanded) data.
+      /// \return The value.
+      inline std::string_view valueAt(size_t idx) const
+      {
+        if (rowSelection_) return (*data_)[storedIdx(idx)];
+        return (repeats_ == 1) ? (*data_)[idx] : (*data_)[idx / repeats_];
       }
 
       friend class DataObjectBuilder;
 
+    protected:
+      /// \brief Compute the validity bitmap for the stored values.
+      ValidityBitmap computeValidity() const final
+      {
+        auto validity = ValidityBitmap::fromStrings(*data_);
+        return isView() ? validity.selectRows(*rowSelection_, rowLength_) : validity;
+      }
+
     private:
-      std::vector<std::string> data_;
+      /// Values (shared with copies and views, so it is copied before it is written to)
+      std::shared_ptr<PackedStrings> data_ = std::make_shared<PackedStrings>();
+
+      /// \brief Get the data for writing (makes our own copy if it is shared).
+      PackedStrings& mutableData()
+      {
+        if (data_.use_count() > 1)
+        {
+          data_ = std::make_shared<PackedStrings>(*data_);
+        }
+
+        return *data_;
+      }
+
+      /// \brief Copy the selected rows of a view into our own data. The validity bitmap
+      ///        already describes the selected values, so it is kept.
+      void resolveView()
+      {
+        if (isView())
+        {
+          data_ = std::make_shared<PackedStrings>(data_->take(*rowSelection_, rowLength_));
+          resetView();
+        }
+      }
   };
 }  // namespace bufr
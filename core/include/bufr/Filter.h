@@ -4,6 +4,8 @@
 #include "eckit/config/LocalConfiguration.h"
 
 #include "bufr/BufrTypes.h"
+#include "bufr/QuerySet.h"
+#include "bufr/Variable.h"
 
 namespace bufr {
     /// \brief Base class for all the supported filters.
@@ -18,6 +20,13 @@ namespace bufr {
         /// \param dataMap Map to modify by filtering out relevant data.
         virtual void apply(BufrDataMap& dataMap) = 0;
 
+        /// \brief Add the parts of the filter that can be checked on the raw subset values to
+        ///        the query set, so rejected subsets are dropped while the file is read. The
+        ///        filter is still applied to the collected data afterwards.
+        /// \param querySet The query set that is executed to collect the data.
+        /// \param queries The queries of the export (with the types they are read as).
+        virtual void pushDown(QuerySet& querySet, const QueryList& queries) const {}
+
      protected:
         eckit::LocalConfiguration conf_;
     };
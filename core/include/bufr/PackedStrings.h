@@ -0,0 +1,113 @@
+/*
+* (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+*
+* This software is licensed under the terms of the Apache Licence Version 2.0
+* which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+*/
+
+#pragma once
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bufr {
+
+  /// \brief Column of strings stored in one contiguous character buffer instead of one heap
+  ///        object per string. Every string is NUL terminated in the buffer, so c_str pointers
+  ///        can be handed straight to C APIs (netCDF). Short strings (station ids and the like,
+  ///        which is almost all BUFR string data) are kept in fixed width slots so no offsets
+  ///        are needed. The first longer string switches the column to offsets mode.
+  class PackedStrings
+  {
+    public:
+      /// \brief Longest string that fits in a fixed width slot (one BUFR octet value).
+      static constexpr size_t FixedWidth = 8;
+
+      PackedStrings() = default;
+
+      /// \brief Pack a list of strings.
+      explicit PackedStrings(const std::vector<std::string>& strings);
+
+      /// \brief Pack a list of string views (the views can point into another PackedStrings).
+      explicit PackedStrings(const std::vector<std::string_view>& strings);
+
+      /// \brief Get the number of strings.
+      size_t size() const { return size_; }
+
+      /// \brief Are there no strings.
+      bool empty() const { return size_ == 0; }
+
+      /// \brief Are the strings stored in fixed width slots (as opposed to with offsets).
+      bool isFixedWidth() const { return offsets_.empty(); }
+
+      /// \brief Get a view of the string at an index (valid until the column is changed).
+      std::string_view operator[](size_t idx) const
+      {
+        if (isFixedWidth())
+        {
+          const char* slot = chars_.data() + idx * SlotSize;
+          return std::string_view(slot, strnlen(slot, FixedWidth));
+        }
+
+        return std::string_view(chars_.data() + offsets_[idx],
+                                offsets_[idx + 1] - offsets_[idx] - 1);
+      }
+
+      /// \brief Get a NUL terminated pointer to the string at an index.
+      const char* c_str(size_t idx) const
+      {
+        return chars_.data() + (isFixedWidth() ? idx * SlotSize : offsets_[idx]);
+      }
+
+      /// \brief Reserve space.
+      /// \param numStrings The number of strings.
+      /// \param numChars The total length of the strings (ignored in fixed width mode).
+      void reserve(size_t numStrings, size_t numChars = 0);
+
+      /// \brief Add a string to the end of the column.
+      void push_back(std::string_view str);
+
+      /// \brief Add the strings from another column (block copied where possible).
+      void append(const PackedStrings& other) { appendRange(other, 0, other.size()); }
+
+      /// \brief Add a range of strings from another column (block copied where possible).
+      /// \param other The column to copy from.
+      /// \param start The index of the first string to copy.
+      /// \param count The number of strings to copy.
+      void appendRange(const PackedStrings& other, size_t start, size_t count);
+
+      /// \brief Make a column out of selected rows of strings (see DataObject::slice). Runs of
+      ///        consecutive rows are block copied (fixed width columns with takeRows).
+      /// \param rows The indices of the rows to copy.
+      /// \param rowLength The number of strings in a row.
+      PackedStrings take(const std::vector<size_t>& rows, size_t rowLength) const;
+
+      /// \brief Make a column where every string is repeated a number of times in a row (the
+      ///        data of a broadcast object once it is expanded).
+      /// \param repeats Number of times each string is repeated.
+      PackedStrings repeat(size_t repeats) const;
+
+      /// \brief Copy the strings into a list of std::string.
+      std::vector<std::string> toVector() const;
+
+    private:
+      static constexpr size_t SlotSize = FixedWidth + 1;
+
+      size_t size_ = 0;
+
+      /// NUL terminated characters (fixed width slots or back to back strings)
+      std::vector<char> chars_;
+
+      /// Start of each string in chars_ plus the end (empty in fixed width mode)
+      std::vector<size_t> offsets_;
+
+      /// \brief Repack the fixed width slots as back to back strings with offsets.
+      void makeVariableWidth();
+
+      /// \brief Pack a list of strings (std::string or std::string_view).
+      template<typename Strings>
+      void assign(const Strings& strings);
+  };
+}  // namespace bufr
@@ -38,6 +38,20 @@ namespace bufr {
     /// \param[in] query The query string.
     void add(const std::string& name, const std::string& query);
 
+    /// \brief Only collect the subsets where the value of a query is within the given bounds
+    ///        (checked on the raw subset values while the file is read). Queries that have more
+    ///        than one value per subset are not checked. The values are compared in the type
+    ///        they are read as (see ResultSet::get), so missing values compare as the fill value
+    ///        of that type.
+    /// \param[in] name The name of the query (must already be added).
+    /// \param[in] lowerBound The smallest allowed value.
+    /// \param[in] upperBound The largest allowed value.
+    /// \param[in] type The override type the query is read as (empty for the type of the field).
+    void addBounds(const std::string& name,
+                   float lowerBound,
+                   float upperBound,
+                   const std::string& type = "");
+
     /// \brief Returns the size of the collection.
     size_t size() const;
 
@@ -0,0 +1,153 @@
+/*
+* (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+*
+* This software is licensed under the terms of the Apache Licence Version 2.0
+* which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+
+#include "DataObject.h"
+#include "QueryParser.h"
+#include "ValidityBitmap.h"
+
+namespace bufr {
+
+  /// \brief Data for a jagged field stored as flat values and row offsets (the values for row
+  ///        i are values[rowOffsets[i]] to values[rowOffsets[i + 1]]). Unlike DataObject, the
+  ///        rows are not padded to the maximum number of repeats, so memory scales with the
+  ///        actual amount of data.
+  class RaggedDataObjectBase
+  {
+    public:
+      RaggedDataObjectBase() = default;
+      virtual ~RaggedDataObjectBase() = default;
+
+      /// \brief Get the total number of values (all rows).
+      virtual size_t size() const = 0;
+
+      /// \brief Is the value at the (flat) index the missing value.
+      /// \param idx The index into the flat values.
+      virtual bool isMissing(size_t idx) const = 0;
+
+      /// \brief Make a padded DataObject (rows x max row size) out of the ragged data.
+      virtual std::shared_ptr<DataObjectBase> toDataObject() const = 0;
+
+      /// \brief Get the number of rows.
+      size_t numRows() const { return rowOffsets_.size() - 1; }
+
+      /// \brief Get the number of values in a row.
+      /// \param row The row index.
+      size_t rowSize(size_t row) const { return rowOffsets_[row + 1] - rowOffsets_[row]; }
+
+      /// \brief Get the largest number of values in any row.
+      size_t maxRowSize() const
+      {
+        size_t maxSize = 0;
+        for (size_t row = 0; row < numRows(); ++row)
+        {
+          maxSize = std::max(maxSize, rowSize(row));
+        }
+
+        return maxSize;
+      }
+
+      // Setters
+      void setFieldName(const std::string& fieldName) { fieldName_ = fieldName; }
+      void setDimPaths(const std::vector<Query>& dimPaths) { dimPaths_ = dimPaths; }
+
+      // Getters
+      std::string getFieldName() const { return fieldName_; }
+      std::vector<Query> getDimPaths() const { return dimPaths_; }
+      const std::vector<size_t>& getRowOffsets() const { return rowOffsets_; }
+
+    protected:
+      std::string fieldName_;
+      std::vector<size_t> rowOffsets_ = {0};
+      std::vector<Query> dimPaths_;
+  };
+
+  template<typename T>
+  class RaggedDataObject : public RaggedDataObjectBase
+  {
+    public:
+      RaggedDataObject() = default;
+
+      /// \brief Set the values and the row offsets.
+      /// \param values The flat values for all the rows.
+      /// \param rowOffsets The offset of each row into the values (number of rows + 1 entries).
+      void setData(std::vector<T>&& values, std::vector<size_t>&& rowOffsets)
+      {
+        if (rowOffsets.empty() || rowOffsets.front() != 0 || rowOffsets.back() != values.size())
+        {
+          std::ostringstream errStr;
+          errStr << "Invalid row offsets for ragged field " << fieldName_ << ".";
+          throw eckit::BadParameter(errStr.str());
+        }
+
+        values_ = std::move(values);
+        rowOffsets_ = std::move(rowOffsets);
+      }
+
+      /// \brief Get the flat values for all the rows.
+      const std::vector<T>& getValues() const { return values_; }
+
+      /// \brief Get the total number of values (all rows).
+      size_t size() const final { return values_.size(); }
+
+      /// \brief Is the value at the (flat) index the missing value.
+      /// \param idx The index into the flat values.
+      bool isMissing(size_t idx) const final
+      {
+        return values_[idx] == DataObject<T>::missingValue();
+      }
+
+      /// \brief Compute the validity bitmap for the flat values (missing strings are empty).
+      ValidityBitmap getValidity() const
+      {
+        if constexpr (std::is_same<T, std::string>::value)
+        {
+          return ValidityBitmap::fromStrings(values_);
+        }
+        else
+        {
+          return ValidityBitmap::fromValues(values_.data(), values_.size(),
+                                            DataObject<T>::missingValue());
+        }
+      }
+
+      /// \brief Make a padded DataObject (rows x max row size) out of the ragged data.
+      std::shared_ptr<DataObjectBase> toDataObject() const final
+      {
+        const auto rowLength = std::max<size_t>(maxRowSize(), 1);
+
+        std::vector<T> data(numRows() * rowLength, DataObject<T>::missingValue());
+        for (size_t row = 0; row < numRows(); ++row)
+        {
+          std::copy(values_.begin() + rowOffsets_[row],
+                    values_.begin() + rowOffsets_[row + 1],
+                    data.begin() + row * rowLength);
+        }
+
+        auto object = std::make_shared<DataObject<T>>();
+        object->setData(std::move(data));
+        object->setDims({static_cast<int>(numRows()), static_cast<int>(rowLength)});
+        object->setFieldName(fieldName_);
+        object->setDimPaths(dimPaths_);
+
+        return object;
+      }
+
+    private:
+      std::vector<T> values_;
+  };
+}  // namespace bufr
@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "DataObject.h"
+#include "RaggedDataObject.h"
 
 namespace bufr {
   class ResultSetImpl;
@@ -49,6 +50,15 @@ namespace bufr {
                                         const std::string& groupByFieldName = "",
                                         const std::string& overrideType     = "") const;
 
+    /// \brief Gets the resulting data for a jagged field as flat values plus row offsets
+    /// (one row per subset) instead of padding every row to the largest number of repeats.
+    /// \param fieldName The name of the field to get the data for (may have at most one
+    /// repeated dimension).
+    /// \param overrideType The name of the override type to convert the data to.
+    /// \return A RaggedDataObject containing the data.
+    std::shared_ptr<RaggedDataObjectBase> getRagged(const std::string& fieldName,
+                                                    const std::string& overrideType = "") const;
+
     friend class QueryRunner;
 
    private:
@@ -0,0 +1,64 @@
+/*
+* (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+*
+* This software is licensed under the terms of the Apache Licence Version 2.0
+* which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "bufr/DataContainer.h"
+
+namespace bufr {
+
+  /// \brief Node level cache that shares parsed BUFR data between processes through POSIX
+  /// shared memory (where DataCache only shares it inside one process). Entries are keyed by the
+  /// identity of the BUFR file (device, inode, size and modification time) and a hash of the
+  /// contents of the mapping file, so converters that read the same file with the same mapping
+  /// find the same entry. The first process to ask for an entry parses the data and publishes
+  /// the packed columns, the others wait for it and map the entry read only. Their numeric
+  /// columns point straight into the mapping (it is unmapped when the last of them goes away),
+  /// string columns are copied out of it.
+  ///
+  /// Entries are not cleaned up automatically. They stay in shared memory (/dev/shm, where they
+  /// count against its size) after every process that used them has exited, until remove is
+  /// called or the node reboots. Removing an entry that other processes still use is safe,
+  /// their mappings stay valid until they let go of the data.
+  class SharedDataCache {
+    public:
+      SharedDataCache() = delete;
+
+      /// \brief Get the data for the given srcPath and mapPath. If no process on the node has
+      ///        made it yet, this process makes it and publishes it. If another process is
+      ///        making it, this waits for it to finish.
+      /// \param srcPath The path to the source file.
+      /// \param mapPath The path to the map file.
+      /// \param make Function that parses the data (only called in the process that makes it).
+      static std::shared_ptr<DataContainer> getOrMake(
+        const std::string& srcPath,
+        const std::string& mapPath,
+        const std::function<std::shared_ptr<DataContainer>()>& make);
+
+      /// \brief Check if the shared memory holds finished data for the given srcPath and mapPath.
+      /// \param srcPath The path to the source file.
+      /// \param mapPath The path to the map file.
+      static bool has(const std::string& srcPath, const std::string& mapPath);
+
+      /// \brief Get the data for the given srcPath and mapPath (waits if another process is
+      ///        making it).
+      /// \param srcPath The path to the source file.
+      /// \param mapPath The path to the map file.
+      static std::shared_ptr<DataContainer> get(const std::string& srcPath,
+                                                const std::string& mapPath);
+
+      /// \brief Remove the entry for the given srcPath and mapPath from shared memory. Processes
+      ///        that already have the data keep it (the memory is freed once they all let go).
+      /// \param srcPath The path to the source file.
+      /// \param mapPath The path to the map file.
+      static void remove(const std::string& srcPath, const std::string& mapPath);
+  };
+}  // namespace bufr
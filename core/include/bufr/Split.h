@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <limits>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -31,10 +32,32 @@ namespace bufr {
         /// \result map of split data where the category is the key
         virtual std::unordered_map<std::string, BufrDataMap> split(const BufrDataMap& dataMap) = 0;
 
+        /// \brief Value rowCategories gives rows that are not in any of the categories.
+        static constexpr size_t NoCategory = std::numeric_limits<size_t>::max();
+
+        /// \brief Get the category of every row of the data (lets several splits be combined
+        ///        into one key per row, so the data is only sliced once).
+        /// \param dataMap Data to be split
+        /// \result index into subCategories(dataMap) for every row (NoCategory for dropped rows)
+        virtual std::vector<size_t> rowCategories(const BufrDataMap& dataMap) = 0;
+
+        /// \brief Slice every field of the data into several sets of rows in one go
+        /// \param dataMap Data to be sliced
+        /// \param rowSets The rows of each set
+        /// \result the sliced data of each set
+        static std::vector<BufrDataMap> sliceRows(const BufrDataMap& dataMap,
+                                                  const std::vector<std::vector<size_t>>& rowSets);
+
         /// \brief Get the split name
         inline std::string getName() const { return name_; }
 
      protected:
+        /// \brief Split the data by the category of every row (see rowCategories)
+        /// \param dataMap Data to be split
+        /// \result map of split data where the category is the key
+        std::unordered_map<std::string, BufrDataMap> splitByRowCategories(
+            const BufrDataMap& dataMap);
+
         /// \brief The name of the split as defined by the key in the YAML file.
         const std::string name_;
 
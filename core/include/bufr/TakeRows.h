@@ -0,0 +1,30 @@
+/*
+* (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+*
+* This software is licensed under the terms of the Apache Licence Version 2.0
+* which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace bufr {
+
+  /// \brief Copy the selected rows of a row major array into a dense array. Runs of
+  ///        consecutive rows (the common case for filters) are copied as single blocks, and
+  ///        large selections are split between OpenMP threads.
+  /// \param src The source array.
+  /// \param dst The destination array (must hold rows.size() * rowBytes bytes).
+  /// \param rows The indices of the rows to copy (in output order).
+  /// \param rowBytes The number of bytes in a row.
+  void takeRows(const void* src, void* dst, const std::vector<size_t>& rows, size_t rowBytes);
+
+  /// \brief Count the runs of consecutive rows in part of a selection (without branching on
+  ///        the row values, so it is cheap even for random selections).
+  /// \param rows The indices of the selected rows.
+  /// \param begin The first index into rows.
+  /// \param end One past the last index into rows.
+  size_t countRuns(const std::vector<size_t>& rows, size_t begin, size_t end);
+}  // namespace bufr
@@ -0,0 +1,263 @@
+/*
+* (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+*
+* This software is licensed under the terms of the Apache Licence Version 2.0
+* which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bufr {
+
+  /// \brief Bitmap with one bit per value that is set if the value is valid (not missing).
+  ///        The bits are packed into 64 bit words so that consumers can skip entire blocks of
+  ///        missing (or valid) values at a time. Bits past the end of the data are always 0.
+  class ValidityBitmap
+  {
+    public:
+      static constexpr size_t WordBits = 64;
+
+      /// \brief Instruction sets the packing kernels (fromValues, fromOctets) can use.
+      enum class Simd
+      {
+        None,
+        Avx2,
+        Avx512
+      };
+
+      ValidityBitmap() = default;
+
+      /// \brief Make a bitmap where every value is valid (or missing).
+      /// \param size The number of values.
+      /// \param valid The initial state of the bits.
+      explicit ValidityBitmap(size_t size, bool valid = true);
+
+      /// \brief Compute the bitmap for typed data (value != missingValue).
+      /// \param values Pointer to the values.
+      /// \param size The number of values.
+      /// \param missingValue The value that stands for missing.
+      template<typename T>
+      static ValidityBitmap fromValues(const T* values, size_t size, T missingValue);
+
+      /// \brief Compute the bitmap for raw BUFR octets (see Data::isMissing).
+      /// \param octets Pointer to the octet values.
+      /// \param size The number of values.
+      static ValidityBitmap fromOctets(const double* octets, size_t size);
+
+      /// \brief Compute the bitmap for string data (missing strings are empty).
+      /// \param strings The string values (any indexable list of strings, ex: PackedStrings).
+      template<typename Strings>
+      static ValidityBitmap fromStrings(const Strings& strings)
+      {
+        return pack(strings.size(), [&strings](size_t idx) { return !strings[idx].empty(); });
+      }
+
+      /// \brief Get the instruction sets the CPU supports (None is always first and the best
+      ///        one is last).
+      static std::vector<Simd> supportedSimd();
+
+      /// \brief Get the instruction set the packing kernels use (the best one the CPU supports
+      ///        unless changed with setSimd).
+      static Simd simd();
+
+      /// \brief Change the instruction set the packing kernels use (ex: to compare them in the
+      ///        tests). Throws if the CPU doesn't support it.
+      static void setSimd(Simd simd);
+
+      /// \brief Get the number of values covered by the bitmap.
+      size_t size() const { return size_; }
+
+      /// \brief Is the value at the index valid.
+      bool isValid(size_t idx) const { return (words_[idx / WordBits] >> (idx % WordBits)) & 1; }
+
+      /// \brief Is the value at the index missing.
+      bool isMissing(size_t idx) const { return !isValid(idx); }
+
+      /// \brief Get the number of valid values.
+      size_t countValid() const;
+
+      /// \brief Are all the values valid.
+      bool allValid() const { return countValid() == size_; }
+
+      /// \brief Get the packed words.
+      const std::vector<uint64_t>& getWords() const { return words_; }
+
+      /// \brief Call a function with the index of every valid value. Words without any valid
+      ///        values are skipped entirely.
+      /// \param func Callable taking the index (size_t) of the value.
+      template<typename Func>
+      void forEachValid(Func&& func) const
+      {
+        for (size_t wordIdx = 0; wordIdx < words_.size(); ++wordIdx)
+        {
+          uint64_t word = words_[wordIdx];
+          if (word == ~uint64_t(0))
+          {
+            for (size_t idx = wordIdx * WordBits; idx < (wordIdx + 1) * WordBits; ++idx)
+            {
+              func(idx);
+            }
+
+            continue;
+          }
+
+          while (word)
+          {
+            func(wordIdx * WordBits + __builtin_ctzll(word));
+            word &= word - 1;
+          }
+        }
+      }
+
+      /// \brief Reserve space for a number of bits (ex: before appending several bitmaps).
+      /// \param size The total number of bits.
+      void reserve(size_t size) { words_.reserve((size + WordBits - 1) / WordBits); }
+
+      /// \brief Append the bits of another bitmap (copied a word at a time).
+      /// \param other The bitmap to append.
+      void append(const ValidityBitmap& other) { appendRange(other, 0, other.size()); }
+
+      /// \brief Append a range of bits from another bitmap (copied a word at a time).
+      /// \param other The bitmap to copy from.
+      /// \param start The index of the first bit to copy.
+      /// \param count The number of bits to copy.
+      void appendRange(const ValidityBitmap& other, size_t start, size_t count);
+
+      /// \brief Make the bitmap for a selection of rows (see DataObject::slice).
+      /// \param rows The row indices to keep.
+      /// \param rowLength The number of values in a row.
+      /// \return The bitmap of the selected rows.
+      ValidityBitmap selectRows(const std::vector<size_t>& rows, size_t rowLength) const;
+
+      /// \brief Make the bitmap where every bit is repeated a number of times in a row (the
+      ///        bitmap of broadcast data once it is expanded).
+      /// \param repeats Number of times each bit is repeated.
+      /// \return The expanded bitmap.
+      ValidityBitmap repeat(size_t repeats) const;
+
+      /// \brief Combine with another bitmap of the same size (valid only where both are).
+      /// \param other The other bitmap.
+      ValidityBitmap& operator&=(const ValidityBitmap& other);
+
+      /// \brief Call a function for every run of consecutive valid values as a half open
+      ///        range [begin, end). Fully valid words are merged into long runs, so simple loops
+      ///        over each run can be vectorized by the compiler.
+      /// \param func Callable taking the begin and end index (size_t) of the run.
+      template<typename Func>
+      void forEachValidRun(Func&& func) const
+      {
+        size_t runBegin = 0;
+        size_t runEnd = 0;
+
+        for (size_t wordIdx = 0; wordIdx < words_.size(); ++wordIdx)
+        {
+          uint64_t word = words_[wordIdx];
+          const size_t wordStart = wordIdx * WordBits;
+
+          while (word)
+          {
+            // Find the next run of set bits in the word
+            const size_t first = __builtin_ctzll(word);
+            const uint64_t shifted = word >> first;
+            const size_t length = (~shifted == 0) ? WordBits - first : __builtin_ctzll(~shifted);
+
+            const size_t begin = wordStart + first;
+            if (begin == runEnd && runEnd != runBegin)
+            {
+              runEnd = begin + length;
+            }
+            else
+            {
+              if (runEnd != runBegin) func(runBegin, runEnd);
+              runBegin = begin;
+              runEnd = begin + length;
+            }
+
+            word = (first + length >= WordBits) ? 0 : word & (~uint64_t(0) << (first + length));
+          }
+        }
+
+        if (runEnd != runBegin) func(runBegin, runEnd);
+      }
+
+      /// \brief Write a numpy style mask (true where missing, one byte per value). Each bit is
+      ///        written `repeats` times in a row for broadcast data.
+      /// \param mask The output mask (must hold size() * repeats values).
+      /// \param repeats Number of times each value is repeated.
+      void fillMissingMask(bool* mask, size_t repeats = 1) const;
+
+    private:
+      std::vector<uint64_t> words_;
+      size_t size_ = 0;
+
+      /// \brief Allocate the words for a number of values (all bits cleared).
+      void allocate(size_t size);
+
+      /// \brief Get up to 64 bits starting at an index (packed into the low bits).
+      uint64_t extractBits(size_t start, size_t count) const;
+
+      /// \brief Push up to 64 bits (taken from the low bits) onto the end of the bitmap.
+      void pushBits(uint64_t bits, size_t count);
+
+      /// \brief Pack the bits for values that are compared one at a time.
+      template<typename IsValid>
+      static ValidityBitmap pack(size_t size, IsValid&& isValid);
+
+      /// \brief Pack the bits using a kernel that fills all the full words (called with the
+      ///        words and their number), the tail of the data is packed with isValid.
+      template<typename WordKernel, typename IsValid>
+      static ValidityBitmap packWords(size_t size, WordKernel&& kernel, IsValid&& isValid);
+  };
+
+  template<typename IsValid>
+  ValidityBitmap ValidityBitmap::pack(size_t size, IsValid&& isValid)
+  {
+    ValidityBitmap bitmap;
+    bitmap.allocate(size);
+
+    for (size_t wordIdx = 0; wordIdx < bitmap.words_.size(); ++wordIdx)
+    {
+      const size_t start = wordIdx * WordBits;
+      const size_t end = std::min(start + WordBits, size);
+
+      uint64_t word = 0;
+      for (size_t idx = start; idx < end; ++idx)
+      {
+        word |= static_cast<uint64_t>(isValid(idx)) << (idx - start);
+      }
+
+      bitmap.words_[wordIdx] = word;
+    }
+
+    return bitmap;
+  }
+
+  template<typename T>
+  ValidityBitmap ValidityBitmap::fromValues(const T* values, size_t size, T missingValue)
+  {
+    return pack(size, [values, missingValue](size_t idx) { return values[idx] != missingValue; });
+  }
+
+  // SIMD specializations (see ValidityBitmap.cpp)
+  template<>
+  ValidityBitmap ValidityBitmap::fromValues<float>(const float* values,
+                                                   size_t size,
+                                                   float missingValue);
+  template<>
+  ValidityBitmap ValidityBitmap::fromValues<double>(const double* values,
+                                                    size_t size,
+                                                    double missingValue);
+  template<>
+  ValidityBitmap ValidityBitmap::fromValues<int32_t>(const int32_t* values,
+                                                     size_t size,
+                                                     int32_t missingValue);
+  template<>
+  ValidityBitmap ValidityBitmap::fromValues<int64_t>(const int64_t* values,
+                                                     size_t size,
+                                                     int64_t missingValue);
+}  // namespace bufr
@@ -5,6 +5,7 @@
 #include <memory>
 
 #include "eckit/config/LocalConfiguration.h"
+#include "eckit/mpi/Comm.h"
 #include <netcdf>
 
 #include "bufr/DataContainer.h"
@@ -25,11 +26,27 @@ namespace netcdf {
             bool isMemoryFile;
             std::string path;
 
-            Backend() : isMemoryFile(true), path("") {};
+            /// Ranks that write the file together (null unless the file is written in parallel)
+            const eckit::mpi::Comm* comm;
+
+            Backend() : isMemoryFile(true), path(""), comm(nullptr) {};
 
             Backend(bool isInMemory, const std::string &backendPath) :
                 isMemoryFile(isInMemory),
-                path(backendPath) {};
+                path(backendPath),
+                comm(nullptr) {};
+
+            /// \brief Write one file from all the ranks of comm with parallel netCDF-4 (MPI-IO).
+            ///        Every rank writes its own rows of the numeric variables, so they are not
+            ///        gathered first. String variables are still gathered into rank 0 (HDF5 has
+            ///        no parallel I/O for variable length data). Needs a netCDF library built
+            ///        with parallel I/O (encode throws otherwise).
+            Backend(const std::string &backendPath, const eckit::mpi::Comm &parallelComm) :
+                isMemoryFile(false),
+                path(backendPath),
+                comm(&parallelComm) {};
+
+            bool isParallel() const { return comm != nullptr; }
         };
 
         explicit Encoder(const std::string &yamlPath);
@@ -38,7 +55,9 @@ namespace netcdf {
 
         explicit Encoder(const eckit::Configuration &conf);
 
-        /// \brief Encode the data into an netcdf NcFile object
+        /// \brief Encode the data into an netcdf NcFile object. Parallel backends are encoded
+        ///        collectively (every rank of the backend comm has to call this) and the files
+        ///        are closed before returning, so no files are returned.
         /// \param data The data container to use
         /// \param append Add data to existing file?
         std::map<SubCategory, std::shared_ptr<nc::NcFile>>
@@ -5,6 +5,7 @@
 #include <chrono>  // NOLINT
 #include <iostream>
 #include <ostream>
+#include <unordered_map>
 
 #include <unistd.h>
 
@@ -67,6 +68,8 @@ namespace bufr {
             }
         }
 
+        pushDownFilters(querySet);
+
         log::info() << "Executing Queries" << std::endl;
         const auto resultSet = file_.execute(querySet, maxMsgsToParse);
 
@@ -82,7 +85,7 @@ namespace bufr {
         }
 
         log::info()  << "Exporting Data" << std::endl;
-        auto exportedData = exportData(srcData);
+        auto exportedData = exportData(std::move(srcData));
 
         auto timeElapsed = std::chrono::steady_clock::now() - startTime;
         auto timeElapsedDuration = std::chrono::duration_cast<std::chrono::milliseconds>
@@ -106,6 +109,8 @@ namespace bufr {
         }
       }
 
+      pushDownFilters(querySet);
+
       auto msgsInFile = file_.size(querySet);
 
       // Distribute the messages to the tasks
@@ -145,7 +150,7 @@ namespace bufr {
       }
 
       log::info() << "MPI task: " << comm.rank() << " Exporting Data" << std::endl;
-      auto exportedData = exportData(srcData);
+      auto exportedData = exportData(std::move(srcData));
 
       auto timeElapsed = std::chrono::steady_clock::now() - startTime;
       auto timeElapsedDuration = std::chrono::duration_cast<std::chrono::milliseconds>
@@ -157,18 +162,17 @@ namespace bufr {
       return exportedData;
     }
 
-    std::shared_ptr<DataContainer> BufrParser::exportData(const BufrDataMap &srcData) {
+    std::shared_ptr<DataContainer> BufrParser::exportData(BufrDataMap srcData) {
         auto exportDescription = description_.getExport();
 
         auto filters = exportDescription.getFilters();
         auto splits = exportDescription.getSplits();
         auto vars = exportDescription.getVariables();
 
-        // Filter
-        BufrDataMap dataCopy = srcData;  // make mutable copy
+        // Filter (the sliced fields are views that share the data of the source fields)
         for (const auto &filter : filters)
         {
-            filter->apply(dataCopy);
+            filter->apply(srcData);
         }
 
         // Split
@@ -177,22 +181,43 @@ namespace bufr {
         {
             std::ostringstream catName;
             catName << "splits/" << split->getName();
-            catMap.insert({catName.str(), split->subCategories(dataCopy)});
+            catMap.insert({catName.str(), split->subCategories(srcData)});
         }
 
         BufrParser::CatDataMap splitDataMaps;
-        splitDataMaps.insert({std::vector<std::string>(), dataCopy});
-        for (const auto &split : splits)
+        if (splits.empty())
+        {
+            splitDataMaps.insert({std::vector<std::string>(), std::move(srcData)});
+        }
+        else
         {
-            splitDataMaps = splitData(splitDataMaps, *split);
+            splitDataMaps = splitData(srcData, splits, catMap);
         }
 
         // Export
         auto exportData = std::make_shared<DataContainer>(catMap);
-        for (const auto &dataPair : splitDataMaps)
+
+        // Subcategories without rows all get the same (empty) objects, so they are only
+        // exported once and shared through copy on write copies.
+        std::vector<std::shared_ptr<DataObjectBase>> emptyObjects;
+
+        for (const auto &category : exportData->allSubCategories())
         {
-            for (const auto &var : vars)
+            auto dataIt = splitDataMaps.find(category);
+            if (dataIt == splitDataMaps.end() && emptyObjects.empty())
+            {
+                const std::vector<std::vector<size_t>> noRows(1);
+                const auto emptyData = Split::sliceRows(srcData, noRows).front();
+                for (const auto &var : vars)
+                {
+                    emptyObjects.push_back(var->exportData(emptyData));
+                }
+            }
+
+            for (size_t varIdx = 0; varIdx < vars.size(); ++varIdx)
             {
+                const auto &var = vars[varIdx];
+
                 std::ostringstream pathStr;
                 pathStr << "variables/" << var->getExportName();
 
@@ -200,29 +225,118 @@ namespace bufr {
                 ovar = var->getExportName();
                 log::debug() << "Exporting variable = " << ovar << std::endl;
 
-                exportData->add(pathStr.str(),
-                                var->exportData(dataPair.second),
-                                dataPair.first);
+                if (dataIt != splitDataMaps.end())
+                {
+                    exportData->add(pathStr.str(), var->exportData(dataIt->second), category);
+                }
+                else
+                {
+                    exportData->add(pathStr.str(), emptyObjects[varIdx]->copy(), category);
+                }
             }
         }
 
         return exportData;
     }
 
-    BufrParser::CatDataMap BufrParser::splitData(BufrParser::CatDataMap &splitMaps, Split &split)
+    void BufrParser::pushDownFilters(QuerySet& querySet) const
     {
-        CatDataMap splitDataMap;
+        QueryList queries;
+        for (const auto& var : description_.getExport().getVariables())
+        {
+            for (const auto& queryInfo : var->getQueryList())
+            {
+                if (!queryInfo.groupByField.empty()) return;
+                queries.push_back(queryInfo);
+            }
+        }
+
+        for (const auto& filter : description_.getExport().getFilters())
+        {
+            filter->pushDown(querySet, queries);
+        }
+    }
+
+    BufrParser::CatDataMap BufrParser::splitData(const BufrDataMap& srcData,
+                                                 const Export::Splits& splits,
+                                                 const CategoryMap& catMap)
+    {
+        // Combine the category of every split into one mixed radix key per row (the splits are
+        // taken in the order of the category map, which is the order of the subcategory keys).
+        std::vector<std::vector<std::string>> catNames;
+        std::vector<size_t> rowKeys;
+        for (const auto &catPair : catMap)
+        {
+            std::shared_ptr<Split> split;
+            for (const auto &candidate : splits)
+            {
+                if ("splits/" + candidate->getName() == catPair.first)
+                {
+                    split = candidate;
+                    break;
+                }
+            }
+
+            const auto rowCats = split->rowCategories(srcData);
+            const size_t numCats = catPair.second.size();
+            if (catNames.empty())
+            {
+                rowKeys = rowCats;
+            }
+            else
+            {
+                for (size_t rowIdx = 0; rowIdx < rowKeys.size(); ++rowIdx)
+                {
+                    if (rowKeys[rowIdx] == Split::NoCategory) continue;
+
+                    if (rowCats[rowIdx] == Split::NoCategory)
+                    {
+                        rowKeys[rowIdx] = Split::NoCategory;
+                    }
+                    else
+                    {
+                        rowKeys[rowIdx] = rowKeys[rowIdx] * numCats + rowCats[rowIdx];
+                    }
+                }
+            }
 
-        for (const auto &splitMapPair : splitMaps)
+            catNames.push_back(catPair.second);
+        }
+
+        // Group the rows by key (only keys that have rows get a set)
+        std::unordered_map<size_t, size_t> setIdxs;
+        std::vector<size_t> setKeys;
+        std::vector<std::vector<size_t>> rowSets;
+        for (size_t rowIdx = 0; rowIdx < rowKeys.size(); ++rowIdx)
         {
-            auto newData = split.split(splitMapPair.second);
+            if (rowKeys[rowIdx] == Split::NoCategory) continue;
 
-            for (const auto &newDataPair : newData)
+            auto setIt = setIdxs.find(rowKeys[rowIdx]);
+            if (setIt == setIdxs.end())
             {
-                auto catVect = splitMapPair.first;
-                catVect.push_back(newDataPair.first);
-                splitDataMap.insert({catVect, newDataPair.second});
+                setIt = setIdxs.insert({rowKeys[rowIdx], rowSets.size()}).first;
+                setKeys.push_back(rowKeys[rowIdx]);
+                rowSets.emplace_back();
             }
+
+            rowSets[setIt->second].push_back(rowIdx);
+        }
+
+        // Slice every field once into all the sets
+        auto slices = Split::sliceRows(srcData, rowSets);
+
+        CatDataMap splitDataMap;
+        for (size_t setIdx = 0; setIdx < setKeys.size(); ++setIdx)
+        {
+            std::vector<std::string> catVect(catNames.size());
+            size_t key = setKeys[setIdx];
+            for (size_t catIdx = catNames.size(); catIdx-- > 0;)
+            {
+                catVect[catIdx] = catNames[catIdx][key % catNames[catIdx].size()];
+                key /= catNames[catIdx].size();
+            }
+
+            splitDataMap.insert({catVect, std::move(slices[setIdx])});
         }
 
         return splitDataMap;
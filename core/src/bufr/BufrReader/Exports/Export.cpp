@@ -8,7 +8,9 @@
 #include "eckit/exception/Exceptions.h"
 
 #include "Filters/BoundingFilter.h"
+#include "Filters/ExpressionFilter.h"
 #include "Splits/CategorySplit.h"
+#include "Splits/GridSplit.h"
 #include "Variables/QueryVariable.h"
 #include "Variables/DatetimeVariable.h"
 #include "Variables/WigosidVariable.h"
@@ -47,11 +49,13 @@ namespace
         namespace Split
         {
             const char* Category = "category";
+            const char* Grid = "grid";
         }  // namespace Split
 
         namespace Filter
         {
             const char* Bounding = "bounding";
+            const char* Expression = "expression";
         }
     }  // namespace ConfKeys
 }  // namespace
@@ -172,6 +176,7 @@ namespace bufr {
 
         SplitFactory splitFactory;
         splitFactory.registerObject<CategorySplit>(ConfKeys::Split::Category);
+        splitFactory.registerObject<GridSplit>(ConfKeys::Split::Grid);
 
         if (conf.keys().size() == 0)
         {
@@ -198,6 +203,7 @@ namespace bufr {
 
         FilterFactory filterFactory;
         filterFactory.registerObject<BoundingFilter>(ConfKeys::Filter::Bounding);
+        filterFactory.registerObject<ExpressionFilter>(ConfKeys::Filter::Expression);
 
         auto subConfs = conf.getSubConfigurations();
         if (subConfs.size() == 0)
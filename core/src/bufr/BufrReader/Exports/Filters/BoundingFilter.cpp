@@ -2,9 +2,11 @@
 
 #include "BoundingFilter.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <ostream>
 
-#include "Eigen/Dense"
 #include "eckit/exception/Exceptions.h"
 
 namespace
@@ -19,8 +21,6 @@ namespace
 
 
 namespace bufr {
-    typedef Eigen::Array<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> EigArray;
-
     BoundingFilter::BoundingFilter(const eckit::LocalConfiguration& conf) :
       Filter(conf),
       variable_(conf.getString(ConfKeys::Variable))
@@ -50,9 +50,25 @@ namespace bufr {
         }
     }
 
+    void BoundingFilter::pushDown(QuerySet& querySet, const QueryList& queries) const
+    {
+        // Unknown variables are reported by apply
+        const auto queryIt = std::find_if(queries.begin(), queries.end(),
+                                          [this](const QueryInfo& info)
+                                          {
+                                              return info.name == variable_;
+                                          });
+        if (queryIt == queries.end()) return;
+
+        // Like apply, a missing bound accepts everything (even the fill values).
+        querySet.addBounds(variable_,
+                           lowerBound_ ? *lowerBound_ : -std::numeric_limits<float>::infinity(),
+                           upperBound_ ? *upperBound_ : std::numeric_limits<float>::infinity(),
+                           queryIt->type);
+    }
+
     void BoundingFilter::apply(BufrDataMap& dataMap)
     {
-        std::vector<size_t> validRows;
         if (dataMap.find(variable_) == dataMap.end())
         {
             std::ostringstream errStr;
@@ -60,53 +76,76 @@ namespace bufr {
             throw eckit::BadParameter(errStr.str());
         }
 
-        if (const auto& var = std::dynamic_pointer_cast<DataObject<float>>(dataMap.at(variable_)))
+        const auto& object = dataMap.at(variable_);
+        std::vector<size_t> validRows;
+        if (!(findValidRows<float>(object, validRows) ||
+              findValidRows<double>(object, validRows) ||
+              findValidRows<int>(object, validRows) ||
+              findValidRows<int64_t>(object, validRows) ||
+              findValidRows<uint32_t>(object, validRows) ||
+              findValidRows<uint64_t>(object, validRows)))
         {
-            auto dims = var->getDims();
-            size_t extraDims = 1;
+            std::stringstream errStr;
+            errStr << "BoundingFilter variable must be a array of numbers (found list of strings).";
+            throw eckit::BadParameter(errStr.str());
+        }
 
-            for (size_t dimIdx = 1; dimIdx < dims.size(); ++dimIdx)
+        // Only slice when something was rejected
+        const auto& dims = object->getDims();
+        if (validRows.size() != static_cast<size_t>(dims.empty() ? 0 : dims[0]))
+        {
+            for (auto& dataPair : dataMap)
             {
-                extraDims *= dims[dimIdx];
+                dataPair.second = dataPair.second->slice(validRows);
             }
+        }
+    }
 
-            // Make local copy otherwise you get weird memory corruption issue.
-            auto rawData = var->getRawData();
-            auto array = Eigen::Map<EigArray> (rawData.data(), dims[0], extraDims);
+    template<typename T>
+    bool BoundingFilter::findValidRows(const std::shared_ptr<DataObjectBase>& object,
+                                       std::vector<size_t>& validRows) const
+    {
+        auto typed = std::dynamic_pointer_cast<DataObject<T>>(object);
+        if (!typed) return false;
 
-            for (auto rowIdx = 0; rowIdx < dims[0]; rowIdx++)
+        const auto& dims = typed->getDims();
+        const size_t numRows = dims.empty() ? 0 : dims[0];
+        size_t rowLength = 1;
+        for (size_t dimIdx = 1; dimIdx < dims.size(); ++dimIdx)
+        {
+            rowLength *= dims[dimIdx];
+        }
+
+        // A missing bound accepts everything (NaN is still rejected, like any comparison).
+        const double lowerBound = lowerBound_ ? *lowerBound_
+                                              : -std::numeric_limits<double>::infinity();
+        const double upperBound = upperBound_ ? *upperBound_
+                                              : std::numeric_limits<double>::infinity();
+
+        // Walk the values in place (in row major order) and move on to the next row as soon as
+        // a value is out of bounds. The view stays valid until the data map is sliced.
+        typed->materialize();
+        const T* values = typed->getDataView().data();
+
+        validRows.reserve(numRows);
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        {
+            const T* row = values + rowIdx * rowLength;
+
+            size_t valueIdx = 0;
+            while (valueIdx < rowLength &&
+                   static_cast<double>(row[valueIdx]) >= lowerBound &&
+                   static_cast<double>(row[valueIdx]) <= upperBound)
             {
-                if (lowerBound_ && upperBound_)
-                {
-                    if ((array.row(rowIdx) >= *lowerBound_).all() &&
-                        (array.row(rowIdx) <= *upperBound_).all())
-                    {
-                        validRows.push_back(rowIdx);
-                    }
-                }
-                else
-                {
-                    if ((lowerBound_ && (array.row(rowIdx) >= *lowerBound_).all()) ||
-                        (upperBound_ && (array.row(rowIdx) <= *upperBound_).all()))
-                    {
-                        validRows.push_back(rowIdx);
-                    }
-                }
+                ++valueIdx;
             }
 
-            if (validRows.size() != static_cast<size_t>(dims[0]))
+            if (valueIdx == rowLength)
             {
-                for (const auto& dataPair : dataMap)
-                {
-                    dataMap[dataPair.first] = dataPair.second->slice(validRows);
-                }
+                validRows.push_back(rowIdx);
             }
         }
-        else
-        {
-            std::stringstream errStr;
-            errStr << "BoundingFilter variable must be a array of numbers (found list of strings).";
-            throw eckit::BadParameter(errStr.str());
-        }
+
+        return true;
     }
 }  // namespace bufr
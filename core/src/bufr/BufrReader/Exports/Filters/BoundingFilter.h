@@ -19,13 +19,26 @@ namespace bufr {
 
         virtual ~BoundingFilter() = default;
 
-        /// \brief Apply the filter to the dataevant data.
+        /// \brief Apply the filter to the data.
+        /// \param dataMap Map to modify by filtering out the rows that are out of bounds.
         void apply(BufrDataMap& dataMap) final;
 
-        /// \param dataMap Map to modify by filtering out rel
+        /// \brief Add the bounds of the variable to the query set.
+        /// \param querySet The query set that is executed to collect the data.
+        /// \param queries The queries of the export (with the types they are read as).
+        void pushDown(QuerySet& querySet, const QueryList& queries) const final;
+
      private:
          const std::string variable_;
          std::shared_ptr<float> lowerBound_;
          std::shared_ptr<float> upperBound_;
+
+         /// \brief Find the rows where all the values are within the bounds.
+         /// \param object The data of the variable.
+         /// \param validRows Output list of the rows to keep.
+         /// \return False if the object does not hold values of type T.
+         template<typename T>
+         bool findValidRows(const std::shared_ptr<DataObjectBase>& object,
+                            std::vector<size_t>& validRows) const;
     };
 }  // namespace bufr
@@ -0,0 +1,894 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+#include "ExpressionFilter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "eckit/exception/Exceptions.h"
+
+#include "bufr/DataObject.h"
+#include "bufr/PackedStrings.h"
+
+namespace
+{
+    namespace ConfKeys
+    {
+        const char* Condition = "condition";
+    }  // namespace ConfKeys
+
+    // Rows are evaluated in blocks of this many so the intermediate masks stay in cache.
+    constexpr size_t BlockRows = 1024;
+
+    // Filters over fewer rows than this are not worth starting threads for.
+    constexpr size_t ParallelRows = 1 << 16;
+}  // namespace
+
+namespace bufr {
+namespace expression
+{
+    enum class CompareOp
+    {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual
+    };
+
+    /// \brief A number or string constant in the expression.
+    struct Literal
+    {
+        bool isString = false;
+        std::string str;
+
+        double number = 0;
+        bool isInteger = false;
+        int64_t integer = 0;
+    };
+
+    /// \brief Node of the compiled expression.
+    class Node
+    {
+     public:
+        virtual ~Node() = default;
+
+        /// \brief Evaluate the expression for a block of rows.
+        /// \param dataMap The data (the fields the expression uses must be materialized).
+        /// \param beginRow The first row of the block.
+        /// \param numRows The number of rows in the block.
+        /// \param mask Output with one byte per row (1 where the expression is true).
+        virtual void eval(const BufrDataMap& dataMap,
+                          size_t beginRow,
+                          size_t numRows,
+                          uint8_t* mask) const = 0;
+    };
+
+    /// \brief Call func with the values of a variable (pointer to the typed values or the
+    ///        PackedStrings) and the number of values in a row.
+    template<typename Func>
+    void visitVariable(const BufrDataMap& dataMap, const std::string& variable, Func&& func)
+    {
+        const auto& object = dataMap.at(variable);
+
+        const auto& dims = object->getDims();
+        size_t rowLength = 1;
+        for (size_t dimIdx = 1; dimIdx < dims.size(); ++dimIdx)
+        {
+            rowLength *= dims[dimIdx];
+        }
+
+        if (auto typed = std::dynamic_pointer_cast<DataObject<int>>(object))
+        {
+            func(typed->getDataView().data(), rowLength);
+        }
+        else if (auto typed = std::dynamic_pointer_cast<DataObject<float>>(object))
+        {
+            func(typed->getDataView().data(), rowLength);
+        }
+        else if (auto typed = std::dynamic_pointer_cast<DataObject<double>>(object))
+        {
+            func(typed->getDataView().data(), rowLength);
+        }
+        else if (auto typed = std::dynamic_pointer_cast<DataObject<int64_t>>(object))
+        {
+            func(typed->getDataView().data(), rowLength);
+        }
+        else if (auto typed = std::dynamic_pointer_cast<DataObject<uint32_t>>(object))
+        {
+            func(typed->getDataView().data(), rowLength);
+        }
+        else if (auto typed = std::dynamic_pointer_cast<DataObject<uint64_t>>(object))
+        {
+            func(typed->getDataView().data(), rowLength);
+        }
+        else if (auto typed = std::dynamic_pointer_cast<DataObject<std::string>>(object))
+        {
+            func(typed->getDataView(), rowLength);
+        }
+        else
+        {
+            std::ostringstream errStr;
+            errStr << "ExpressionFilter: Unsupported data type for variable " << variable << ".";
+            throw eckit::BadParameter(errStr.str());
+        }
+    }
+
+    template<typename Values>
+    using IsStrings = std::is_same<std::decay_t<Values>, PackedStrings>;
+
+    /// \brief Local copy of the values (the pointer for numeric values) so the compiler can see
+    ///        that the mask stores don't change it, which lets it vectorize the loops.
+    template<typename Values>
+    using LocalValues = std::conditional_t<std::is_pointer<Values>::value, Values, const Values&>;
+
+    /// \brief Evaluate a condition for a block of rows. fill(beginValue, numValues, out) writes
+    ///        one byte per value, the rows are true where all their values are.
+    template<typename Fill>
+    void evalRows(size_t beginRow, size_t numRows, size_t rowLength, uint8_t* mask, Fill&& fill)
+    {
+        if (rowLength == 1)
+        {
+            fill(beginRow, numRows, mask);
+            return;
+        }
+
+        std::vector<uint8_t> valueMask(numRows * rowLength);
+        fill(beginRow * rowLength, valueMask.size(), valueMask.data());
+
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        {
+            uint8_t all = 1;
+            for (size_t valueIdx = 0; valueIdx < rowLength; ++valueIdx)
+            {
+                all &= valueMask[rowIdx * rowLength + valueIdx];
+            }
+
+            mask[rowIdx] = all;
+        }
+    }
+
+    /// \brief Compare a range of values with a constant. The loops are branch free so the
+    ///        compiler vectorizes them for the numeric types.
+    template<typename C, typename Values, typename IsValid>
+    void compareValues(const Values& values,
+                       size_t begin,
+                       size_t count,
+                       CompareOp op,
+                       const C literal,
+                       IsValid&& isValid,
+                       uint8_t* out)
+    {
+        const LocalValues<Values> data = values;
+        switch (op)
+        {
+            case CompareOp::Equal:
+                for (size_t idx = 0; idx < count; ++idx)
+                {
+                    const auto value = data[begin + idx];
+                    out[idx] = isValid(value) & (static_cast<C>(value) == literal);
+                }
+                break;
+            case CompareOp::NotEqual:
+                for (size_t idx = 0; idx < count; ++idx)
+                {
+                    const auto value = data[begin + idx];
+                    out[idx] = isValid(value) & (static_cast<C>(value) != literal);
+                }
+                break;
+            case CompareOp::Less:
+                for (size_t idx = 0; idx < count; ++idx)
+                {
+                    const auto value = data[begin + idx];
+                    out[idx] = isValid(value) & (static_cast<C>(value) < literal);
+                }
+                break;
+            case CompareOp::LessEqual:
+                for (size_t idx = 0; idx < count; ++idx)
+                {
+                    const auto value = data[begin + idx];
+                    out[idx] = isValid(value) & (static_cast<C>(value) <= literal);
+                }
+                break;
+            case CompareOp::Greater:
+                for (size_t idx = 0; idx < count; ++idx)
+                {
+                    const auto value = data[begin + idx];
+                    out[idx] = isValid(value) & (static_cast<C>(value) > literal);
+                }
+                break;
+            case CompareOp::GreaterEqual:
+                for (size_t idx = 0; idx < count; ++idx)
+                {
+                    const auto value = data[begin + idx];
+                    out[idx] = isValid(value) & (static_cast<C>(value) >= literal);
+                }
+                break;
+        }
+    }
+
+    /// \brief Check if a range of values is in a set of constants.
+    template<typename C, typename Values, typename IsValid>
+    void valuesInSet(const Values& values,
+                     size_t begin,
+                     size_t count,
+                     const std::vector<C>& literals,
+                     IsValid&& isValid,
+                     uint8_t* out)
+    {
+        const LocalValues<Values> data = values;
+        std::fill(out, out + count, 0);
+        for (const auto& literal : literals)
+        {
+            for (size_t idx = 0; idx < count; ++idx)
+            {
+                out[idx] |= (static_cast<C>(data[begin + idx]) == literal);
+            }
+        }
+
+        for (size_t idx = 0; idx < count; ++idx)
+        {
+            out[idx] &= isValid(data[begin + idx]);
+        }
+    }
+
+    /// \brief Throw if the type of the variable doesn't match the type of the literal.
+    void checkLiteralType(const std::string& variable, bool isStringVariable, bool isString)
+    {
+        if (isStringVariable != isString)
+        {
+            std::ostringstream errStr;
+            errStr << "ExpressionFilter: Can not compare " << variable << " with a ";
+            errStr << (isString ? "string." : "number.");
+            throw eckit::BadParameter(errStr.str());
+        }
+    }
+
+    /// \brief variable <op> literal
+    class Compare : public Node
+    {
+     public:
+        Compare(const std::string& variable, CompareOp op, const Literal& literal) :
+          variable_(variable),
+          op_(op),
+          literal_(literal)
+        {
+        }
+
+        void eval(const BufrDataMap& dataMap,
+                  size_t beginRow,
+                  size_t numRows,
+                  uint8_t* mask) const final
+        {
+            visitVariable(dataMap, variable_, [&](const auto& values, size_t rowLength)
+            {
+                typedef std::decay_t<decltype(values)> Values;
+                checkLiteralType(variable_, IsStrings<Values>::value, literal_.isString);
+
+                evalRows(beginRow, numRows, rowLength, mask,
+                         [&](size_t begin, size_t count, uint8_t* out)
+                {
+                    if constexpr (IsStrings<Values>::value)
+                    {
+                        compareValues(values, begin, count, op_, std::string_view(literal_.str),
+                                      [](std::string_view value) { return !value.empty(); },
+                                      out);
+                    }
+                    else
+                    {
+                        typedef std::remove_const_t<std::remove_pointer_t<Values>> T;
+                        const T missing = DataObject<T>::missingValue();
+                        auto isValid = [missing](T value) { return value != missing; };
+
+                        if (std::is_integral<T>::value && literal_.isInteger)
+                        {
+                            compareValues(values, begin, count, op_, literal_.integer, isValid,
+                                          out);
+                        }
+                        else
+                        {
+                            compareValues(values, begin, count, op_, literal_.number, isValid,
+                                          out);
+                        }
+                    }
+                });
+            });
+        }
+
+     private:
+        const std::string variable_;
+        const CompareOp op_;
+        const Literal literal_;
+    };
+
+    /// \brief variable in [literal, ...]
+    class InSet : public Node
+    {
+     public:
+        InSet(const std::string& variable, const std::vector<Literal>& literals) :
+          variable_(variable),
+          isString_(literals.front().isString),
+          allIntegers_(true)
+        {
+            for (const auto& literal : literals)
+            {
+                if (literal.isString != isString_)
+                {
+                    std::ostringstream errStr;
+                    errStr << "ExpressionFilter: The set for " << variable;
+                    errStr << " mixes strings and numbers.";
+                    throw eckit::BadParameter(errStr.str());
+                }
+
+                strings_.push_back(literal.str);
+                numbers_.push_back(literal.number);
+                integers_.push_back(literal.integer);
+                allIntegers_ = allIntegers_ && literal.isInteger;
+            }
+
+            stringViews_.assign(strings_.begin(), strings_.end());
+        }
+
+        void eval(const BufrDataMap& dataMap,
+                  size_t beginRow,
+                  size_t numRows,
+                  uint8_t* mask) const final
+        {
+            visitVariable(dataMap, variable_, [&](const auto& values, size_t rowLength)
+            {
+                typedef std::decay_t<decltype(values)> Values;
+                checkLiteralType(variable_, IsStrings<Values>::value, isString_);
+
+                evalRows(beginRow, numRows, rowLength, mask,
+                         [&](size_t begin, size_t count, uint8_t* out)
+                {
+                    if constexpr (IsStrings<Values>::value)
+                    {
+                        valuesInSet(values, begin, count, stringViews_,
+                                    [](std::string_view value) { return !value.empty(); }, out);
+                    }
+                    else
+                    {
+                        typedef std::remove_const_t<std::remove_pointer_t<Values>> T;
+                        const T missing = DataObject<T>::missingValue();
+                        auto isValid = [missing](T value) { return value != missing; };
+
+                        if (std::is_integral<T>::value && allIntegers_)
+                        {
+                            valuesInSet(values, begin, count, integers_, isValid, out);
+                        }
+                        else
+                        {
+                            valuesInSet(values, begin, count, numbers_, isValid, out);
+                        }
+                    }
+                });
+            });
+        }
+
+     private:
+        const std::string variable_;
+        const bool isString_;
+        bool allIntegers_;
+        std::vector<std::string> strings_;
+        std::vector<std::string_view> stringViews_;
+        std::vector<double> numbers_;
+        std::vector<int64_t> integers_;
+    };
+
+    /// \brief isMissing(variable)
+    class IsMissing : public Node
+    {
+     public:
+        explicit IsMissing(const std::string& variable) : variable_(variable) {}
+
+        void eval(const BufrDataMap& dataMap,
+                  size_t beginRow,
+                  size_t numRows,
+                  uint8_t* mask) const final
+        {
+            visitVariable(dataMap, variable_, [&](const auto& values, size_t rowLength)
+            {
+                typedef std::decay_t<decltype(values)> Values;
+
+                evalRows(beginRow, numRows, rowLength, mask,
+                         [&](size_t begin, size_t count, uint8_t* out)
+                {
+                    if constexpr (IsStrings<Values>::value)
+                    {
+                        for (size_t idx = 0; idx < count; ++idx)
+                        {
+                            out[idx] = values[begin + idx].empty();
+                        }
+                    }
+                    else
+                    {
+                        typedef std::remove_const_t<std::remove_pointer_t<Values>> T;
+                        const LocalValues<Values> data = values;
+                        const T missing = DataObject<T>::missingValue();
+                        for (size_t idx = 0; idx < count; ++idx)
+                        {
+                            out[idx] = (data[begin + idx] == missing);
+                        }
+                    }
+                });
+            });
+        }
+
+     private:
+        const std::string variable_;
+    };
+
+    /// \brief not expression
+    class Not : public Node
+    {
+     public:
+        explicit Not(const std::shared_ptr<const Node>& child) : child_(child) {}
+
+        void eval(const BufrDataMap& dataMap,
+                  size_t beginRow,
+                  size_t numRows,
+                  uint8_t* mask) const final
+        {
+            child_->eval(dataMap, beginRow, numRows, mask);
+            for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            {
+                mask[rowIdx] ^= 1;
+            }
+        }
+
+     private:
+        const std::shared_ptr<const Node> child_;
+    };
+
+    /// \brief expression and expression and ... (or expression or expression ...)
+    class Logical : public Node
+    {
+     public:
+        Logical(bool isAnd, const std::vector<std::shared_ptr<const Node>>& children) :
+          isAnd_(isAnd),
+          children_(children)
+        {
+        }
+
+        void eval(const BufrDataMap& dataMap,
+                  size_t beginRow,
+                  size_t numRows,
+                  uint8_t* mask) const final
+        {
+            children_.front()->eval(dataMap, beginRow, numRows, mask);
+
+            // Skip the rest of the children once the result of the block is settled
+            const uint8_t settled = isAnd_ ? 0 : 1;
+            std::vector<uint8_t> childMask(numRows);
+            for (size_t childIdx = 1; childIdx < children_.size(); ++childIdx)
+            {
+                if (numRows > 0 &&
+                    std::all_of(mask, mask + numRows,
+                                [settled](uint8_t value) { return value == settled; }))
+                {
+                    break;
+                }
+
+                children_[childIdx]->eval(dataMap, beginRow, numRows, childMask.data());
+
+                if (isAnd_)
+                {
+                    for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+                    {
+                        mask[rowIdx] &= childMask[rowIdx];
+                    }
+                }
+                else
+                {
+                    for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+                    {
+                        mask[rowIdx] |= childMask[rowIdx];
+                    }
+                }
+            }
+        }
+
+     private:
+        const bool isAnd_;
+        const std::vector<std::shared_ptr<const Node>> children_;
+    };
+
+    /// \brief Token of the expression string.
+    struct Token
+    {
+        enum class Type
+        {
+            Name,
+            Number,
+            String,
+            Operator,
+            Punctuation,
+            End
+        };
+
+        Type type;
+        std::string text;
+        size_t pos;
+    };
+
+    /// \brief Recursive descent parser that compiles an expression string into Nodes.
+    ///
+    ///   or      := and ('or' and)*
+    ///   and     := not ('and' not)*
+    ///   not     := 'not' not | primary
+    ///   primary := '(' or ')' | 'isMissing' '(' name ')' | name 'in' '[' literals ']'
+    ///            | name op literal | literal op name
+    class Parser
+    {
+     public:
+        explicit Parser(const std::string& str) :
+          str_(str)
+        {
+            tokenize();
+        }
+
+        /// \brief Compile the expression.
+        std::shared_ptr<const Node> parse()
+        {
+            auto node = parseOr();
+            if (peek().type != Token::Type::End)
+            {
+                fail("Unexpected \"" + peek().text + "\"");
+            }
+
+            return node;
+        }
+
+        /// \brief Get the names of the variables used in the expression.
+        std::vector<std::string> variables() const
+        {
+            return std::vector<std::string>(variables_.begin(), variables_.end());
+        }
+
+     private:
+        const std::string str_;
+        std::vector<Token> tokens_;
+        size_t tokenIdx_ = 0;
+        std::set<std::string> variables_;
+
+        [[noreturn]] void fail(const std::string& msg, size_t pos) const
+        {
+            std::ostringstream errStr;
+            errStr << "ExpressionFilter: " << msg << " at position " << pos;
+            errStr << " of expression \"" << str_ << "\".";
+            throw eckit::BadParameter(errStr.str());
+        }
+
+        [[noreturn]] void fail(const std::string& msg) const { fail(msg, peek().pos); }
+
+        static bool isNameChar(char c)
+        {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.' || c == '/';
+        }
+
+        void tokenize()
+        {
+            size_t pos = 0;
+            while (pos < str_.size())
+            {
+                const char c = str_[pos];
+                const char next = (pos + 1 < str_.size()) ? str_[pos + 1] : '\0';
+
+                if (std::isspace(static_cast<unsigned char>(c)))
+                {
+                    ++pos;
+                }
+                else if (std::isdigit(static_cast<unsigned char>(c)) ||
+                         ((c == '-' || c == '+' || c == '.') &&
+                          (std::isdigit(static_cast<unsigned char>(next)) || next == '.')))
+                {
+                    char* end = nullptr;
+                    std::strtod(str_.c_str() + pos, &end);
+                    const size_t length = end - (str_.c_str() + pos);
+                    if (length == 0) fail("Invalid number", pos);
+
+                    tokens_.push_back({Token::Type::Number, str_.substr(pos, length), pos});
+                    pos += length;
+                }
+                else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+                {
+                    size_t end = pos;
+                    while (end < str_.size() && isNameChar(str_[end])) ++end;
+
+                    tokens_.push_back({Token::Type::Name, str_.substr(pos, end - pos), pos});
+                    pos = end;
+                }
+                else if (c == '\'' || c == '"')
+                {
+                    const size_t end = str_.find(c, pos + 1);
+                    if (end == std::string::npos) fail("Unterminated string", pos);
+
+                    tokens_.push_back({Token::Type::String,
+                                       str_.substr(pos + 1, end - pos - 1),
+                                       pos});
+                    pos = end + 1;
+                }
+                else if ((c == '=' || c == '!' || c == '<' || c == '>') && next == '=')
+                {
+                    tokens_.push_back({Token::Type::Operator, str_.substr(pos, 2), pos});
+                    pos += 2;
+                }
+                else if (c == '<' || c == '>')
+                {
+                    tokens_.push_back({Token::Type::Operator, std::string(1, c), pos});
+                    ++pos;
+                }
+                else if (c == '(' || c == ')' || c == '[' || c == ']' || c == ',')
+                {
+                    tokens_.push_back({Token::Type::Punctuation, std::string(1, c), pos});
+                    ++pos;
+                }
+                else
+                {
+                    fail(std::string("Unexpected character '") + c + "'", pos);
+                }
+            }
+
+            tokens_.push_back({Token::Type::End, "end of expression", str_.size()});
+        }
+
+        const Token& peek() const { return tokens_[tokenIdx_]; }
+
+        const Token& next() { return tokens_[tokenIdx_++]; }
+
+        bool isKeyword(const std::string& keyword) const
+        {
+            return peek().type == Token::Type::Name && peek().text == keyword;
+        }
+
+        bool isPunctuation(const std::string& punctuation) const
+        {
+            return peek().type == Token::Type::Punctuation && peek().text == punctuation;
+        }
+
+        void expect(const std::string& punctuation)
+        {
+            if (!isPunctuation(punctuation))
+            {
+                fail("Expected \"" + punctuation + "\" but found \"" + peek().text + "\"");
+            }
+
+            next();
+        }
+
+        std::shared_ptr<const Node> parseOr()
+        {
+            std::vector<std::shared_ptr<const Node>> children = {parseAnd()};
+            while (isKeyword("or"))
+            {
+                next();
+                children.push_back(parseAnd());
+            }
+
+            if (children.size() == 1) return children.front();
+            return std::make_shared<Logical>(false, children);
+        }
+
+        std::shared_ptr<const Node> parseAnd()
+        {
+            std::vector<std::shared_ptr<const Node>> children = {parseNot()};
+            while (isKeyword("and"))
+            {
+                next();
+                children.push_back(parseNot());
+            }
+
+            if (children.size() == 1) return children.front();
+            return std::make_shared<Logical>(true, children);
+        }
+
+        std::shared_ptr<const Node> parseNot()
+        {
+            if (isKeyword("not"))
+            {
+                next();
+                return std::make_shared<Not>(parseNot());
+            }
+
+            return parsePrimary();
+        }
+
+        std::shared_ptr<const Node> parsePrimary()
+        {
+            if (isPunctuation("("))
+            {
+                next();
+                auto node = parseOr();
+                expect(")");
+                return node;
+            }
+
+            if (isKeyword("isMissing"))
+            {
+                next();
+                expect("(");
+                const auto variable = parseVariable();
+                expect(")");
+                return std::make_shared<IsMissing>(variable);
+            }
+
+            if (peek().type == Token::Type::Number || peek().type == Token::Type::String)
+            {
+                // literal op name (flip it around)
+                const auto literal = parseLiteral();
+                const auto op = parseOperator();
+                const auto variable = parseVariable();
+                return std::make_shared<Compare>(variable, flip(op), literal);
+            }
+
+            const auto variable = parseVariable();
+            if (isKeyword("in"))
+            {
+                next();
+                expect("[");
+                std::vector<Literal> literals = {parseLiteral()};
+                while (isPunctuation(","))
+                {
+                    next();
+                    literals.push_back(parseLiteral());
+                }
+                expect("]");
+
+                return std::make_shared<InSet>(variable, literals);
+            }
+
+            const auto op = parseOperator();
+            return std::make_shared<Compare>(variable, op, parseLiteral());
+        }
+
+        std::string parseVariable()
+        {
+            if (peek().type != Token::Type::Name || isKeyword("and") || isKeyword("or") ||
+                isKeyword("not") || isKeyword("in") || isKeyword("isMissing"))
+            {
+                fail("Expected a variable name but found \"" + peek().text + "\"");
+            }
+
+            variables_.insert(peek().text);
+            return next().text;
+        }
+
+        Literal parseLiteral()
+        {
+            Literal literal;
+            if (peek().type == Token::Type::String)
+            {
+                literal.isString = true;
+                literal.str = next().text;
+            }
+            else if (peek().type == Token::Type::Number)
+            {
+                const auto& text = next().text;
+                literal.number = std::strtod(text.c_str(), nullptr);
+                if (text.find_first_of(".eE") == std::string::npos)
+                {
+                    char* end = nullptr;
+                    errno = 0;
+                    literal.integer = std::strtoll(text.c_str(), &end, 10);
+                    literal.isInteger = (errno == 0 && *end == '\0');
+                }
+            }
+            else
+            {
+                fail("Expected a number or string but found \"" + peek().text + "\"");
+            }
+
+            return literal;
+        }
+
+        CompareOp parseOperator()
+        {
+            if (peek().type != Token::Type::Operator)
+            {
+                fail("Expected a comparison but found \"" + peek().text + "\"");
+            }
+
+            const auto& text = next().text;
+            if (text == "==") return CompareOp::Equal;
+            if (text == "!=") return CompareOp::NotEqual;
+            if (text == "<") return CompareOp::Less;
+            if (text == "<=") return CompareOp::LessEqual;
+            if (text == ">") return CompareOp::Greater;
+            return CompareOp::GreaterEqual;
+        }
+
+        static CompareOp flip(CompareOp op)
+        {
+            switch (op)
+            {
+                case CompareOp::Less: return CompareOp::Greater;
+                case CompareOp::LessEqual: return CompareOp::GreaterEqual;
+                case CompareOp::Greater: return CompareOp::Less;
+                case CompareOp::GreaterEqual: return CompareOp::LessEqual;
+                default: return op;
+            }
+        }
+    };
+}  // namespace expression
+
+    ExpressionFilter::ExpressionFilter(const eckit::LocalConfiguration& conf) :
+      Filter(conf),
+      expressionStr_(conf.getString(ConfKeys::Condition))
+    {
+        expression::Parser parser(expressionStr_);
+        expression_ = parser.parse();
+        variables_ = parser.variables();
+    }
+
+    void ExpressionFilter::apply(BufrDataMap& dataMap)
+    {
+        size_t numRows = 0;
+        for (size_t varIdx = 0; varIdx < variables_.size(); ++varIdx)
+        {
+            const auto& variable = variables_[varIdx];
+            if (dataMap.find(variable) == dataMap.end())
+            {
+                std::ostringstream errStr;
+                errStr << "Unknown variable " << variable << " found in expression filter.";
+                throw eckit::BadParameter(errStr.str());
+            }
+
+            // The expression reads the values in place
+            auto& object = dataMap.at(variable);
+            object->materialize();
+
+            const auto& dims = object->getDims();
+            const size_t rows = dims.empty() ? 0 : dims[0];
+            if (varIdx > 0 && rows != numRows)
+            {
+                std::ostringstream errStr;
+                errStr << "ExpressionFilter: The variables in \"" << expressionStr_;
+                errStr << "\" don't have the same number of rows.";
+                throw eckit::BadParameter(errStr.str());
+            }
+
+            numRows = rows;
+        }
+
+        // Evaluate the blocks of rows into one mask. Type errors are found by evaluating zero
+        // rows first, since exceptions can't leave the parallel loop.
+        std::vector<uint8_t> rowMask(numRows);
+        expression_->eval(dataMap, 0, 0, rowMask.data());
+
+        const auto numBlocks = static_cast<long>((numRows + BlockRows - 1) / BlockRows);
+
+        #pragma omp parallel for schedule(static) if (numRows >= ParallelRows)
+        for (long blockIdx = 0; blockIdx < numBlocks; ++blockIdx)
+        {
+            const size_t beginRow = blockIdx * BlockRows;
+            const size_t blockRows = std::min(BlockRows, numRows - beginRow);
+            expression_->eval(dataMap, beginRow, blockRows, rowMask.data() + beginRow);
+        }
+
+        std::vector<size_t> validRows;
+        validRows.reserve(numRows);
+        for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        {
+            if (rowMask[rowIdx]) validRows.push_back(rowIdx);
+        }
+
+        // Slice every field once
+        if (validRows.size() != numRows)
+        {
+            for (auto& dataPair : dataMap)
+            {
+                dataPair.second = dataPair.second->slice(validRows);
+            }
+        }
+    }
+}  // namespace bufr
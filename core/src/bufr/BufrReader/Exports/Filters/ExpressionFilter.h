@@ -0,0 +1,48 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+#pragma once
+
+#include "bufr/Filter.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bufr {
+    namespace expression
+    {
+        class Node;
+    }  // namespace expression
+
+    /// \brief Filter that keeps the rows where a boolean expression over one or more variables
+    ///        is true. The expression is compiled once (when the filter is made) and evaluated
+    ///        over blocks of rows into a single row mask, so every field is only sliced once no
+    ///        matter how many conditions the expression has.
+    ///
+    /// \details Supported syntax (numbers, 'strings' or "strings" as literals):
+    ///          - comparisons of a variable with a literal: ==, !=, <, <=, >, >=
+    ///          - set membership: variable in [literal, literal, ...]
+    ///          - isMissing(variable)
+    ///          - and, or, not and parentheses
+    ///          Comparisons and set membership are never true for missing values. For variables
+    ///          with more than one value per row a condition holds for a row if it holds for all
+    ///          the values of the row (like the BoundingFilter).
+    class ExpressionFilter : public Filter
+    {
+     public:
+        /// \brief Constructor
+        /// \param conf The configuration for this filter
+        explicit ExpressionFilter(const eckit::LocalConfiguration& conf);
+
+        virtual ~ExpressionFilter() = default;
+
+        /// \brief Apply the filter to the data.
+        /// \param dataMap Map to modify by filtering out the rows where the expression is false.
+        void apply(BufrDataMap& dataMap) final;
+
+     private:
+        const std::string expressionStr_;
+        std::shared_ptr<const expression::Node> expression_;
+        std::vector<std::string> variables_;
+    };
+}  // namespace bufr
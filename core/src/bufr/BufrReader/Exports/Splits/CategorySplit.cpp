@@ -3,6 +3,9 @@
 #include "CategorySplit.h"
 
 #include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "eckit/exception/Exceptions.h"
 
@@ -46,39 +49,32 @@ namespace bufr {
 
     std::unordered_map<std::string, BufrDataMap> CategorySplit::split(const BufrDataMap &dataMap)
     {
-        updateNameMap(dataMap);
-
-        std::unordered_map<std::string, BufrDataMap> dataMaps;
+        return splitByRowCategories(dataMap);
+    }
 
-        const auto& dataObject = dataMap.at(variable_);
+    std::vector<size_t> CategorySplit::rowCategories(const BufrDataMap& dataMap)
+    {
+        updateNameMap(dataMap);
 
+        std::unordered_map<int, size_t> categoryIdxs;
         for (const auto& mapPair : nameMap_)
         {
-            // Find matching rows
-            std::vector<size_t> indexVec;
-            for (auto rowIdx = 0; rowIdx < dataObject->getDims()[0]; rowIdx++)
-            {
-                auto location = Location(dataObject->getDims().size(), 0);
-                location[0] = rowIdx;
-
-                if (dataObject->getAsInt(location) == mapPair.first)
-                {
-                    indexVec.push_back(rowIdx);
-                }
-            }
+            categoryIdxs.insert({mapPair.first, categoryIdxs.size()});
+        }
 
-            // Make new data map
-            BufrDataMap newDataMap;
-            for (const auto& dataPair : dataMap)
+        // One pass over the split variable
+        const auto values = rowValues(dataMap.at(variable_));
+        std::vector<size_t> categories(values.size(), NoCategory);
+        for (size_t rowIdx = 0; rowIdx < values.size(); ++rowIdx)
+        {
+            auto categoryIt = categoryIdxs.find(values[rowIdx]);
+            if (categoryIt != categoryIdxs.end())
             {
-                const auto newArr = dataPair.second->slice(indexVec);
-                newDataMap.insert({dataPair.first, newArr});
+                categories[rowIdx] = categoryIt->second;
             }
-
-            dataMaps.insert({mapPair.second, newDataMap});
         }
 
-        return dataMaps;
+        return categories;
     }
 
     void CategorySplit::updateNameMap(const BufrDataMap& dataMap)
@@ -86,23 +82,17 @@ namespace bufr {
         if (nameMap_.empty())
         {
             const auto& dataObject = dataMap.at(variable_);
-            for (auto rowIdx = 0; rowIdx < dataObject->getDims()[0]; rowIdx++)
+            if (!std::dynamic_pointer_cast<DataObject<int>>(dataObject))
             {
-                auto location = Location(dataObject->getDims().size(), 0);
-                location[0] = rowIdx;
-
-                if (auto dat = std::dynamic_pointer_cast<DataObject<int>> (dataObject))
-                {
-                    auto itemVal = dat->get(location);
-                    nameMap_.insert({itemVal, std::to_string(itemVal)});
-                }
-                else
-                {
-                    std::stringstream errStr;
-                    errStr << "Can not turn " << variable_ << " into a category as it contains ";
-                    errStr << "non-integer values.";
-                    throw eckit::BadParameter(errStr.str());
-                }
+                std::stringstream errStr;
+                errStr << "Can not turn " << variable_ << " into a category as it contains ";
+                errStr << "non-integer values.";
+                throw eckit::BadParameter(errStr.str());
+            }
+
+            for (const auto value : rowValues(dataObject))
+            {
+                nameMap_.insert({value, std::to_string(value)});
             }
         }
 
@@ -113,4 +103,34 @@ namespace bufr {
             throw eckit::BadParameter(errStr.str());
         }
     }
+
+    std::vector<int> CategorySplit::rowValues(const std::shared_ptr<DataObjectBase>& dataObject)
+    {
+        const auto& dims = dataObject->getDims();
+        const size_t numRows = dims.empty() ? 0 : dims[0];
+
+        size_t rowLength = 1;
+        for (size_t dimIdx = 1; dimIdx < dims.size(); ++dimIdx)
+        {
+            rowLength *= dims[dimIdx];
+        }
+
+        std::vector<int> values(numRows);
+        if (auto intObject = std::dynamic_pointer_cast<DataObject<int>>(dataObject))
+        {
+            for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            {
+                values[rowIdx] = intObject->valueAt(rowIdx * rowLength);
+            }
+        }
+        else
+        {
+            for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            {
+                values[rowIdx] = dataObject->getAsInt(rowIdx * rowLength);
+            }
+        }
+
+        return values;
+    }
 }  // namespace bufr
@@ -49,6 +49,11 @@ namespace bufr {
         /// \result map of split data where the category is the key
         std::unordered_map<std::string, BufrDataMap> split(const BufrDataMap& dataMap) final;
 
+        /// \brief Get the category of every row (from the value of the split variable)
+        /// \param dataMap Data to be split
+        /// \result index into subCategories(dataMap) for every row (NoCategory for dropped rows)
+        std::vector<size_t> rowCategories(const BufrDataMap& dataMap) final;
+
      private:
         const std::string variable_;
 
@@ -58,5 +63,9 @@ namespace bufr {
         /// \brief Adds values to nameMap_ using the data if nameMap_ is empty.
         /// \param dataMap Data to be split
         void updateNameMap(const BufrDataMap& dataMap);
+
+        /// \brief Get the (first) value of every row of the split variable as an integer.
+        /// \param dataObject The split variable.
+        static std::vector<int> rowValues(const std::shared_ptr<DataObjectBase>& dataObject);
     };
 }  // namespace bufr
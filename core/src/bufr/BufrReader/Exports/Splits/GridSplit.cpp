@@ -0,0 +1,273 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+#include "GridSplit.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace
+{
+    namespace ConfKeys
+    {
+        const char* Latitude = "latitude";
+        const char* Longitude = "longitude";
+        const char* Type = "type";
+        const char* LatSpacing = "latSpacing";
+        const char* LonSpacing = "lonSpacing";
+        const char* Resolution = "resolution";
+    }  // namespace ConfKeys
+
+    namespace GridTypes
+    {
+        const char* LatLon = "latlon";
+        const char* CubedSphere = "cubedSphere";
+    }  // namespace GridTypes
+
+    constexpr double Pi = 3.14159265358979323846;
+    constexpr double DegToRad = Pi / 180.0;
+
+    /// \brief Get the index of the cell that holds an equiangular cube face coordinate.
+    /// \param tanAngle Tangent of the angle from the center of the face (-1 to 1).
+    /// \param resolution Number of cells along the edge of the face.
+    inline size_t cubeCell(double tanAngle, size_t resolution)
+    {
+        const double pos = (std::atan(tanAngle) + Pi / 4) / (Pi / 2) * resolution;
+        return std::min(static_cast<size_t>(std::max(pos, 0.0)), resolution - 1);
+    }
+}  // namespace
+
+namespace bufr {
+    GridSplit::GridSplit(const std::string& name, const eckit::LocalConfiguration& conf) :
+        Split(name, conf),
+        latitude_(conf.getString(ConfKeys::Latitude)),
+        longitude_(conf.getString(ConfKeys::Longitude))
+    {
+        const auto gridType = conf.getString(ConfKeys::Type, GridTypes::LatLon);
+        if (gridType == GridTypes::LatLon)
+        {
+            gridType_ = GridType::LatLon;
+            latSpacing_ = conf.getDouble(ConfKeys::LatSpacing);
+            lonSpacing_ = conf.getDouble(ConfKeys::LonSpacing);
+
+            if (!(latSpacing_ > 0 && latSpacing_ <= 180 && lonSpacing_ > 0 && lonSpacing_ <= 360))
+            {
+                std::stringstream errStr;
+                errStr << "Grid split " << name << " needs a latSpacing in (0, 180] and a ";
+                errStr << "lonSpacing in (0, 360] degrees.";
+                throw eckit::BadParameter(errStr.str());
+            }
+
+            // The last box is cut short if the spacing doesn't divide the globe evenly.
+            numLats_ = static_cast<size_t>(std::ceil(180.0 / latSpacing_ - 1e-9));
+            numLons_ = static_cast<size_t>(std::ceil(360.0 / lonSpacing_ - 1e-9));
+        }
+        else if (gridType == GridTypes::CubedSphere)
+        {
+            gridType_ = GridType::CubedSphere;
+            const int resolution = conf.getInt(ConfKeys::Resolution, 1);
+            if (resolution < 1)
+            {
+                std::stringstream errStr;
+                errStr << "Grid split " << name << " needs a resolution of at least 1.";
+                throw eckit::BadParameter(errStr.str());
+            }
+
+            resolution_ = static_cast<size_t>(resolution);
+        }
+        else
+        {
+            std::stringstream errStr;
+            errStr << "Unknown grid type " << gridType << " for grid split " << name;
+            errStr << " (must be " << GridTypes::LatLon << " or " << GridTypes::CubedSphere << ").";
+            throw eckit::BadParameter(errStr.str());
+        }
+
+        makeTileNames();
+    }
+
+    std::vector<std::string> GridSplit::subCategories(const BufrDataMap& /*dataMap*/)
+    {
+        return tileNames_;
+    }
+
+    std::unordered_map<std::string, BufrDataMap> GridSplit::split(const BufrDataMap& dataMap)
+    {
+        return splitByRowCategories(dataMap);
+    }
+
+    std::vector<size_t> GridSplit::rowCategories(const BufrDataMap& dataMap)
+    {
+        for (const auto& variable : {latitude_, longitude_})
+        {
+            if (dataMap.find(variable) == dataMap.end())
+            {
+                std::stringstream errStr;
+                errStr << "Grid split " << name_ << " uses unknown variable " << variable << ".";
+                throw eckit::BadParameter(errStr.str());
+            }
+        }
+
+        const auto lats = rowValues(dataMap.at(latitude_));
+        const auto lons = rowValues(dataMap.at(longitude_));
+        if (lats.size() != lons.size())
+        {
+            std::stringstream errStr;
+            errStr << "Grid split " << name_ << " needs " << latitude_ << " and " << longitude_;
+            errStr << " to have the same number of rows.";
+            throw eckit::BadParameter(errStr.str());
+        }
+
+        // One pass over the coordinates (missing values are NaN, which fail the range checks).
+        std::vector<size_t> tiles(lats.size(), NoCategory);
+        if (gridType_ == GridType::LatLon)
+        {
+            for (size_t rowIdx = 0; rowIdx < lats.size(); ++rowIdx)
+            {
+                const double lat = lats[rowIdx];
+                const double lon = lons[rowIdx];
+                if (!(lat >= -90.0 && lat <= 90.0) || !std::isfinite(lon)) continue;
+
+                // Wrap the longitude into [-180, 180)
+                const double wrappedLon = lon - 360.0 * std::floor((lon + 180.0) / 360.0);
+
+                const auto latIdx = static_cast<size_t>((lat + 90.0) / latSpacing_);
+                const auto lonIdx = static_cast<size_t>((wrappedLon + 180.0) / lonSpacing_);
+                tiles[rowIdx] = std::min(latIdx, numLats_ - 1) * numLons_
+                                + std::min(lonIdx, numLons_ - 1);
+            }
+        }
+        else
+        {
+            for (size_t rowIdx = 0; rowIdx < lats.size(); ++rowIdx)
+            {
+                const double lat = lats[rowIdx];
+                const double lon = lons[rowIdx];
+                if (!(lat >= -90.0 && lat <= 90.0) || !std::isfinite(lon)) continue;
+
+                const double x = std::cos(lat * DegToRad) * std::cos(lon * DegToRad);
+                const double y = std::cos(lat * DegToRad) * std::sin(lon * DegToRad);
+                const double z = std::sin(lat * DegToRad);
+                const double absX = std::abs(x);
+                const double absY = std::abs(y);
+                const double absZ = std::abs(z);
+
+                // The face is the axis the point is closest to, and the cell comes from the
+                // angles along the two axes of the face.
+                size_t face;
+                double u;
+                double v;
+                if (absX >= absY && absX >= absZ)
+                {
+                    face = (x > 0) ? 0 : 3;
+                    u = ((x > 0) ? y : -y) / absX;
+                    v = z / absX;
+                }
+                else if (absY >= absZ)
+                {
+                    face = (y > 0) ? 1 : 4;
+                    u = ((y > 0) ? -x : x) / absY;
+                    v = z / absY;
+                }
+                else
+                {
+                    face = (z > 0) ? 2 : 5;
+                    u = y / absZ;
+                    v = ((z > 0) ? -x : x) / absZ;
+                }
+
+                tiles[rowIdx] = (face * resolution_ + cubeCell(v, resolution_)) * resolution_
+                                + cubeCell(u, resolution_);
+            }
+        }
+
+        return tiles;
+    }
+
+    void GridSplit::makeTileNames()
+    {
+        tileNames_.clear();
+        if (gridType_ == GridType::LatLon)
+        {
+            for (size_t latIdx = 0; latIdx < numLats_; ++latIdx)
+            {
+                for (size_t lonIdx = 0; lonIdx < numLons_; ++lonIdx)
+                {
+                    std::ostringstream nameStr;
+                    nameStr << "lat_" << -90.0 + latIdx * latSpacing_;
+                    nameStr << "_" << std::min(-90.0 + (latIdx + 1) * latSpacing_, 90.0);
+                    nameStr << "__lon_" << -180.0 + lonIdx * lonSpacing_;
+                    nameStr << "_" << std::min(-180.0 + (lonIdx + 1) * lonSpacing_, 180.0);
+                    tileNames_.push_back(nameStr.str());
+                }
+            }
+        }
+        else
+        {
+            for (size_t face = 0; face < 6; ++face)
+            {
+                for (size_t cellJ = 0; cellJ < resolution_; ++cellJ)
+                {
+                    for (size_t cellI = 0; cellI < resolution_; ++cellI)
+                    {
+                        std::ostringstream nameStr;
+                        nameStr << "tile" << face + 1;
+                        if (resolution_ > 1)
+                        {
+                            nameStr << "_" << cellI + 1 << "_" << cellJ + 1;
+                        }
+
+                        tileNames_.push_back(nameStr.str());
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<double> GridSplit::rowValues(const std::shared_ptr<DataObjectBase>& dataObject)
+    {
+        const auto& dims = dataObject->getDims();
+        const size_t numRows = dims.empty() ? 0 : dims[0];
+
+        size_t rowLength = 1;
+        for (size_t dimIdx = 1; dimIdx < dims.size(); ++dimIdx)
+        {
+            rowLength *= dims[dimIdx];
+        }
+
+        constexpr double Missing = std::numeric_limits<double>::quiet_NaN();
+
+        std::vector<double> values(numRows);
+        if (auto floatObject = std::dynamic_pointer_cast<DataObject<float>>(dataObject))
+        {
+            for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            {
+                const float value = floatObject->valueAt(rowIdx * rowLength);
+                values[rowIdx] = (value == DataObject<float>::missingValue()) ? Missing : value;
+            }
+        }
+        else if (auto doubleObject = std::dynamic_pointer_cast<DataObject<double>>(dataObject))
+        {
+            for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            {
+                const double value = doubleObject->valueAt(rowIdx * rowLength);
+                values[rowIdx] = (value == DataObject<double>::missingValue()) ? Missing : value;
+            }
+        }
+        else
+        {
+            for (size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            {
+                const size_t idx = rowIdx * rowLength;
+                values[rowIdx] = dataObject->isMissing(idx) ? Missing : dataObject->getAsFloat(idx);
+            }
+        }
+
+        return values;
+    }
+}  // namespace bufr
@@ -0,0 +1,81 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+#pragma once
+
+#include "bufr/Split.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace bufr {
+    /// \brief Data splitter class that splits data into spatial tiles by latitude and longitude.
+    /// \details Each row goes into the tile that holds its (first) latitude and longitude value,
+    ///          so the data for a tile can be written to its own file (ex: with {splits/tile}
+    ///          in the output path) and a task that only needs part of the globe reads only
+    ///          its tiles. Two kinds of grids are supported:
+    ///            - latlon: a regular grid of latSpacing x lonSpacing degree boxes starting at
+    ///              (-90, -180), named like lat_-90_-60__lon_-180_-135.
+    ///            - cubedSphere: the 6 faces of a gnomonic cube, each divided into
+    ///              resolution x resolution equiangular cells, named tile1 ... tile6 (or
+    ///              tile<face>_<i>_<j> if resolution > 1). The faces are centered on longitude 0,
+    ///              longitude 90, the north pole, longitude 180, longitude -90 and the south
+    ///              pole (in that order).
+    ///          The categories are all the tiles of the grid (whether they have data or not), so
+    ///          they are the same on every rank. Rows with missing or invalid coordinates are
+    ///          discarded.
+    class GridSplit : public Split
+    {
+     public:
+        /// \brief constructor
+        /// \param name The name of the split.
+        /// \param conf The configuration of the split (variables and grid).
+        GridSplit(const std::string& name, const eckit::LocalConfiguration& conf);
+
+        /// \brief Get list of sub categories this split will create (the names of the tiles)
+        /// \result Set of unique strings.
+        std::vector<std::string> subCategories(const BufrDataMap& dataMap) final;
+
+        /// \brief Split the data according to internal rules
+        /// \param dataMap Data to be split
+        /// \result map of split data where the category is the key
+        std::unordered_map<std::string, BufrDataMap> split(const BufrDataMap& dataMap) final;
+
+        /// \brief Get the tile of every row (from the latitude and longitude)
+        /// \param dataMap Data to be split
+        /// \result index into subCategories(dataMap) for every row (NoCategory for dropped rows)
+        std::vector<size_t> rowCategories(const BufrDataMap& dataMap) final;
+
+     private:
+        enum class GridType
+        {
+            LatLon,
+            CubedSphere
+        };
+
+        const std::string latitude_;
+        const std::string longitude_;
+        GridType gridType_ = GridType::LatLon;
+
+        /// Size of the boxes of the latlon grid (degrees) and the number of them
+        double latSpacing_ = 0;
+        double lonSpacing_ = 0;
+        size_t numLats_ = 0;
+        size_t numLons_ = 0;
+
+        /// Number of cells along each edge of a cube face
+        size_t resolution_ = 1;
+
+        /// Names of the tiles (in the order of the tile indices)
+        std::vector<std::string> tileNames_;
+
+        /// \brief Make the names of all the tiles of the grid.
+        void makeTileNames();
+
+        /// \brief Get the (first) value of every row of a coordinate variable (NaN if missing).
+        /// \param dataObject The coordinate variable.
+        static std::vector<double> rowValues(const std::shared_ptr<DataObjectBase>& dataObject);
+    };
+}  // namespace bufr
@@ -0,0 +1,88 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+#include "bufr/Split.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // Slices smaller than this (fields x rows) are not worth starting threads for.
+    constexpr size_t ParallelRows = 1 << 16;
+}  // namespace
+
+namespace bufr {
+    std::vector<BufrDataMap> Split::sliceRows(const BufrDataMap& dataMap,
+                                              const std::vector<std::vector<size_t>>& rowSets)
+    {
+        // The fields are independent so they are split between threads (their validity is
+        // computed lazily, so compute it up front rather than from several threads at once).
+        const std::vector<std::pair<std::string, std::shared_ptr<DataObjectBase>>> fields(
+            dataMap.begin(), dataMap.end());
+
+        size_t numRows = 0;
+        for (const auto& rows : rowSets)
+        {
+            numRows += rows.size();
+        }
+
+        for (const auto& field : fields)
+        {
+            field.second->getValidity();
+        }
+
+        std::vector<std::vector<std::shared_ptr<DataObjectBase>>> slices(fields.size());
+        const auto numFields = static_cast<long>(fields.size());
+        [[maybe_unused]] const size_t sliceSize = fields.size() * numRows;  // Only used by OpenMP
+
+        #pragma omp parallel for schedule(dynamic) if (sliceSize >= ParallelRows)
+        for (long fieldIdx = 0; fieldIdx < numFields; ++fieldIdx)
+        {
+            auto& fieldSlices = slices[fieldIdx];
+            fieldSlices.reserve(rowSets.size());
+            for (const auto& rows : rowSets)
+            {
+                fieldSlices.push_back(fields[fieldIdx].second->slice(rows));
+            }
+        }
+
+        std::vector<BufrDataMap> dataMaps(rowSets.size());
+        for (size_t setIdx = 0; setIdx < rowSets.size(); ++setIdx)
+        {
+            dataMaps[setIdx].reserve(fields.size());
+            for (size_t fieldIdx = 0; fieldIdx < fields.size(); ++fieldIdx)
+            {
+                dataMaps[setIdx].insert({fields[fieldIdx].first, slices[fieldIdx][setIdx]});
+            }
+        }
+
+        return dataMaps;
+    }
+
+    std::unordered_map<std::string, BufrDataMap> Split::splitByRowCategories(
+        const BufrDataMap& dataMap)
+    {
+        const auto categories = subCategories(dataMap);
+
+        std::vector<std::vector<size_t>> categoryRows(categories.size());
+        const auto rowCats = rowCategories(dataMap);
+        for (size_t rowIdx = 0; rowIdx < rowCats.size(); ++rowIdx)
+        {
+            if (rowCats[rowIdx] != NoCategory)
+            {
+                categoryRows[rowCats[rowIdx]].push_back(rowIdx);
+            }
+        }
+
+        auto slices = sliceRows(dataMap, categoryRows);
+
+        std::unordered_map<std::string, BufrDataMap> dataMaps;
+        for (size_t categoryIdx = 0; categoryIdx < categories.size(); ++categoryIdx)
+        {
+            dataMaps.insert({categories[categoryIdx], std::move(slices[categoryIdx])});
+        }
+
+        return dataMaps;
+    }
+}  // namespace bufr
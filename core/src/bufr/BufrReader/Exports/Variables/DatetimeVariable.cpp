@@ -55,7 +55,6 @@ namespace bufr {
 
   std::shared_ptr<DataObjectBase> DatetimeVariable::exportData(const BufrDataMap& map) {
     checkKeys(map);
-    static const int missingInt = DataObject<int>::missingValue();
 
     setenv("TZ", "UTC", 1);             // Force UTC time zone
     std::tm tm{};                       // zero initialise
@@ -68,9 +67,6 @@ namespace bufr {
     tm.tm_isdst         = 0;  // Not daylight saving
     std::time_t epochDt = std::mktime(&tm);
 
-    std::vector<int64_t> timeOffsets;
-    timeOffsets.reserve(map.at(getExportKey(ConfKeys::Year))->size());
-
     auto yearVar = map.at(getExportKey(ConfKeys::Year));
 
     // Validation
@@ -83,7 +79,14 @@ namespace bufr {
       throw eckit::BadParameter(errStr.str());
     }
 
-    for (unsigned int idx = 0; idx < map.at(getExportKey(ConfKeys::Year))->size(); idx++) {
+    // The time is only valid where the year, month, day and hour all are.
+    auto validity = yearVar->getExpandedValidity();
+    validity &= map.at(getExportKey(ConfKeys::Month))->getExpandedValidity();
+    validity &= map.at(getExportKey(ConfKeys::Day))->getExpandedValidity();
+    validity &= map.at(getExportKey(ConfKeys::Hour))->getExpandedValidity();
+
+    std::vector<int64_t> timeOffsets(yearVar->size(), DataObject<int64_t>::missingValue());
+    validity.forEachValid([&](size_t idx) {
       int year    = map.at(getExportKey(ConfKeys::Year))->getAsInt(idx);
       int month   = map.at(getExportKey(ConfKeys::Month))->getAsInt(idx);
       int day     = map.at(getExportKey(ConfKeys::Day))->getAsInt(idx);
@@ -91,51 +94,50 @@ namespace bufr {
       int minutes = 0;
       int seconds = 0;
 
-      auto diff_time = DataObject<int64_t>::missingValue();
-      if (year != missingInt && month != missingInt && day != missingInt && hour != missingInt) {
-        tm.tm_year  = year - 1900;
-        tm.tm_mon   = month - 1;
-        tm.tm_mday  = day;
-        tm.tm_hour  = hour;
-        tm.tm_min   = 0;
-        tm.tm_sec   = 0;
-        tm.tm_isdst = 0;
-
-        if (!minuteQuery_.empty()) {
-          minutes = map.at(getExportKey(ConfKeys::Minute))->getAsInt(idx);
-
-          if (minutes >= 0 && minutes < 60) {
-            tm.tm_min = minutes;
-          }
-        }
+      tm.tm_year  = year - 1900;
+      tm.tm_mon   = month - 1;
+      tm.tm_mday  = day;
+      tm.tm_hour  = hour;
+      tm.tm_min   = 0;
+      tm.tm_sec   = 0;
+      tm.tm_isdst = 0;
 
-        if (!secondQuery_.empty()) {
-          seconds = map.at(getExportKey(ConfKeys::Second))->getAsInt(idx);
+      if (!minuteQuery_.empty()) {
+        minutes = map.at(getExportKey(ConfKeys::Minute))->getAsInt(idx);
 
-          if (seconds >= 0 && seconds < 60) {
-            tm.tm_sec = seconds;
-          }
+        if (minutes >= 0 && minutes < 60) {
+          tm.tm_min = minutes;
         }
+      }
 
-        // Be careful with mktime as it can be very slow.
-        auto thisTime = std::mktime(&tm);
-        if (thisTime < 0) {
-          log::warning() << "Caution, date suspicious date (year, month, day): " << year << ", "
-                               << month << ", " << day << std::endl;
+      if (!secondQuery_.empty()) {
+        seconds = map.at(getExportKey(ConfKeys::Second))->getAsInt(idx);
+
+        if (seconds >= 0 && seconds < 60) {
+          tm.tm_sec = seconds;
         }
+      }
 
-        diff_time = static_cast<int64_t>(difftime(thisTime, epochDt) + hoursFromUtc_ * 3600);
+      // Be careful with mktime as it can be very slow.
+      auto thisTime = std::mktime(&tm);
+      if (thisTime < 0) {
+        log::warning() << "Caution, date suspicious date (year, month, day): " << year << ", "
+                             << month << ", " << day << std::endl;
       }
 
-      timeOffsets.push_back(diff_time);
-    }
+      timeOffsets[idx] =
+        static_cast<int64_t>(difftime(thisTime, epochDt) + hoursFromUtc_ * 3600);
+    });
+
+    auto timeObj = DataObjectBuilder::make<int64_t>(std::move(timeOffsets),
+                                                    getExportName(),
+                                                    groupByField_,
+                                                    yearVar->getDims(),
+                                                    yearVar->getPath(),
+                                                    yearVar->getDimPaths());
+    timeObj->setValidity(std::move(validity));
 
-    return DataObjectBuilder::make<int64_t>(timeOffsets,
-                                            getExportName(),
-                                            groupByField_,
-                                            map.at(getExportKey(ConfKeys::Year))->getDims(),
-                                            map.at(getExportKey(ConfKeys::Year))->getPath(),
-                                            map.at(getExportKey(ConfKeys::Year))->getDimPaths());
+    return timeObj;
   }
 
   void DatetimeVariable::checkKeys(const BufrDataMap& map) {
@@ -21,7 +21,8 @@ namespace bufr {
     QueryVariable::QueryVariable(const std::string& exportName,
                                  const std::string& groupByField,
                                  const eckit::LocalConfiguration& conf) :
-        Variable(exportName, groupByField, conf)
+        Variable(exportName, groupByField, conf),
+        transform_(TransformBuilder::makeFusedTransform(conf))
     {
         initQueryMap();
     }
@@ -38,9 +39,9 @@ namespace bufr {
 
         auto dataObject = map.at(getExportName());
 
-        for (const auto& transform : TransformBuilder::makeTransforms(conf_))
+        if (transform_)
         {
-            transform->apply(dataObject);
+            transform_->apply(dataObject);
         }
 
         return dataObject;
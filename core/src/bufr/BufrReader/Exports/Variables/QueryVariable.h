@@ -31,5 +31,9 @@ namespace bufr {
 
         /// \brief Get a list of queries for this variable
         QueryList makeQueryList() const final;
+
+     private:
+        /// \brief The configured transforms compiled into one (nullptr if there are none)
+        std::shared_ptr<Transform> transform_;
     };
 }  // namespace bufr
@@ -23,7 +23,6 @@ namespace
     {
         const char* Timeoffset = "timeOffset";
         const char* Referencetime = "referenceTime";
-        const char* Transforms = "transforms";
     }  // namespace ConfKeys
 }  // namespace
 
@@ -32,7 +31,8 @@ namespace bufr {
     TimeoffsetVariable::TimeoffsetVariable(const std::string& exportName,
                                            const std::string& groupByField,
                                            const eckit::LocalConfiguration &conf) :
-      Variable(exportName, groupByField, conf)
+      Variable(exportName, groupByField, conf),
+      transform_(TransformBuilder::makeFusedTransform(conf))
     {
         initQueryMap();
     }
@@ -64,13 +64,9 @@ namespace bufr {
         }
 
         auto timeOffsets = map.at(getExportKey(ConfKeys::Timeoffset));
-        if (conf_.has(ConfKeys::Transforms))
+        if (transform_)
         {
-            auto transforms = TransformBuilder::makeTransforms(conf_);
-            for (const auto &transform : transforms)
-            {
-                transform->apply(timeOffsets);
-            }
+            transform_->apply(timeOffsets);
         }
 
         auto timeDiffs = std::vector<int64_t> (timeOffsets->size());
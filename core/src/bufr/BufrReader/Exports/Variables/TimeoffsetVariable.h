@@ -9,6 +9,7 @@
 #include "eckit/config/LocalConfiguration.h"
 
 #include "bufr/Variable.h"
+#include "Transforms/Transform.h"
 
 
 namespace bufr {
@@ -30,6 +31,9 @@ namespace bufr {
         QueryList makeQueryList() const final;
 
      private:
+        /// \brief The configured transforms compiled into one (nullptr if there are none)
+        std::shared_ptr<Transform> transform_;
+
         /// \brief makes sure the bufr data map has all the required keys.
         void checkKeys(const BufrDataMap& map);
 
@@ -0,0 +1,88 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+#include "AffineTransform.h"
+
+#include <cmath>
+#include <sstream>
+
+#include "eckit/exception/Exceptions.h"
+
+namespace bufr {
+    void AffineTransform::scaleBy(double scaling)
+    {
+        if (isClamped())
+        {
+            throw eckit::BadParameter("Scale transforms must come before the bounds.");
+        }
+
+        if (scaling != 1.0) steps_.push_back({true, scaling});
+    }
+
+    void AffineTransform::offsetBy(double offset)
+    {
+        if (isClamped())
+        {
+            throw eckit::BadParameter("Offset transforms must come before the bounds.");
+        }
+
+        if (offset != 0.0) steps_.push_back({false, offset});
+    }
+
+    void AffineTransform::setLowerBound(double lowerBound)
+    {
+        lowerBound_ = lowerBound;
+    }
+
+    void AffineTransform::setUpperBound(double upperBound)
+    {
+        upperBound_ = upperBound;
+    }
+
+    bool AffineTransform::isClamped() const
+    {
+        return lowerBound_ > -std::numeric_limits<double>::infinity() ||
+               upperBound_ < std::numeric_limits<double>::infinity();
+    }
+
+    bool AffineTransform::isIdentity() const
+    {
+        return steps_.empty() && !isClamped();
+    }
+
+    void AffineTransform::apply(std::shared_ptr<DataObjectBase>& dataObject)
+    {
+        if (isIdentity()) return;
+
+        const bool isFloatingPoint =
+            std::dynamic_pointer_cast<DataObject<float>>(dataObject) != nullptr ||
+            std::dynamic_pointer_cast<DataObject<double>>(dataObject) != nullptr;
+
+        // a * (s * x + b) = (a * s) * x + (a * b)
+        double scale = 1.0;
+        double offset = 0.0;
+        for (const auto& step : steps_)
+        {
+            if (step.isScale)
+            {
+                if (!isFloatingPoint && std::trunc(step.value) != step.value)
+                {
+                    std::ostringstream errStr;
+                    errStr << "Multiplying integer field \"" << dataObject->getFieldName();
+                    errStr << "\" with a non-integer is illegal. Please convert it to a float ";
+                    errStr << "or double.";
+                    throw eckit::BadParameter(errStr.str());
+                }
+
+                scale *= step.value;
+                offset *= step.value;
+            }
+            else
+            {
+                // Integer data only ever gets the integer part of an offset.
+                offset += isFloatingPoint ? step.value : std::trunc(step.value);
+            }
+        }
+
+        dataObject->applyAffine(scale, offset, lowerBound_, upperBound_);
+    }
+}  // namespace bufr
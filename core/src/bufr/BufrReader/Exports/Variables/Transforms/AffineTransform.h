@@ -0,0 +1,62 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include "Transform.h"
+
+
+namespace bufr {
+    /// \brief Transforms data with a chain of scale and offset steps followed by clamping the
+    ///        results to [lowerBound, upperBound]. The chain is compiled into y = a * x + b so
+    ///        the data is only traversed once (see TransformBuilder::makeFusedTransform).
+    ///        For integer data every offset is truncated to the integer type and every scale
+    ///        must be a whole number, just like applying the steps one at a time, so the fused
+    ///        result is exactly the same as the step by step one.
+    class AffineTransform : public Transform
+    {
+     public:
+        AffineTransform() = default;
+        ~AffineTransform() = default;
+
+        /// \brief Append a multiplication by a scaling factor to the transform.
+        /// \param scaling Value to multiply by.
+        void scaleBy(double scaling);
+
+        /// \brief Append the addition of an offset to the transform.
+        /// \param offset The value to add.
+        void offsetBy(double offset);
+
+        /// \brief Clamp the results to be no smaller than the given value.
+        /// \param lowerBound The smallest allowed result.
+        void setLowerBound(double lowerBound);
+
+        /// \brief Clamp the results to be no larger than the given value.
+        /// \param upperBound The largest allowed result.
+        void setUpperBound(double upperBound);
+
+        /// \brief Does the transform leave the data unchanged.
+        bool isIdentity() const;
+
+        /// \brief Modify data according to the rules of the transform.
+        /// \param array Array of data to modify.
+        void apply(std::shared_ptr<DataObjectBase>& dataObject) override;
+
+     private:
+        /// \brief One step of the chain (scale or offset).
+        struct Step
+        {
+            bool isScale;
+            double value;
+        };
+
+        std::vector<Step> steps_;
+        double lowerBound_ = -std::numeric_limits<double>::infinity();
+        double upperBound_ = std::numeric_limits<double>::infinity();
+
+        /// \brief Have bounds been set (scaling and offsetting must come before them).
+        bool isClamped() const;
+    };
+}  // namespace bufr
@@ -3,7 +3,6 @@
 #pragma once
 
 #include <memory>
-#include <vector>
 
 #include "bufr/DataObject.h"
 
@@ -18,6 +17,4 @@ namespace bufr {
         /// \param array Array of data to modify.
         virtual void apply(std::shared_ptr<DataObjectBase>& dataObject) = 0;
     };
-
-    typedef std::vector <std::shared_ptr<Transform>> Transforms;
 }  // namespace bufr
@@ -4,46 +4,57 @@
 
 #include "eckit/exception/Exceptions.h"
 
-#include "ScalingTransform.h"
-#include "OffsetTransform.h"
+#include "AffineTransform.h"
 
 
 static const char* TRANSFORMS_SECTION = "transforms";
 static const char* OFFSET_KEY = "offset";
 static const char* SCALE_KEY = "scale";
+static const char* LOWER_BOUND_KEY = "lowerBound";
+static const char* UPPER_BOUND_KEY = "upperBound";
 
 namespace bufr {
-    std::shared_ptr<Transform> TransformBuilder::makeTransform(const eckit::Configuration& conf)
+    std::shared_ptr<Transform> TransformBuilder::makeFusedTransform(
+                                                            const eckit::Configuration& conf)
     {
-        std::shared_ptr <Transform> transform;
-        if (conf.has(OFFSET_KEY))
-        {
-            transform = std::make_shared<OffsetTransform>(conf.getFloat(OFFSET_KEY));
-        }
-        else if (conf.has(SCALE_KEY))
-        {
-            transform = std::make_shared<ScalingTransform>(conf.getFloat(SCALE_KEY));
-        }
-        else
-        {
-            throw eckit::BadParameter("Tried to create unknown export transform type. "
-                                      "Check your configuration.");
-        }
-
-        return transform;
-    }
-
-    Transforms TransformBuilder::makeTransforms(const eckit::Configuration& conf)
-    {
-        Transforms transforms;
+        auto transform = std::make_shared<AffineTransform>();
         if (conf.has(TRANSFORMS_SECTION))
         {
             for (const auto& transformConf : conf.getSubConfigurations(TRANSFORMS_SECTION))
             {
-                transforms.push_back(makeTransform(transformConf));
+                if (transformConf.has(OFFSET_KEY))
+                {
+                    transform->offsetBy(transformConf.getFloat(OFFSET_KEY));
+                }
+                else if (transformConf.has(SCALE_KEY))
+                {
+                    transform->scaleBy(transformConf.getFloat(SCALE_KEY));
+                }
+                else if (transformConf.has(LOWER_BOUND_KEY) || transformConf.has(UPPER_BOUND_KEY))
+                {
+                    if (transformConf.has(LOWER_BOUND_KEY))
+                    {
+                        transform->setLowerBound(transformConf.getFloat(LOWER_BOUND_KEY));
+                    }
+
+                    if (transformConf.has(UPPER_BOUND_KEY))
+                    {
+                        transform->setUpperBound(transformConf.getFloat(UPPER_BOUND_KEY));
+                    }
+                }
+                else
+                {
+                    throw eckit::BadParameter("Tried to create unknown export transform type. "
+                                              "Check your configuration.");
+                }
             }
         }
 
-        return transforms;
+        if (transform->isIdentity())
+        {
+            return nullptr;
+        }
+
+        return transform;
     }
 }  // namespace bufr
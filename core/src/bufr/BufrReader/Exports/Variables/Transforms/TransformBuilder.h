@@ -15,12 +15,10 @@ namespace bufr {
     class TransformBuilder
     {
      public:
-        /// \brief Create a transform for the config data given. Used by makeTransforms.
-        /// \param conf ECKit config data for the tranform.
-        static std::shared_ptr<Transform> makeTransform(const eckit::Configuration& conf);
-
-        /// \brief Create a transforms for the config data given.
+        /// \brief Compile the list of transforms in the config data into one transform that
+        ///        is applied in a single pass over the data.
         /// \param conf ECKit config data for the list of transforms.
-        static Transforms makeTransforms(const eckit::Configuration& conf);
+        /// \return The fused transform or nullptr if there is nothing to do.
+        static std::shared_ptr<Transform> makeFusedTransform(const eckit::Configuration& conf);
     };
 }  // namespace bufr
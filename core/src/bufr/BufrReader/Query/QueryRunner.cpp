@@ -1,18 +1,39 @@
 // (C) Copyright 2022 NOAA/NWS/NCEP/EMC
 #include "QueryRunner.h"
 
+#include <cmath>
+#include <limits>
 #include <string>
 #include <iostream>
 #include <memory>
+#include <type_traits>
 
+#include "../../DataObjectBuilder.h"
 #include "../../Log.h"
+#include "bufr/Data.h"
 #include "bufr/SubsetTable.h"
 #include "VectorMath.h"
 #include "SubsetLookupTable.h"
+#include "QuerySetImpl.h"
 #include "ResultSetImpl.h"
 
 
 namespace bufr {
+    namespace {
+        /// \brief Check a raw value the way the BoundingFilter checks the collected value, which
+        ///        is converted to the type the target is read as (missing values become the fill
+        ///        value of that type).
+        template<typename T>
+        bool valueInBounds(double value, bool isMissing, float lowerBound, float upperBound)
+        {
+            const T typedValue = isMissing ? DataObject<T>::missingValue()
+                                           : static_cast<T>(value);
+
+            return static_cast<double>(typedValue) >= lowerBound &&
+                   static_cast<double>(typedValue) <= upperBound;
+        }
+    }  // namespace
+
     QueryRunner::QueryRunner(const QuerySet& querySet, ResultSet& resultSet,
                              const DataProviderType &dataProvider) :
         querySet_(querySet),
@@ -23,7 +44,99 @@ namespace bufr {
 
     void QueryRunner::accumulate()
     {
-      resultSet_.impl_->frames_.push_back(SubsetLookupTable(dataProvider_, getTargets()));
+      const auto targets = getTargets();
+
+      // Rejected subsets never become frames.
+      if (!querySet_.impl_->bounds().empty() && !inBounds(getBounds(*targets)))
+      {
+        return;
+      }
+
+      resultSet_.impl_->frames_.push_back(SubsetLookupTable(dataProvider_, targets));
+    }
+
+    const std::vector<QueryRunner::TargetBounds>& QueryRunner::getBounds(const Targets& targets)
+    {
+        const auto& subsetVariant = dataProvider_->getSubsetVariant();
+        auto boundsIt = boundsCache_.find(subsetVariant);
+        if (boundsIt != boundsCache_.end())
+        {
+            return boundsIt->second;
+        }
+
+        std::vector<TargetBounds> targetBounds;
+        for (const auto& target : targets)
+        {
+            auto queryBoundsIt = querySet_.impl_->bounds().find(target->name);
+            if (queryBoundsIt == querySet_.impl_->bounds().end()) continue;
+
+            // Only targets with (at most) one value per subset make one row per subset, the
+            // others are left to be filtered after the data is collected.
+            if (target->typeInfo.isString() || target->usesFilters || target->dimPaths.size() != 1)
+            {
+                continue;
+            }
+
+            const auto& queryBounds = queryBoundsIt->second;
+            const auto check = DataObjectBuilder::visitType(
+                target->name,
+                target->typeInfo,
+                queryBounds.type,
+                [](auto typeTag) -> BoundsCheck
+                {
+                    using T = typename decltype(typeTag)::type;
+                    if constexpr (std::is_same_v<T, std::string>)
+                    {
+                        return nullptr;
+                    }
+                    else
+                    {
+                        return &valueInBounds<T>;
+                    }
+                });
+
+            if (!check) continue;
+
+            targetBounds.push_back({target->nodeIdx,
+                                    queryBounds.lowerBound,
+                                    queryBounds.upperBound,
+                                    check});
+        }
+
+        return boundsCache_.insert({subsetVariant, targetBounds}).first->second;
+    }
+
+    bool QueryRunner::inBounds(const std::vector<TargetBounds>& bounds) const
+    {
+        for (const auto& targetBounds : bounds)
+        {
+            // Targets that don't apply to the subset (node 0) only have missing values.
+            size_t numValues = 0;
+            double value = MissingOctetValue;
+            if (targetBounds.nodeIdx != 0)
+            {
+                for (size_t cursor = 1; cursor <= dataProvider_->getNVal(); ++cursor)
+                {
+                    if (static_cast<size_t>(dataProvider_->getInv(cursor)) == targetBounds.nodeIdx)
+                    {
+                        value = dataProvider_->getVal(cursor);
+                        if (++numValues > 1) break;
+                    }
+                }
+            }
+
+            if (numValues > 1) continue;
+
+            const double tolerance = std::numeric_limits<double>::epsilon() * MissingOctetValue * 100;
+            const bool isMissing = std::fabs(value - MissingOctetValue) <= tolerance;
+            if (!targetBounds.check(value, isMissing, targetBounds.lowerBound,
+                                    targetBounds.upperBound))
+            {
+                return false;
+            }
+        }
+
+        return true;
     }
 
     std::shared_ptr<Targets> QueryRunner::getTargets()
@@ -26,19 +26,44 @@ namespace bufr {
                     const DataProviderType& dataProvider);
 
         /// \brief Run the queries against the currently open BUFR message subset. Collect the
-        /// results into the ResultSet.
+        /// results into the ResultSet (unless the subset is outside the bounds of the QuerySet).
         void accumulate();
 
      private:
+        /// \brief Checks a raw subset value (or missing) against bounds.
+        typedef bool (*BoundsCheck)(double value, bool isMissing, float lowerBound,
+                                    float upperBound);
+
+        /// \brief Bounds on the value of a target (see QuerySet::addBounds).
+        struct TargetBounds
+        {
+            size_t nodeIdx;
+            float lowerBound;
+            float upperBound;
+            BoundsCheck check;  // compares in the type the target is read as
+        };
+
         const QuerySet querySet_;
         ResultSet& resultSet_;
         const DataProviderType& dataProvider_;
 
         std::unordered_map<SubsetVariant, std::shared_ptr<Targets>> targetsCache_;
+        std::unordered_map<SubsetVariant, std::vector<TargetBounds>> boundsCache_;
 
         /// \brief Look for the list of targets for the currently active BUFR message subset that
         /// apply to the QuerySet and cache them.
         /// \param[in, out] targets The list of targets to populate.
         std::shared_ptr<Targets> getTargets();
+
+        /// \brief Get the bounds that can be checked for the currently active BUFR message
+        /// subset (targets with one value per subset) and cache them.
+        /// \param[in] targets The targets for the currently active BUFR message subset.
+        const std::vector<TargetBounds>& getBounds(const Targets& targets);
+
+        /// \brief Check the raw values of the currently active BUFR message subset against the
+        /// bounds.
+        /// \param[in] bounds The bounds to check.
+        /// \return True if the subset should be collected.
+        bool inBounds(const std::vector<TargetBounds>& bounds) const;
     };
 }  // namespace bufr
@@ -33,6 +33,14 @@ namespace bufr {
     impl_->add(name, query);
   }
 
+  void QuerySet::addBounds(const std::string& name,
+                            float lowerBound,
+                            float upperBound,
+                            const std::string& type)
+  {
+    impl_->addBounds(name, lowerBound, upperBound, type);
+  }
+
   size_t QuerySet::size() const
   {
     return impl_->size();
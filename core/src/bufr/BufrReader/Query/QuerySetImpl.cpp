@@ -1,6 +1,9 @@
 // (C) Copyright 2022 NOAA/NWS/NCEP/EMC
 
 #include <algorithm>
+#include <sstream>
+
+#include "eckit/exception/Exceptions.h"
 
 #include "QuerySetImpl.h"
 
@@ -74,6 +77,28 @@ namespace bufr {
         queryMap_[name] = queries;
     }
 
+    void QuerySetImpl::addBounds(const std::string& name,
+                                 float lowerBound,
+                                 float upperBound,
+                                 const std::string& type)
+    {
+        if (queryMap_.find(name) == queryMap_.end())
+        {
+            std::ostringstream errStr;
+            errStr << "QuerySet::addBounds: No query called " << name << ".";
+            throw eckit::BadParameter(errStr.str());
+        }
+
+        if (upperBound < lowerBound)
+        {
+            std::ostringstream errStr;
+            errStr << "QuerySet::addBounds: upperBound must be greater or equal to lowerBound.";
+            throw eckit::BadParameter(errStr.str());
+        }
+
+        boundsMap_[name] = {lowerBound, upperBound, type};
+    }
+
     bool QuerySetImpl::includesSubset(const std::string& subset) const
     {
         bool includesSubset = true;
@@ -13,6 +13,14 @@
 namespace bufr {
     typedef std::set<std::string> Subsets;
 
+    /// \brief Bounds the value of a query must be within for a subset to be collected.
+    struct QueryBounds
+    {
+        float lowerBound;
+        float upperBound;
+        std::string type;  // override type the query is read as (empty for the field's type)
+    };
+
     /// \brief Manages a collection of queries.
     class QuerySetImpl {
      public:
@@ -27,6 +35,19 @@ namespace bufr {
         /// \param[in] query The query string.
         void add(const std::string& name, const std::string& query);
 
+        /// \brief Set the bounds for the values of a query.
+        /// \param[in] name The name of the query.
+        /// \param[in] lowerBound The smallest allowed value.
+        /// \param[in] upperBound The largest allowed value.
+        /// \param[in] type The override type the query is read as (can be empty).
+        void addBounds(const std::string& name,
+                       float lowerBound,
+                       float upperBound,
+                       const std::string& type);
+
+        /// \brief Returns the bounds of the queries that have them.
+        const std::unordered_map<std::string, QueryBounds>& bounds() const { return boundsMap_; }
+
         /// \brief Returns the size of the collection.
         size_t size() const { return queryMap_.size(); }
 
@@ -45,6 +66,7 @@ namespace bufr {
 
      private:
         std::unordered_map<std::string, std::vector<Query>> queryMap_;
+        std::unordered_map<std::string, QueryBounds> boundsMap_;
         bool includesAllSubsets_;
         bool addHasBeenCalled_;
         const Subsets limitSubsets_;
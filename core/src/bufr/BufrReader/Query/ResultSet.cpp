@@ -20,4 +20,10 @@ namespace bufr {
         return impl_->get(fieldName, groupByFieldName, overrideType);
   }
 
+  std::shared_ptr<RaggedDataObjectBase> ResultSet::getRagged(const std::string& fieldName,
+                                                             const std::string& overrideType) const
+  {
+        return impl_->getRagged(fieldName, overrideType);
+  }
+
 }  // namespace bufr
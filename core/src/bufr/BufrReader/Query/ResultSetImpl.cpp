@@ -3,6 +3,7 @@
 #include "ResultSetImpl.h"
 
 #include <algorithm>
+#include <cctype>
 #include <iostream>
 #include <string>
 
@@ -14,6 +15,54 @@
 
 
 namespace bufr {
+namespace {
+  /// \brief Copy values from a frame data fragment into a typed output buffer, mapping the
+  ///        BUFR missing value to the missing value of the output type.
+  template<typename T>
+  void copyValues(const Data& fragment, size_t inputOffset, size_t count, T* output) {
+    if (fragment.isLongStr()) {
+      throw eckit::BadParameter("Can not make numerical field from string data.");
+    }
+
+    const auto& octets = fragment.value.octets;
+    for (size_t idx = 0; idx < count; ++idx) {
+      output[idx] = fragment.isMissing(inputOffset + idx)
+                      ? DataObject<T>::missingValue()
+                      : static_cast<T>(octets[inputOffset + idx]);
+    }
+  }
+
+  template<>
+  void copyValues<std::string>(const Data& fragment,
+                               size_t inputOffset,
+                               size_t count,
+                               std::string* output) {
+    if (fragment.isLongStr()) {
+      std::copy(fragment.value.strings.begin() + inputOffset,
+                fragment.value.strings.begin() + inputOffset + count,
+                output);
+      return;
+    }
+
+    // Short strings are stored as 8 character octets
+    auto charPtr = reinterpret_cast<const char*>(fragment.value.octets.data());
+    for (size_t idx = 0; idx < count; ++idx) {
+      if (fragment.isMissing(inputOffset + idx)) {
+        output[idx] = DataObject<std::string>::missingValue();
+        continue;
+      }
+
+      auto& str = output[idx];
+      str.assign(charPtr + (inputOffset + idx) * sizeof(double), sizeof(double));
+
+      // trim trailing whitespace from str
+      str.erase(std::find_if(str.rbegin(), str.rend(),
+                             [](char c) { return !std::isspace(c); }).base(),
+                str.end());
+    }
+  }
+}  // namespace
+
   std::shared_ptr<DataObjectBase> ResultSetImpl::get(const std::string& fieldName,
                                                      const std::string& groupByFieldName,
                                                      const std::string& overrideType) const
@@ -27,22 +76,68 @@ namespace bufr {
     // Get the metadata for the target
     const auto targetMetaData = analyzeTarget(fieldName);
 
-    // Assemble Result Data
-    auto data = assembleData(targetMetaData);
+    // Assemble the data directly in the output type (resolved from the TypeInfo or the
+    // override type) so no intermediate buffers or conversions are needed.
+    auto makeObject = [&](auto typeTag) -> std::shared_ptr<DataObjectBase> {
+      using T = typename decltype(typeTag)::type;
+
+      auto data = assembleData<T>(targetMetaData);
+
+      if (!groupByFieldName.empty()) {
+        applyGroupBy(data, targetMetaData, groupByFieldName);
+      }
+
+      auto object = DataObjectBuilder::make<T>(std::move(data.buffer),
+                                               fieldName,
+                                               groupByFieldName,
+                                               data.dims,
+                                               "",
+                                               data.dimPaths);
 
-    if (!groupByFieldName.empty()) {
-      applyGroupBy(data, targetMetaData, groupByFieldName);
+      if (data.repeats > 1) {
+        object->setRepeats(data.repeats);
+      }
+
+      return object;
+    };
+
+    return DataObjectBuilder::visitType(fieldName,
+                                        targetMetaData->typeInfo,
+                                        overrideType,
+                                        makeObject);
+  }
+
+  std::shared_ptr<RaggedDataObjectBase> ResultSetImpl::getRagged(
+                                                   const std::string& fieldName,
+                                                   const std::string& overrideType) const
+  {
+    if (frames_.size() == 0)
+    {
+      throw eckit::BadValue("ResultSet has no data.");
+    }
+
+    const auto targetMetaData = analyzeTarget(fieldName);
+
+    if (targetMetaData->dims.size() > 2) {
+      std::ostringstream errStr;
+      errStr << "Ragged output is only supported for fields with at most one repeated ";
+      errStr << "dimension. Field \"" << fieldName << "\" has ";
+      errStr << targetMetaData->dims.size() - 1 << ".";
+      throw eckit::BadParameter(errStr.str());
     }
 
-    auto object = DataObjectBuilder::make(fieldName,
-                                          groupByFieldName,
-                                          targetMetaData->typeInfo,
-                                          overrideType,
-                                          data.buffer,
-                                          data.dims,
-                                          data.dimPaths);
+    auto makeObject = [&](auto typeTag) -> std::shared_ptr<RaggedDataObjectBase> {
+      using T = typename decltype(typeTag)::type;
 
-    return object;
+      auto object = assembleRaggedData<T>(targetMetaData);
+      object->setFieldName(fieldName);
+      return object;
+    };
+
+    return DataObjectBuilder::visitType(fieldName,
+                                        targetMetaData->typeInfo,
+                                        overrideType,
+                                        makeObject);
   }
 
   details::TargetMetaDataPtr ResultSetImpl::analyzeTarget(const std::string& name) const {
@@ -65,6 +160,7 @@ namespace bufr {
 
       if (target->path.size() - 1 > metaData->rawDims.size()) {
         metaData->rawDims.resize(target->path.size() - 1, 0);
+        metaData->filteredRawDims.resize(target->path.size() - 1, 0);
       }
 
       // Resize the dims if necessary
@@ -89,6 +185,12 @@ namespace bufr {
           metaData->rawDims[pathIdx] = maxCount;
         }
 
+        if (!p->queryComponent->filter.empty()) {
+          metaData->filteredRawDims[pathIdx]
+            = std::max(metaData->filteredRawDims[pathIdx],
+                       static_cast<int>(p->queryComponent->filter.size()));
+        }
+
         if (target->exportDimIdxs.size() - 1 < static_cast<size_t>(exportIdxIdx))
         {
           ++pathIdx;
@@ -146,13 +248,26 @@ namespace bufr {
       }
     }
 
+    for (size_t dimIdx = 0; dimIdx < metaData->filteredRawDims.size(); ++dimIdx) {
+      if (metaData->filteredRawDims[dimIdx] == 0) {
+        metaData->filteredRawDims[dimIdx] = metaData->rawDims[dimIdx];
+      }
+    }
+
     return metaData;
   }
 
-  details::ResultData ResultSetImpl::assembleData(const details::TargetMetaDataPtr& metaData) const {
+  template<typename T>
+  details::ResultData<T> ResultSetImpl::assembleData(
+                                          const details::TargetMetaDataPtr& metaData) const {
+    // Query path filters (ex: {2-4}) are applied while the frame data is copied, so we need to
+    // know up front if the output is shaped by the raw or by the filtered dimensions.
+    const bool filtered = needsFiltering(metaData);
+    const auto& outDims = filtered ? metaData->filteredDims : metaData->rawDims;
+
     int rowLength = 1;
-    for (size_t dimIdx = 1; dimIdx < metaData->rawDims.size(); ++dimIdx) {
-      rowLength *= metaData->rawDims[dimIdx];
+    for (size_t dimIdx = 1; dimIdx < outDims.size(); ++dimIdx) {
+      rowLength *= outDims[dimIdx];
     }
 
     // need to preserve one spot for the MissingValue even if there is no data
@@ -160,10 +275,9 @@ namespace bufr {
 
     // Allocate the output data
     auto totalRows = frames_.size();
-    auto data      = details::ResultData();
-    data.buffer.isLongStr(metaData->typeInfo.isLongString());
-    data.buffer.resize(totalRows * rowLength);
-    data.dims     = metaData->dims;
+    auto data      = details::ResultData<T>();
+    data.buffer.resize(totalRows * rowLength, DataObject<T>::missingValue());
+    data.dims     = filtered ? metaData->filteredDims : metaData->dims;
     data.rawDims  = metaData->rawDims;
     data.dimPaths = metaData->dimPaths;
 
@@ -171,9 +285,16 @@ namespace bufr {
     data.dims[0]    = totalRows;
     data.rawDims[0] = totalRows;
 
-    bool needsFiltering = false;
+    // Every frame is copied into the same (filtered) row shape, even frames whose target has
+    // no filters of its own.
+    auto outRawDims = filtered ? metaData->filteredRawDims : data.rawDims;
+    outRawDims[0]   = totalRows;
+
+    const auto rawLayout = makeCopyLayout(data.rawDims, outRawDims, nullptr);
+    auto filteredLayout = details::CopyLayout();
+    const Target* filteredTarget = nullptr;
 
-    // Copy the data fragments into the raw data array.
+    // Copy the data fragments into the output data array.
     for (size_t frameIdx = 0; frameIdx < frames_.size(); ++frameIdx) {
       if (metaData->missingFrames[frameIdx]) {
         continue;
@@ -181,98 +302,216 @@ namespace bufr {
 
       const auto& frame  = frames_[frameIdx];
       const auto& target = frame.targetAtIdx(metaData->targetIdx);
-      copyData(data, frame, target, frameIdx * rowLength);
 
-      if (target->usesFilters) needsFiltering = true;
-    }
+      if (target->usesFilters) {
+        // Frames typically share targets so only rebuild the layout when the target changes.
+        if (target.get() != filteredTarget) {
+          filteredLayout = makeCopyLayout(data.rawDims, outRawDims, target);
+          filteredTarget = target.get();
+        }
 
-    if (needsFiltering) {
-      int filteredRowLength = 1;
-      for (size_t dimIdx = 1; dimIdx < metaData->filteredDims.size(); ++dimIdx) {
-        filteredRowLength *= metaData->filteredDims[dimIdx];
+        copyData(data, frame, target, filteredLayout, frameIdx * rowLength);
+      } else {
+        copyData(data, frame, target, rawLayout, frameIdx * rowLength);
       }
+    }
+
+    return data;
+  }
+
+  template<typename T>
+  std::shared_ptr<RaggedDataObjectBase> ResultSetImpl::assembleRaggedData(
+                                          const details::TargetMetaDataPtr& metaData) const {
+    const bool filtered = needsFiltering(metaData);
+    const auto& outDims = filtered ? metaData->filteredDims : metaData->rawDims;
+
+    int rowLength = 1;
+    for (size_t dimIdx = 1; dimIdx < outDims.size(); ++dimIdx) {
+      rowLength *= outDims[dimIdx];
+    }
+
+    rowLength = std::max(rowLength, 1);
 
-      auto filteredData = details::ResultData();
-      filteredData.buffer.isLongStr(metaData->typeInfo.isLongString());
-      filteredData.buffer.resize(totalRows * filteredRowLength);
+    // Assemble one (padded) row at a time and keep only the part of it that was written to.
+    auto rowData = details::ResultData<T>();
+    rowData.buffer.resize(rowLength, DataObject<T>::missingValue());
+    rowData.rawDims    = metaData->rawDims;
+    rowData.rawDims[0] = 1;
 
-      for (size_t frameIdx = 0; frameIdx < frames_.size(); ++frameIdx) {
+    auto outRawDims = filtered ? metaData->filteredRawDims : rowData.rawDims;
+    outRawDims[0]   = 1;
+
+    const auto rawLayout = makeCopyLayout(rowData.rawDims, outRawDims, nullptr);
+    auto filteredLayout = details::CopyLayout();
+    const Target* filteredTarget = nullptr;
+
+    std::vector<T> values;
+    std::vector<size_t> rowOffsets;
+    rowOffsets.reserve(frames_.size() + 1);
+    rowOffsets.push_back(0);
+
+    for (size_t frameIdx = 0; frameIdx < frames_.size(); ++frameIdx) {
+      std::fill(rowData.buffer.begin(),
+                rowData.buffer.begin() + std::max<size_t>(rowData.extent, 1),
+                DataObject<T>::missingValue());
+      rowData.extent = 0;
+
+      if (!metaData->missingFrames[frameIdx]) {
         const auto& frame  = frames_[frameIdx];
         const auto& target = frame.targetAtIdx(metaData->targetIdx);
 
-        size_t inputOffset  = frameIdx * rowLength;
-        size_t outputOffset = frameIdx * filteredRowLength;
-        size_t maxDepth     = target->path.size() - 1;
+        if (target->usesFilters) {
+          if (target.get() != filteredTarget) {
+            filteredLayout = makeCopyLayout(rowData.rawDims, outRawDims, target);
+            filteredTarget = target.get();
+          }
 
-        copyFilteredData(filteredData, data, target, inputOffset, outputOffset, 1, maxDepth,
-                         target->filterDataList, false);
+          copyData(rowData, frame, target, filteredLayout, 0);
+        } else {
+          copyData(rowData, frame, target, rawLayout, 0);
+        }
       }
 
-      filteredData.dimPaths = metaData->dimPaths;
-      filteredData.dims     = metaData->filteredDims;
-      filteredData.dims[0]  = data.dims[0];
+      // Fields without a repeated dimension always have exactly one value per row.
+      const size_t numValues = (metaData->dims.size() > 1) ? rowData.extent : 1;
+      values.insert(values.end(), rowData.buffer.begin(), rowData.buffer.begin() + numValues);
+      rowOffsets.push_back(values.size());
+    }
+
+    auto object = std::make_shared<RaggedDataObject<T>>();
+    object->setData(std::move(values), std::move(rowOffsets));
+    object->setDimPaths(metaData->dimPaths);
 
-      data = std::move(filteredData);
+    return object;
+  }
+
+  bool ResultSetImpl::needsFiltering(const details::TargetMetaDataPtr& metaData) const {
+    for (size_t frameIdx = 0; frameIdx < frames_.size(); ++frameIdx) {
+      if (!metaData->missingFrames[frameIdx]
+          && frames_[frameIdx].targetAtIdx(metaData->targetIdx)->usesFilters) {
+        return true;
+      }
     }
 
-    return data;
+    return false;
+  }
+
+  details::CopyLayout ResultSetImpl::makeCopyLayout(const std::vector<int>& rawDims,
+                                                    const std::vector<int>& outDims,
+                                                    const TargetPtr& target) const {
+    auto layout = details::CopyLayout();
+    layout.strides.resize(rawDims.size());
+    layout.selections.resize(rawDims.size());
+
+    for (size_t dimIdx = 1; dimIdx < rawDims.size(); ++dimIdx) {
+      const bool hasFilter = target != nullptr && target->usesFilters
+                             && dimIdx < target->filterDataList.size()
+                             && !target->filterDataList[dimIdx].isEmpty;
+
+      auto& selection = layout.selections[dimIdx];
+      if (hasFilter) {
+        // The filter holds sorted 1 based indices into the raw dimension.
+        const auto& filter = target->filterDataList[dimIdx].filter;
+        selection.assign(rawDims[dimIdx], -1);
+
+        size_t filterIdx = 0;
+        int outIdx = 0;
+        for (size_t count = 1;
+             count <= static_cast<size_t>(rawDims[dimIdx]) && filterIdx < filter.size();
+             ++count) {
+          if (filter[filterIdx] == count) {
+            selection[count - 1] = outIdx++;
+            filterIdx++;
+          }
+        }
+      } else if (outDims[dimIdx] < rawDims[dimIdx]) {
+        // Identity filter (keep the elements that fit in the output dimension).
+        selection.assign(rawDims[dimIdx], -1);
+        for (int idx = 0; idx < outDims[dimIdx]; ++idx) {
+          selection[idx] = idx;
+        }
+      }
+    }
+
+    size_t stride = 1;
+    for (size_t dimIdx = rawDims.size(); dimIdx-- > 0;) {
+      layout.strides[dimIdx] = stride;
+      stride *= outDims[dimIdx];
+    }
+
+    return layout;
   }
 
-  void ResultSetImpl::copyData(details::ResultData& data, const Frame& frame, const TargetPtr& target,
-                           size_t outputOffset) const {
+  template<typename T>
+  void ResultSetImpl::copyData(details::ResultData<T>& data, const Frame& frame,
+                               const TargetPtr& target, const details::CopyLayout& layout,
+                               size_t outputOffset) const {
     size_t inputOffset = 0;
     size_t dimIdx      = 0;
     size_t countNumber = 1;
     size_t countOffset = 0;
 
-    _copyData(data, frame, target, outputOffset, inputOffset, dimIdx, countNumber, countOffset);
+    _copyData(data, frame, target, layout, outputOffset, inputOffset, dimIdx, countNumber,
+              countOffset, false);
   }
 
-  void ResultSetImpl::_copyData(details::ResultData& data, const Frame& frame,
-                            const TargetPtr& target, size_t& outputOffset, size_t& inputOffset,
+  template<typename T>
+  void ResultSetImpl::_copyData(details::ResultData<T>& data, const Frame& frame,
+                            const TargetPtr& target, const details::CopyLayout& layout,
+                            const size_t outputOffset, size_t& inputOffset,
                             const size_t dimIdx, const size_t countNumber,
-                            const size_t countOffset) const {
-    size_t totalDimSize = 1;
-    for (size_t i = dimIdx; i < data.rawDims.size(); ++i) {
-      totalDimSize *= data.rawDims[i];
-    }
-
-    if (!totalDimSize || dimIdx > data.rawDims.size() - 1 || frame[target->nodeIdx].data.empty())
-      return;
+                            const size_t countOffset, const bool skip) const {
+    if (dimIdx > data.rawDims.size() - 1 || frame[target->nodeIdx].data.empty()) return;
 
     const auto& counts = frame[target->path[dimIdx].nodeId].counts;
-    if (counts.empty()) {
-      outputOffset += totalDimSize;
-      return;
-    }
+    if (counts.empty()) return;
 
     size_t newOffset = 0;
     for (size_t countIdx = 0; countIdx < countNumber; ++countIdx) {
       const auto& count = counts[countIdx + countOffset];
-      if (count == 0) {
-        outputOffset += totalDimSize;
-        continue;
+      if (count == 0) continue;
+
+      // Each count belongs to an element of the previous dimension. Work out where that element
+      // lands in the output (or if it was removed by a filter).
+      bool skipElement     = skip;
+      size_t elementOffset = outputOffset;
+      if (dimIdx > 0) {
+        const auto& selection = layout.selections[dimIdx - 1];
+        if (selection.empty()) {
+          elementOffset += countIdx * layout.strides[dimIdx - 1];
+        } else if (countIdx < selection.size() && selection[countIdx] >= 0) {
+          elementOffset += selection[countIdx] * layout.strides[dimIdx - 1];
+        } else {
+          skipElement = true;
+        }
       }
 
       // When we reach the last layer of counts then copy the data
       // Ignore the subset path element (reason for -2)
       if (dimIdx == target->path.size() - 2) {
-        const auto& fragment = frame[target->nodeIdx].data;
+        if (!skipElement) {
+          const auto& fragment  = frame[target->nodeIdx].data;
+          const auto& selection = layout.selections[dimIdx];
 
-        if (fragment.isLongStr()) {
-          std::copy(fragment.value.strings.begin() + inputOffset,
-                    fragment.value.strings.begin() + inputOffset + count,
-                    data.buffer.value.strings.begin() + outputOffset);
-        } else {
-          std::copy(fragment.value.octets.begin() + inputOffset,
-                    fragment.value.octets.begin() + inputOffset + count,
-                    data.buffer.value.octets.begin() + outputOffset);
+          if (selection.empty()) {
+            copyValues(fragment, inputOffset, count, data.buffer.data() + elementOffset);
+            data.extent = std::max(data.extent, elementOffset + count);
+          } else {
+            const auto numSelectable = std::min(static_cast<size_t>(count), selection.size());
+            for (size_t valIdx = 0; valIdx < numSelectable; ++valIdx) {
+              if (selection[valIdx] < 0) continue;
+
+              const auto outIdx = elementOffset + selection[valIdx];
+              copyValues(fragment, inputOffset + valIdx, 1, data.buffer.data() + outIdx);
+              data.extent = std::max(data.extent, outIdx + 1);
+            }
+          }
         }
 
         inputOffset += count;
-        outputOffset += totalDimSize;
       } else {
-        _copyData(data, frame, target, outputOffset, inputOffset, dimIdx + 1, count, newOffset);
+        _copyData(data, frame, target, layout, elementOffset, inputOffset, dimIdx + 1, count,
+                  newOffset, skipElement);
       }
 
       newOffset++;
@@ -299,94 +538,34 @@ namespace bufr {
     }
   }
 
-  void ResultSetImpl::copyFilteredData(details::ResultData& resData,
-                                   const details::ResultData& srcData, const TargetPtr& target,
-                                   size_t& inputOffset, size_t& outputOffset, size_t depth,
-                                   size_t maxDepth, const FilterDataList& filterDataList,
-                                   bool skipResult) const {
-    if (depth == maxDepth) {
-      if (!skipResult) {
-        if (resData.buffer.isLongStr()) {
-          resData.buffer.value.strings[outputOffset] = srcData.buffer.value.strings[inputOffset];
-        } else {
-          resData.buffer.value.octets[outputOffset] = srcData.buffer.value.octets[inputOffset];
-        }
-
-        outputOffset++;
-      }
-
-      inputOffset++;
-
-      return;
-    }
-
-    const auto& filterData = filterDataList[depth];
-
-    if (filterData.isEmpty) {
-      for (size_t count = 1; count <= static_cast<size_t>(srcData.rawDims[depth]); count++) {
-        copyFilteredData(resData, srcData, target, inputOffset, outputOffset, depth + 1, maxDepth,
-                         filterDataList, skipResult);
-      }
-    } else {
-      size_t filterIdx     = 0;
-      auto nextFilterCount = filterData.filter[filterIdx];
-      for (size_t count = 1; count <= static_cast<size_t>(srcData.rawDims[depth]); count++) {
-        bool skip = skipResult;
-        if (!skip) {
-          if (nextFilterCount == count) {
-            filterIdx++;
-            if (filterIdx < filterData.filter.size())
-              nextFilterCount = filterData.filter.at(filterIdx);
-          } else {
-            skip = true;
-          }
-        }
-
-        copyFilteredData(resData, srcData, target, inputOffset, outputOffset, depth + 1, maxDepth,
-                         filterDataList, skip);
-      }
-    }
-  }
-
-  void ResultSetImpl::applyGroupBy(details::ResultData& resData,
+  template<typename T>
+  void ResultSetImpl::applyGroupBy(details::ResultData<T>& resData,
                                const details::TargetMetaDataPtr& targetMetaData,
                                const std::string& groupByFieldName) const {
     const auto groupByMetaData = analyzeTarget(groupByFieldName);
     validateGroupByField(targetMetaData, groupByMetaData);
 
     // If the groupby field has more dims than the target then we must duplicate the
-    // target values to match the groupby field
+    // target values to match the groupby field. Rather than copying the values we record the
+    // repeat factor so the DataObject can represent the duplication as a broadcast view.
     if (groupByMetaData->dims.size() > targetMetaData->dims.size()) {
-      auto newData = details::ResultData();
-      newData.buffer.isLongStr(resData.buffer.isLongStr());
-      newData.dims = {resData.dims[0] * product(groupByMetaData->dims)};
-      newData.buffer.resize(resData.dims[0] * product(groupByMetaData->dims));
-
       const auto numTargetVals = static_cast<size_t>(product(targetMetaData->dims));
+      const auto newDims = std::vector<int>{resData.dims[0] * product(groupByMetaData->dims)};
 
       // There is no data
       if (numTargetVals == 0) {
+        auto newData = details::ResultData<T>();
+        newData.buffer.resize(newDims[0], DataObject<T>::missingValue());
+        newData.dims     = newDims;
         newData.dimPaths = {targetMetaData->dimPaths.back()};
         resData          = std::move(newData);
         return;
       }
 
-      const auto numReps = static_cast<size_t>(product(groupByMetaData->dims) / numTargetVals);
-
-      for (size_t targIdx = 0; targIdx < numTargetVals * resData.dims[0]; targIdx++) {
-        for (size_t rep = 0; rep < numReps; rep++) {
-          if (resData.buffer.isLongStr()) {
-            newData.buffer.value.strings[targIdx * numReps + rep]
-              = resData.buffer.value.strings[targIdx];
-          } else {
-            newData.buffer.value.octets[targIdx * numReps + rep]
-              = resData.buffer.value.octets[targIdx];
-          }
-        }
-      }
-
-      newData.dimPaths = {targetMetaData->dimPaths.back()};
-      resData          = std::move(newData);
+      resData.buffer.resize(numTargetVals * resData.dims[0]);
+      resData.repeats  = static_cast<size_t>(product(groupByMetaData->dims) / numTargetVals);
+      resData.dims     = newDims;
+      resData.dimPaths = {targetMetaData->dimPaths.back()};
     }
     // If the group_by field has less dims than the target data we only need to change the
     // dimensions around.
@@ -413,90 +592,6 @@ namespace bufr {
     return target->typeInfo.unit;
   }
 
-  std::shared_ptr<DataObjectBase> ResultSetImpl::makeDataObject(
-    const std::string& fieldName, const std::string& groupByFieldName, const TypeInfo& info,
-    const std::string& overrideType, const Data& data, const std::vector<int>& dims,
-    const std::vector<Query>& dimPaths) const {
-    std::shared_ptr<DataObjectBase> object;
-    if (overrideType.empty()) {
-      object = objectByTypeInfo(info);
-    } else {
-      object = objectByType(overrideType);
-
-      if ((overrideType == "string" && !info.isString())
-          || (overrideType != "string" && info.isString())) {
-        std::ostringstream errMsg;
-        errMsg << "Conversions between numbers and strings are not currently supported. ";
-        errMsg << "See the export definition for \"" << fieldName << "\".";
-        throw eckit::BadParameter(errMsg.str());
-      }
-    }
-
-    object->setData(data);
-    object->setDims(dims);
-    object->setFieldName(fieldName);
-    object->setGroupByFieldName(groupByFieldName);
-    object->setDimPaths(dimPaths);
-
-    return object;
-  }
-
-  std::shared_ptr<DataObjectBase> ResultSetImpl::objectByTypeInfo(const TypeInfo& info) const {
-    std::shared_ptr<DataObjectBase> object;
-
-    if (info.isString() || info.isLongString()) {
-      object = std::make_shared<DataObject<std::string>>();
-    } else if (info.isInteger()) {
-      if (info.isSigned()) {
-        if (info.is64Bit()) {
-          object = std::make_shared<DataObject<int64_t>>();
-        } else {
-          object = std::make_shared<DataObject<int32_t>>();
-        }
-      } else {
-        if (info.is64Bit()) {
-          object = std::make_shared<DataObject<uint64_t>>();
-        } else {
-          object = std::make_shared<DataObject<uint32_t>>();
-        }
-      }
-    } else {
-      if (info.is64Bit()) {
-        object = std::make_shared<DataObject<double>>();
-      } else {
-        object = std::make_shared<DataObject<float>>();
-      }
-    }
-
-    return object;
-  }
-
-  std::shared_ptr<DataObjectBase> ResultSetImpl::objectByType(const std::string& overrideType) const {
-    std::shared_ptr<DataObjectBase> object;
-
-    if (overrideType == "int" || overrideType == "int32") {
-      object = std::make_shared<DataObject<int32_t>>();
-    } else if (overrideType == "float" || overrideType == "float32") {
-      object = std::make_shared<DataObject<float>>();
-    } else if (overrideType == "double" || overrideType == "float64") {
-      object = std::make_shared<DataObject<double>>();
-    } else if (overrideType == "string") {
-      object = std::make_shared<DataObject<std::string>>();
-    } else if (overrideType == "int64") {
-      object = std::make_shared<DataObject<int64_t>>();
-    } else if (overrideType == "uint64") {
-      object = std::make_shared<DataObject<uint64_t>>();
-    } else if (overrideType == "uint32" || overrideType == "uint") {
-      object = std::make_shared<DataObject<uint32_t>>();
-    } else {
-      std::ostringstream errMsg;
-      errMsg << "Unknown or unsupported type " << overrideType << ".";
-      throw eckit::BadParameter(errMsg.str());
-    }
-
-    return object;
-  }
-
   std::vector<std::string> ResultSetImpl::splitPath(const std::string& path) {
     std::vector<std::string> components;
     std::string::size_type start = 0;
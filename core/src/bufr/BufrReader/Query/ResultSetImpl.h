@@ -12,6 +12,7 @@
 #include "bufr/DataObject.h"
 #include "bufr/Data.h"
 #include "bufr/DataProvider.h"
+#include "bufr/RaggedDataObject.h"
 #include "SubsetLookupTable.h"
 #include "Target.h"
 
@@ -27,17 +28,33 @@ namespace details
         std::vector<int> dims = {0};
         std::vector<int> rawDims = {0};
         std::vector<int> filteredDims = {0};
+        std::vector<int> filteredRawDims = {0};  // rawDims with the query path filters applied
         std::vector<int> groupedDims = {};
         std::vector<char> missingFrames;
         std::vector<Query> dimPaths;
     };
 
+    /// \brief The assembled data for a target. The buffer already has the final output type
+    ///        (missing values are mapped to DataObject<T>::missingValue() while copying).
+    template<typename T>
     struct ResultData
     {
-        Data buffer;
+        std::vector<T> buffer;
         std::vector<int> dims;
         std::vector<int> rawDims;
         std::vector<Query> dimPaths;
+        size_t repeats = 1;  // Number of times each buffer value is repeated (group_by)
+        size_t extent = 0;   // One past the largest buffer index written by copyData
+    };
+
+    /// \brief Describes where the elements of a frame are placed in the assembled output. The
+    ///        strides are the output strides for each raw dimension. For dimensions with a query
+    ///        path filter the selection maps each raw index to its output index (-1 if the index
+    ///        is filtered out). Unfiltered dimensions have an empty selection.
+    struct CopyLayout
+    {
+        std::vector<size_t> strides;
+        std::vector<std::vector<int>> selections;
     };
 
     typedef std::shared_ptr<TargetMetaData> TargetMetaDataPtr;
@@ -75,6 +92,15 @@ namespace details
             const std::string& groupByFieldName = "",
             const std::string& overrideType = "") const;
 
+        /// \brief Gets the resulting data for a jagged field as flat values with row offsets
+        ///        (rows are not padded to the largest number of repeats).
+        /// \param fieldName The name of the field to get the data for (can have at most one
+        ///        repeated dimension).
+        /// \param overrideType The name of the override type to convert the data to.
+        /// \return A RaggedDataObject containing the data.
+        std::shared_ptr<RaggedDataObjectBase>
+        getRagged(const std::string& fieldName, const std::string& overrideType = "") const;
+
         friend class QueryRunner;
 
      private:
@@ -86,37 +112,73 @@ namespace details
         details::TargetMetaDataPtr analyzeTarget(const std::string& name) const;
 
         /// \brief Assembles the data fragments for a target into a single ResultData object.
+        /// \tparam T The output type of the data.
         /// \param targetMetaData The metadata for the target to assemble the data for.
         /// \return A ResultData object containing the data.
-        details::ResultData assembleData(const details::TargetMetaDataPtr& targetMetaData) const;
+        template<typename T>
+        details::ResultData<T> assembleData(
+                                    const details::TargetMetaDataPtr& targetMetaData) const;
+
+        /// \brief Assembles the data fragments for a target into flat values and row offsets
+        ///        (one row per frame).
+        /// \tparam T The output type of the data.
+        /// \param targetMetaData The metadata for the target to assemble the data for.
+        /// \return A RaggedDataObject containing the data.
+        template<typename T>
+        std::shared_ptr<RaggedDataObjectBase> assembleRaggedData(
+                                    const details::TargetMetaDataPtr& targetMetaData) const;
+
+        /// \brief Do any of the (non missing) frames use query path filters for the target.
+        /// \param targetMetaData The metadata for the target.
+        bool needsFiltering(const details::TargetMetaDataPtr& targetMetaData) const;
+
+        /// \brief Computes the output layout used to copy the data of a target. Query path filters
+        ///        are applied by the layout so the data only needs to be copied once.
+        /// \param rawDims The raw (unfiltered) dimensions of the result data.
+        /// \param outDims The dimensions of the output for each raw dimension. Elements past
+        ///        the end of a smaller output dimension are dropped (an identity filter), so
+        ///        targets without filters get the same shape as the filtered ones.
+        /// \param target The target to compute the layout for (filters are ignored if null).
+        /// \return A CopyLayout object with the output strides and selections.
+        details::CopyLayout makeCopyLayout(const std::vector<int>& rawDims,
+                                           const std::vector<int>& outDims,
+                                           const TargetPtr& target) const;
 
         /// \brief Copies the data from a frame into a ResultData object.
         /// \param data The ResultData object to copy the data into.
         /// \param frame The frame to copy the data from.
         /// \param target The target to copy the data for.
+        /// \param layout The layout of the output data (strides and filter selections).
         /// \param outputOffset The offset into the ResultData object to copy the data to.
-        void copyData(details::ResultData& data,
+        template<typename T>
+        void copyData(details::ResultData<T>& data,
                       const Frame& frame,
                       const TargetPtr& target,
+                      const details::CopyLayout& layout,
                       size_t outputOffset) const;
 
         /// \brief Copies the data from a frame into a ResultData object.
         /// \param data The ResultData object to copy the data into.
         /// \param frame The frame to copy the data from.
         /// \param target The target to copy the data for.
+        /// \param layout The layout of the output data (strides and filter selections).
         /// \param outputOffset The offset into the ResultData object to copy the data to.
         /// \param inputOffset The offset into the frame to copy the data from.
         /// \param dimIdx The index of the dimension to copy the data for.
         /// \param countNumber The current count
         /// \param countOffset The offset into the count array.
-        void _copyData(details::ResultData& data,
+        /// \param skip Walk the counts without copying (the data was filtered out).
+        template<typename T>
+        void _copyData(details::ResultData<T>& data,
                        const Frame& frame,
                        const TargetPtr& target,
-                       size_t& outputOffset,
+                       const details::CopyLayout& layout,
+                       const size_t outputOffset,
                        size_t& inputOffset,
                        const size_t dimIdx,
                        const size_t countNumber,
-                       const size_t countOffset) const;
+                       const size_t countOffset,
+                       const bool skip) const;
 
         /// \brief Validates that the group_by field is valid for the target. Throws an exception if
         ///        it is not.
@@ -126,32 +188,12 @@ namespace details
                                   const details::TargetMetaDataPtr& groupByMetaData) const;
 
 
-        /// \brief Copies filtered data from a source ResultData object into a destination
-        ///        ResultData object.
-        /// \param resData The ResultData object to copy the data into.
-        /// \param srcData The ResultData object to copy the data from.
-        /// \param target The target to copy the data for.
-        /// \param inputOffset The offset into the source ResultData object to copy the data from.
-        /// \param outputOffset The offset into the destination ResultData object to copy the data
-        ///        to.
-        /// \param depth The depth of the dimension to copy the data for.
-        /// \param filterDataList The list of filter data to apply.
-        /// \param skipResult Whether to skip copying the result data.
-        void copyFilteredData(details::ResultData& resData,
-                              const details::ResultData& srcData,
-                              const TargetPtr& target,
-                              size_t& inputOffset,
-                              size_t& outputOffset,
-                              size_t depth,
-                              size_t maxDepth,
-                              const FilterDataList& filterDataList,
-                              bool skipResult) const;
-
         /// \brief Modify the ResultData object to apply the group_by field.
         /// \param resData The ResultData object to modify.
         /// \param targetMetaData The metadata for the target.
         /// \param groupByFieldName The name of the field to group the data by.
-        void applyGroupBy(details::ResultData& resData,
+        template<typename T>
+        void applyGroupBy(details::ResultData<T>& resData,
                           const details::TargetMetaDataPtr& targetMetaData,
                           const std::string& groupByFieldName) const;
 
@@ -159,35 +201,6 @@ namespace details
         /// \param fieldName The name of the field.
         std::string unit(const std::string& fieldName) const;
 
-        /// \brief Make an appropriate DataObject for the data considering all the META data
-        /// \param fieldName The name of the field to get the data for.
-        /// \param groupByFieldName The name of the field to group the data by.
-        /// \param info The meta data for the element.
-        /// \param overrideType The name of the override type to convert the data to. Possible
-        /// values are int, uint, int32, uint32, int64, uint64, float, double
-        /// \param data The data
-        /// \param dims The dimensioning information
-        /// \param dimPaths The sub-query path strings for each dimension.
-        /// \return A Result DataObject containing the data.
-        std::shared_ptr<DataObjectBase> makeDataObject(
-                                const std::string& fieldName,
-                                const std::string& groupByFieldName,
-                                const TypeInfo& info,
-                                const std::string& overrideType,
-                                const Data& data,
-                                const std::vector<int>& dims,
-                                const std::vector<Query>& dimPaths) const;
-
-        /// \brief Make an appropriate DataObject for data with the TypeInfo
-        /// \param info The meta data for the element.
-        /// \return A Result DataObject containing the data.
-        std::shared_ptr<DataObjectBase> objectByTypeInfo(const TypeInfo& info) const;
-
-        /// \brief Make an appropriate DataObject for data with the override type
-        /// \param overrideType The meta data for the element.
-        /// \return A Result DataObject containing the data.
-        std::shared_ptr<DataObjectBase> objectByType(const std::string& overrideType) const;
-
         /// \brief Utility function that can be used to split a query string into its components.
         /// \param query The query string.
         /// \return A std::string vector to store the components in.
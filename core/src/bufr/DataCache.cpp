@@ -0,0 +1,391 @@
+/*
+* (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+*
+* This software is licensed under the terms of the Apache Licence Version 2.0
+* which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+*/
+
+#include "bufr/DataCache.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace bufr {
+
+  DataCache::DataCache() :
+    memoryBudget_(std::numeric_limits<size_t>::max())
+  {
+    const char* tmpDir = std::getenv("TMPDIR");
+    spillDir_ = (tmpDir != nullptr && *tmpDir != '\0') ? tmpDir : "/tmp";
+  }
+
+  DataCache::~DataCache()
+  {
+    for (const auto& entry : cache_)
+    {
+      if (!entry.second.spillPath.empty())
+      {
+        std::remove(entry.second.spillPath.c_str());
+      }
+    }
+  }
+
+  bool DataCache::has(const std::string& srcPath, const std::string& mapPath)
+  {
+    auto& cache = instance();
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+
+    if (cache.cache_.find(makeKey(srcPath, mapPath)) == cache.cache_.end())
+    {
+      cache.stats_.misses++;
+      return false;
+    }
+
+    cache.stats_.hits++;
+    return true;
+  }
+
+  std::shared_ptr<DataContainer> DataCache::get(const std::string& srcPath,
+                                                const std::string& mapPath)
+  {
+    auto& cache = instance();
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+
+    auto key = makeKey(srcPath, mapPath);
+    auto entryIt = cache.cache_.find(key);
+    if (entryIt == cache.cache_.end())
+    {
+      cache.stats_.misses++;
+      throw eckit::BadParameter("DataCache::get: No cache entry for key " + key);
+    }
+
+    auto& entry = entryIt->second;
+    cache.stats_.hits++;
+    cache.touch(entry);
+
+    if (!entry.data)
+    {
+      cache.reload(entry);
+      cache.evict(key);
+    }
+
+    return entry.data;
+  }
+
+  void DataCache::add(const std::string& srcPath,
+                      const std::string& mapPath,
+                      const std::vector<std::vector<std::string>>& cachedCategories,
+                      std::shared_ptr<DataContainer> data)
+  {
+    auto& cache = instance();
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+
+    auto key = makeKey(srcPath, mapPath);
+    if (cache.cache_.find(key) != cache.cache_.end())
+    {
+      return;
+    }
+
+    auto& entry = cache.cache_[key];
+    entry.data = data;
+    entry.cachedCategories = cachedCategories;
+    entry.bytes = containerBytes(*data);
+    entry.lruPos = cache.lru_.insert(cache.lru_.begin(), key);
+
+    cache.stats_.numEntries++;
+    cache.stats_.memoryBytes += entry.bytes;
+    cache.evict(key);
+  }
+
+  void DataCache::markFinished(const std::string& srcPath,
+                               const std::string& mapPath,
+                               const std::vector<std::string>& category)
+  {
+    auto& cache = instance();
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+
+    auto key = makeKey(srcPath, mapPath);
+    auto entryIt = cache.cache_.find(key);
+    if (entryIt == cache.cache_.end())
+    {
+      throw eckit::BadParameter("DataCache::markFinished: No cache entry for key " + key);
+    }
+
+    auto& entry = entryIt->second;
+    if (std::find(entry.cachedCategories.begin(), entry.cachedCategories.end(), category)
+        == entry.cachedCategories.end())
+    {
+//          log::info() << "DataCache::markFinished called with category that is not cached.";
+      return;
+    }
+
+    entry.finishedCategories.push_back(category);
+
+    if (entry.finishedCategories.size() == entry.cachedCategories.size())
+    {
+      cache.erase(key);
+    }
+  }
+
+  void DataCache::setMemoryBudget(size_t bytes)
+  {
+    auto& cache = instance();
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+
+    cache.memoryBudget_ = bytes;
+    cache.evict("");
+  }
+
+  size_t DataCache::getMemoryBudget()
+  {
+    auto& cache = instance();
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+
+    return cache.memoryBudget_;
+  }
+
+  void DataCache::setSpillDir(const std::string& path)
+  {
+    auto& cache = instance();
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+
+    cache.spillDir_ = path;
+  }
+
+  DataCacheStats DataCache::getStats()
+  {
+    auto& cache = instance();
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+
+    cache.releaseSpilled();
+    return cache.stats_;
+  }
+
+  void DataCache::resetStats()
+  {
+    auto& cache = instance();
+    std::lock_guard<std::mutex> lock(cache.mutex_);
+
+    cache.stats_.hits = 0;
+    cache.stats_.misses = 0;
+    cache.stats_.evictions = 0;
+    cache.stats_.reloads = 0;
+  }
+
+  size_t DataCache::containerBytes(const DataContainer& data)
+  {
+    size_t bytes = 0;
+    for (const auto& category : data.allSubCategories())
+    {
+      for (const auto& fieldName : data.getFieldNames())
+      {
+        if (data.hasKey(fieldName, category))
+        {
+          bytes += data.get(fieldName, category)->packedSize();
+        }
+      }
+    }
+
+    return bytes;
+  }
+
+  void DataCache::touch(CacheEntry& entry)
+  {
+    lru_.splice(lru_.begin(), lru_, entry.lruPos);
+  }
+
+  void DataCache::evict(const Key& keep)
+  {
+    releaseSpilled();
+
+    // Walk from the least recently used end, skipping entries that are already spilled. Spilling
+    // an entry whose data is used outside the cache frees nothing yet, so the walk goes on.
+    auto lruIt = lru_.end();
+    while (stats_.memoryBytes > memoryBudget_ && lruIt != lru_.begin())
+    {
+      --lruIt;
+      if (*lruIt == keep) continue;
+
+      auto& entry = cache_.at(*lruIt);
+      if (entry.data && entry.bytes > 0)
+      {
+        spill(entry);
+      }
+    }
+  }
+
+  void DataCache::spill(CacheEntry& entry)
+  {
+    std::ostringstream pathStr;
+    pathStr << spillDir_ << "/bufr_data_cache_" << getpid() << "_" << numSpillFiles_++ << ".bin";
+    const auto path = pathStr.str();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+      std::ostringstream errStr;
+      errStr << "DataCache: Could not open spill file " << path << ".";
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    // The objects keep their metadata (field names, dim paths, ...) in memory, only their data
+    // goes to the file.
+    auto emptyData = std::make_shared<DataContainer>(entry.data->getCategoryMap());
+    std::vector<SpilledObject> spilledObjects;
+    std::vector<char> buffer;
+    for (const auto& category : entry.data->allSubCategories())
+    {
+      for (const auto& fieldName : entry.data->getFieldNames())
+      {
+        if (!entry.data->hasKey(fieldName, category)) continue;
+
+        auto object = entry.data->get(fieldName, category)->copy();
+
+        SpilledObject spilled;
+        spilled.category = category;
+        spilled.fieldName = fieldName;
+        spilled.dims = object->getDims();
+        spilled.bytes = object->packedSize();
+
+        buffer.resize(spilled.bytes);
+        object->pack(buffer.data());
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+        auto emptyDims = spilled.dims;
+        if (emptyDims.empty()) emptyDims.push_back(0);
+        emptyDims[0] = 0;
+        object->unpack({}, {}, emptyDims);
+
+        emptyData->add(fieldName, object, category);
+        spilledObjects.push_back(std::move(spilled));
+      }
+    }
+
+    file.close();
+    if (!file)
+    {
+      std::remove(path.c_str());
+
+      std::ostringstream errStr;
+      errStr << "DataCache: Could not write spill file " << path << ".";
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    // The memory is only freed once nobody else holds on to the data.
+    entry.spilledDataInUse = entry.data.use_count() > 1;
+    if (entry.spilledDataInUse)
+    {
+      entry.spilledData = entry.data;
+    }
+    else
+    {
+      stats_.memoryBytes -= entry.bytes;
+    }
+
+    entry.data.reset();
+    entry.emptyData = emptyData;
+    entry.spillPath = path;
+    entry.spilledObjects = std::move(spilledObjects);
+
+    stats_.evictions++;
+    stats_.spilledBytes += entry.bytes;
+  }
+
+  void DataCache::reload(CacheEntry& entry)
+  {
+    // Data that is still in use (and still counted as memory) is taken back as it is.
+    if (auto data = entry.spilledData.lock())
+    {
+      entry.data = data;
+      clearSpill(entry);
+      stats_.spilledBytes -= entry.bytes;
+      return;
+    }
+
+    releaseSpilled();
+
+    std::ifstream file(entry.spillPath, std::ios::binary);
+    if (!file)
+    {
+      std::ostringstream errStr;
+      errStr << "DataCache: Could not open spill file " << entry.spillPath << ".";
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    auto data = std::make_shared<DataContainer>(entry.emptyData->getCategoryMap());
+    std::vector<char> buffer;
+    for (const auto& spilled : entry.spilledObjects)
+    {
+      buffer.resize(spilled.bytes);
+      if (!file.read(buffer.data(), static_cast<std::streamsize>(buffer.size())))
+      {
+        std::ostringstream errStr;
+        errStr << "DataCache: Spill file " << entry.spillPath << " is truncated.";
+        throw eckit::BadParameter(errStr.str());
+      }
+
+      auto object = entry.emptyData->get(spilled.fieldName, spilled.category)->copy();
+      object->unpack({buffer.data()}, {spilled.dims}, spilled.dims);
+      data->add(spilled.fieldName, object, spilled.category);
+    }
+
+    file.close();
+
+    entry.data = data;
+    clearSpill(entry);
+
+    stats_.reloads++;
+    stats_.memoryBytes += entry.bytes;
+    stats_.spilledBytes -= entry.bytes;
+  }
+
+  void DataCache::releaseSpilled()
+  {
+    for (auto& keyEntry : cache_)
+    {
+      auto& entry = keyEntry.second;
+      if (entry.spilledDataInUse && entry.spilledData.expired())
+      {
+        entry.spilledDataInUse = false;
+        entry.spilledData.reset();
+        stats_.memoryBytes -= entry.bytes;
+      }
+    }
+  }
+
+  void DataCache::clearSpill(CacheEntry& entry)
+  {
+    std::remove(entry.spillPath.c_str());
+
+    entry.emptyData.reset();
+    entry.spilledData.reset();
+    entry.spilledDataInUse = false;
+    entry.spillPath.clear();
+    entry.spilledObjects.clear();
+  }
+
+  void DataCache::erase(const Key& key)
+  {
+    auto& entry = cache_.at(key);
+    if (entry.data || entry.spilledDataInUse)
+    {
+      stats_.memoryBytes -= entry.bytes;
+    }
+
+    if (!entry.data)
+    {
+      stats_.spilledBytes -= entry.bytes;
+      std::remove(entry.spillPath.c_str());
+    }
+
+    stats_.numEntries--;
+    lru_.erase(entry.lruPos);
+    cache_.erase(key);
+  }
+}  // namespace bufr
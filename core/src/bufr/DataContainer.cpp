@@ -2,13 +2,30 @@
 
 #include "bufr/DataContainer.h"
 
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <ostream>
+#include <typeinfo>
+#include <unordered_map>
+
+#include <mpi.h>
 
 #include "eckit/exception/Exceptions.h"
 
 
 namespace bufr {
+  size_t SubCategoryHash::operator()(const SubCategory& categoryId) const
+  {
+    size_t hash = categoryId.size();
+    for (const auto& category : categoryId)
+    {
+      hash ^= std::hash<std::string>()(category) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    }
+
+    return hash;
+  }
+
   DataContainer::DataContainer() : categoryMap_({}) { makeDataSets(); }
 
   DataContainer::DataContainer(const CategoryMap& categoryMap) : categoryMap_(categoryMap) {
@@ -24,7 +41,7 @@ namespace bufr {
       throw eckit::BadParameter(errorStr.str());
     }
 
-    dataSets_.at(categoryId).insert({fieldName, data});
+    mutableFields(categoryId).insert({fieldName, data});
   }
 
   void DataContainer::set(std::shared_ptr<DataObjectBase> data, const std::string& fieldName,
@@ -39,21 +56,21 @@ namespace bufr {
         throw eckit::BadParameter(errStr.str());
     }
 
-    dataSets_.at(categoryId).at(fieldName) = data;
+    waitForGather();
+    mutableFields(categoryId).at(fieldName) = data;
   }
 
   std::shared_ptr<DataObjectBase> DataContainer::get(const std::string& fieldName,
                                                      const SubCategory& categoryId) const {
-    if (!hasKey(fieldName, categoryId)) {
-      std::ostringstream errStr;
-      errStr << "ERROR: Either field called " << fieldName;
-      errStr << " or category " << makeSubCategoryStr(categoryId);
-      errStr << " does not exist.";
-
-      throw eckit::BadParameter(errStr.str());
-    }
+    const auto& object = findObject(fieldName, categoryId);
+    completeGather(object);
+    return object;
+  }
 
-    return dataSets_.at(categoryId).at(fieldName);
+  std::shared_ptr<const DataObjectBase> DataContainer::getMetadata(
+    const std::string& fieldName, const SubCategory& categoryId) const
+  {
+    return findObject(fieldName, categoryId);
   }
 
   std::vector<std::string> DataContainer::getPaths(const std::string& fieldName,
@@ -71,57 +88,35 @@ namespace bufr {
 
   std::shared_ptr<DataObjectBase> DataContainer::getGroupByObject(
     const std::string& fieldName, const SubCategory& categoryId) const {
-    if (!hasKey(fieldName, categoryId)) {
-      std::ostringstream errStr;
-      errStr << "ERROR: Either field called " << fieldName;
-      errStr << " or category " << makeSubCategoryStr(categoryId);
-      errStr << " does not exist.";
-
-      throw eckit::BadParameter(errStr.str());
-    }
-
-    auto& dataObject             = dataSets_.at(categoryId).at(fieldName);
-    const auto& groupByFieldName = dataObject->getGroupByFieldName();
-
-    std::shared_ptr<DataObjectBase> groupByObject = dataObject;
-    if (!groupByFieldName.empty()) {
-      for (const auto& obj : dataSets_.at(categoryId)) {
-        if (obj.second->getFieldName() == groupByFieldName) {
-          groupByObject = obj.second;
-          break;
-        }
-      }
-    }
-
+    const auto& groupByObject = findGroupByObject(fieldName, categoryId);
+    completeGather(groupByObject);
     return groupByObject;
   }
 
-  bool DataContainer::hasKey(const std::string& fieldName, const SubCategory& categoryId) const {
-    bool hasKey = false;
-    if (dataSets_.find(categoryId) != dataSets_.end()
-        && dataSets_.at(categoryId).find(fieldName) != dataSets_.at(categoryId).end()) {
-      hasKey = true;
-    }
+  std::shared_ptr<const DataObjectBase> DataContainer::getGroupByMetadata(
+    const std::string& fieldName, const SubCategory& categoryId) const
+  {
+    return findGroupByObject(fieldName, categoryId);
+  }
 
-    return hasKey;
+  bool DataContainer::hasKey(const std::string& fieldName, const SubCategory& categoryId) const {
+    const auto* dataSet = findDataSet(categoryId);
+    return dataSet != nullptr && dataSet->fields.find(fieldName) != dataSet->fields.end();
   }
 
   bool DataContainer::hasCategory(const SubCategory& categoryId) const
   {
-    bool hasCat = false;
-    if (dataSets_.find(categoryId) != dataSets_.end())
-    {
-      hasCat = true;
-    }
-
-    return hasCat;
+    return categoryIdxs_.find(categoryId) != categoryIdxs_.end();
   }
 
   std::shared_ptr<DataContainer> DataContainer::getSubContainer(const SubCategory& categoryId) const
   {
     std::shared_ptr<DataContainer> subCategory = nullptr;
-    if (dataSets_.find(categoryId) != dataSets_.end())
+    auto categoryIdx = categoryIdxs_.find(categoryId);
+    if (categoryIdx != categoryIdxs_.end())
     {
+      waitForGather();
+
       auto newCategoryMap = CategoryMap();
       size_t catIdx = 0;
       for (const auto& category : categoryMap_)
@@ -130,11 +125,12 @@ namespace bufr {
         catIdx++;
       }
 
-      subCategory = std::make_shared<DataContainer>(newCategoryMap);
-      for (const auto& field : dataSets_.at(categoryId))
-      {
-        subCategory->add(field.first, field.second, categoryId);
-      }
+      // The view shares our data set (the only one it has).
+      subCategory = std::make_shared<DataContainer>();
+      subCategory->categoryMap_ = std::move(newCategoryMap);
+      subCategory->subCategories_ = {categoryId};
+      subCategory->dataSets_ = {dataSets_[categoryIdx->second]};
+      subCategory->categoryIdxs_ = {{categoryId, 0}};
     }
     else
     {
@@ -149,7 +145,8 @@ namespace bufr {
   }
 
   size_t DataContainer::size(const SubCategory& categoryId) const {
-    if (dataSets_.find(categoryId) == dataSets_.end()) {
+    const auto* dataSet = findDataSet(categoryId);
+    if (dataSet == nullptr) {
       std::ostringstream errStr;
       errStr << "ERROR: Category called " << makeSubCategoryStr(categoryId);
       errStr << " does not exist.";
@@ -157,17 +154,15 @@ namespace bufr {
       throw eckit::BadParameter(errStr.str());
     }
 
-    return dataSets_.at(categoryId).begin()->second->getDims().at(0);
-  }
-
-  std::vector<SubCategory> DataContainer::allSubCategories() const {
-    std::vector<SubCategory> allCategories;
+    if (dataSet->numRows == UnknownRows) {
+      if (dataSet->fields.empty()) return 0;
 
-    for (const auto& dataSetPair : dataSets_) {
-      allCategories.push_back(dataSetPair.first);
+      const auto& object = dataSet->fields.begin()->second;
+      completeGather(object);
+      dataSet->numRows = object->getDims().at(0);
     }
 
-    return allCategories;
+    return dataSet->numRows;
   }
 
   void DataContainer::makeDataSets() {
@@ -184,6 +179,7 @@ namespace bufr {
           }
         };
 
+    std::vector<SubCategory> subCategories;
     size_t numCombos = 1;
     std::vector<size_t> indicies;
     std::vector<size_t> lengths;
@@ -202,11 +198,81 @@ namespace bufr {
           catIdx++;
         }
 
-        dataSets_.insert({subsets, DataSetMap()});
+        subCategories.push_back(std::move(subsets));
         incIdx(indicies, lengths, 0);
       }
     } else {
-      dataSets_.insert({{}, DataSetMap()});
+      subCategories.push_back({});
+    }
+
+    setSubCategories(std::move(subCategories));
+  }
+
+  void DataContainer::setSubCategories(std::vector<SubCategory> subCategories) {
+    std::sort(subCategories.begin(), subCategories.end());
+    subCategories.erase(std::unique(subCategories.begin(), subCategories.end()),
+                        subCategories.end());
+
+    subCategories_ = std::move(subCategories);
+    dataSets_.clear();
+    categoryIdxs_.clear();
+    categoryIdxs_.reserve(subCategories_.size());
+    for (size_t catIdx = 0; catIdx < subCategories_.size(); ++catIdx) {
+      dataSets_.push_back(std::make_shared<DataSet>());
+      categoryIdxs_.insert({subCategories_[catIdx], catIdx});
+    }
+  }
+
+  const DataContainer::DataSet* DataContainer::findDataSet(const SubCategory& categoryId) const {
+    auto categoryIdx = categoryIdxs_.find(categoryId);
+    return categoryIdx == categoryIdxs_.end() ? nullptr : dataSets_[categoryIdx->second].get();
+  }
+
+  const std::shared_ptr<DataObjectBase>& DataContainer::findObject(
+    const std::string& fieldName, const SubCategory& categoryId) const
+  {
+    if (!hasKey(fieldName, categoryId)) {
+      std::ostringstream errStr;
+      errStr << "ERROR: Either field called " << fieldName;
+      errStr << " or category " << makeSubCategoryStr(categoryId);
+      errStr << " does not exist.";
+
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    return findDataSet(categoryId)->fields.at(fieldName);
+  }
+
+  const std::shared_ptr<DataObjectBase>& DataContainer::findGroupByObject(
+    const std::string& fieldName, const SubCategory& categoryId) const
+  {
+    const auto& dataObject       = findObject(fieldName, categoryId);
+    const auto& groupByFieldName = dataObject->getGroupByFieldName();
+    if (!groupByFieldName.empty()) {
+      for (const auto& obj : findDataSet(categoryId)->fields) {
+        if (obj.second->getFieldName() == groupByFieldName) {
+          return obj.second;
+        }
+      }
+    }
+
+    return dataObject;
+  }
+
+
+  DataSetMap& DataContainer::mutableFields(const SubCategory& categoryId) {
+    auto& dataSet = dataSets_[categoryIdxs_.at(categoryId)];
+    if (dataSet.use_count() > 1) {
+      dataSet = std::make_shared<DataSet>(*dataSet);
+    }
+
+    dataSet->numRows = UnknownRows;
+    return dataSet->fields;
+  }
+
+  void DataContainer::resetRowCounts() {
+    for (const auto& dataSet : dataSets_) {
+      dataSet->numRows = UnknownRows;
     }
   }
 
@@ -227,7 +293,9 @@ namespace bufr {
   std::vector<std::string> DataContainer::getFieldNames() const
   {
     std::vector<std::string> fieldNames;
-    for (const auto& field : dataSets_.begin()->second)
+    if (dataSets_.empty()) return fieldNames;
+
+    for (const auto& field : dataSets_.front()->fields)
     {
       fieldNames.push_back(field.first);
     }
@@ -237,16 +305,19 @@ namespace bufr {
 
   void DataContainer::append(const DataContainer& other)
   {
+    waitForGather();
+    other.waitForGather();
+
     bool isEmpty = getFieldNames().empty();
+    if (isEmpty)
+    {
+      categoryMap_ = other.categoryMap_;
+      setSubCategories(other.subCategories_);
+    }
 
+    resetRowCounts();
     for (const auto &subCat: other.allSubCategories())
     {
-      if (isEmpty)
-      {
-        categoryMap_ = other.categoryMap_;
-        dataSets_.insert({subCat, DataSetMap()});
-      }
-
       for (const auto &field: other.getFieldNames())
       {
         if (isEmpty)
@@ -270,28 +341,536 @@ namespace bufr {
     }
   }
 
+  std::shared_ptr<DataContainer> DataContainer::concat(
+    const std::vector<std::shared_ptr<DataContainer>>& containers)
+  {
+    std::vector<std::shared_ptr<DataContainer>> parts;
+    for (const auto& container : containers)
+    {
+      container->waitForGather();
+      if (!container->getFieldNames().empty())
+      {
+        parts.push_back(container);
+      }
+    }
+
+    if (parts.empty())
+    {
+      return std::make_shared<DataContainer>();
+    }
+
+    const auto& first = *parts.front();
+    const auto& subCategories = first.allSubCategories();
+
+    // Check everything before copying anything (the objects are concatenated in parallel,
+    // where errors can't be thrown).
+    for (size_t partIdx = 1; partIdx < parts.size(); ++partIdx)
+    {
+      const auto& part = *parts[partIdx];
+      if (part.categoryMap_ != first.categoryMap_)
+      {
+        std::ostringstream errStr;
+        errStr << "Error: Cannot concatenate DataContainers with different category maps";
+        errStr << " (container " << partIdx << ").";
+        throw eckit::BadParameter(errStr.str());
+      }
+
+      for (const auto& subCat : subCategories)
+      {
+        const auto* dataSet = part.findDataSet(subCat);
+        const auto& firstFields = first.findDataSet(subCat)->fields;
+        if (dataSet == nullptr || dataSet->fields.size() != firstFields.size())
+        {
+          std::ostringstream errStr;
+          errStr << "Error: Cannot concatenate DataContainers with different fields";
+          errStr << " (container " << partIdx << " category \"";
+          errStr << makeSubCategoryStr(subCat) << "\").";
+          throw eckit::BadParameter(errStr.str());
+        }
+
+        for (const auto& field : firstFields)
+        {
+          auto objIt = dataSet->fields.find(field.first);
+          if (objIt == dataSet->fields.end())
+          {
+            std::ostringstream errStr;
+            errStr << "Error: encountered mismatch when combining DataContainers.";
+            errStr << " Field \"" << field.first << "\" category \""
+                   << makeSubCategoryStr(subCat) << "\"";
+            throw eckit::BadParameter(errStr.str());
+          }
+
+          const auto& object = *objIt->second;
+          const auto& firstObject = *field.second;
+          auto dims = object.getDims();
+          auto firstDims = firstObject.getDims();
+          if (!dims.empty()) dims[0] = 0;
+          if (!firstDims.empty()) firstDims[0] = 0;
+
+          if (typeid(object) != typeid(firstObject) || dims != firstDims)
+          {
+            std::ostringstream errStr;
+            errStr << "Error: Cannot concatenate field \"" << field.first << "\" category \"";
+            errStr << makeSubCategoryStr(subCat) << "\" of container " << partIdx;
+            errStr << " (its type or dimensions are different).";
+            throw eckit::BadParameter(errStr.str());
+          }
+        }
+      }
+    }
+
+    // One job per object of the result.
+    std::vector<std::pair<const SubCategory*, std::string>> jobs;
+    for (const auto& subCat : subCategories)
+    {
+      for (const auto& field : first.findDataSet(subCat)->fields)
+      {
+        jobs.push_back({&subCat, field.first});
+      }
+    }
+
+    std::vector<std::shared_ptr<DataObjectBase>> objects(jobs.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t jobIdx = 0; jobIdx < jobs.size(); ++jobIdx)
+    {
+      const auto& subCat = *jobs[jobIdx].first;
+      const auto& fieldName = jobs[jobIdx].second;
+
+      std::vector<std::shared_ptr<DataObjectBase>> partObjects;
+      partObjects.reserve(parts.size());
+      for (const auto& part : parts)
+      {
+        partObjects.push_back(part->findDataSet(subCat)->fields.at(fieldName));
+      }
+
+      auto object = partObjects.front()->copy();
+      object->concat(partObjects);
+      objects[jobIdx] = object;
+    }
+
+    auto result = std::make_shared<DataContainer>();
+    result->categoryMap_ = first.categoryMap_;
+    result->setSubCategories(first.subCategories_);
+    for (size_t jobIdx = 0; jobIdx < jobs.size(); ++jobIdx)
+    {
+      result->add(jobs[jobIdx].second, objects[jobIdx], *jobs[jobIdx].first);
+    }
+
+    return result;
+  }
+
+  namespace {
+    /// \brief Where the data of an object comes from in a packed gather.
+    struct ObjectLayout
+    {
+      /// Dimensions of the object on each rank
+      std::vector<Dimensions> partDims;
+
+      /// Packed size of the object on each rank
+      std::vector<size_t> partBytes;
+
+      /// Dimensions of the gathered object
+      Dimensions dims;
+
+      /// \brief Get the packed size of the gathered object.
+      size_t totalBytes() const
+      {
+        size_t total = 0;
+        for (const auto bytes : partBytes)
+        {
+          total += bytes;
+        }
+
+        return total;
+      }
+    };
+
+    /// \brief Line up the dimensions of the (dense) objects on every rank and share their packed
+    ///        sizes. This takes one allReduce and one allGatherv however many objects there are.
+    /// \param comm MPI communicator to use.
+    /// \param objects The objects (in the same order on every rank).
+    std::vector<ObjectLayout> exchangeLayouts(
+      const eckit::mpi::Comm& comm,
+      const std::vector<std::shared_ptr<DataObjectBase>>& objects)
+    {
+      // Agree on the number of dimensions of every object.
+      std::vector<size_t> numDims(objects.size());
+      for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
+      {
+        numDims[objIdx] = objects[objIdx]->getDims().size();
+      }
+
+      comm.allReduceInPlace(numDims.data(), numDims.size(), eckit::mpi::Operation::MAX);
+
+      // Share the dimensions and packed size of every object (all ranks need them to work out
+      // the global dims and where each rank's data goes).
+      std::vector<size_t> shape;
+      for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
+      {
+        objects[objIdx]->padDims(numDims[objIdx]);
+        for (const auto dim : objects[objIdx]->getDims())
+        {
+          shape.push_back(static_cast<size_t>(dim));
+        }
+
+        shape.push_back(objects[objIdx]->packedSize());
+      }
+
+      const size_t numRanks = comm.size();
+      std::vector<size_t> shapes(shape.size() * numRanks);
+      std::vector<int> shapeCounts(numRanks, static_cast<int>(shape.size()));
+      std::vector<int> shapeDisplacement(numRanks, 0);
+      for (size_t rank = 1; rank < numRanks; ++rank)
+      {
+        shapeDisplacement[rank] = shapeDisplacement[rank - 1] + shapeCounts[rank - 1];
+      }
+
+      comm.allGatherv(shape.begin(), shape.end(), shapes.begin(),
+                      shapeCounts.data(), shapeDisplacement.data());
+
+      std::vector<ObjectLayout> layouts(objects.size());
+      for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
+      {
+        layouts[objIdx].partDims.resize(numRanks);
+        layouts[objIdx].partBytes.resize(numRanks);
+        layouts[objIdx].dims.assign(numDims[objIdx], 0);
+      }
+
+      for (size_t rank = 0; rank < numRanks; ++rank)
+      {
+        size_t shapeIdx = rank * shape.size();
+        for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
+        {
+          auto& layout = layouts[objIdx];
+          auto& rankDims = layout.partDims[rank];
+          for (size_t dimIdx = 0; dimIdx < numDims[objIdx]; ++dimIdx)
+          {
+            rankDims.push_back(static_cast<int>(shapes[shapeIdx++]));
+          }
+
+          layout.dims[0] += rankDims[0];
+          for (size_t dimIdx = 1; dimIdx < rankDims.size(); ++dimIdx)
+          {
+            layout.dims[dimIdx] = std::max(layout.dims[dimIdx], rankDims[dimIdx]);
+          }
+
+          layout.partBytes[rank] = shapes[shapeIdx++];
+        }
+      }
+
+      return layouts;
+    }
+
+    /// \brief Get the receive counts and displacements for gathering packed data.
+    void makeCounts(const std::vector<size_t>& partBytes,
+                    std::vector<int>& sizeArray,
+                    std::vector<int>& displacement)
+    {
+      sizeArray.assign(partBytes.size(), 0);
+      displacement.assign(partBytes.size(), 0);
+      for (size_t rank = 0; rank < partBytes.size(); ++rank)
+      {
+        sizeArray[rank] = static_cast<int>(partBytes[rank]);
+        if (rank > 0) displacement[rank] = displacement[rank - 1] + sizeArray[rank - 1];
+      }
+    }
+
+    /// \brief Can packed data of this size be moved in one MPI message (counts are ints).
+    bool fitsInMessage(size_t numBytes)
+    {
+      return numBytes <= static_cast<size_t>(std::numeric_limits<int>::max());
+    }
+  }  // namespace
+
+  /// \brief The objects of a gather started by gatherAsync that are still being received.
+  struct DataContainer::PendingGather
+  {
+    struct Object
+    {
+      std::shared_ptr<DataObjectBase> object;
+      ObjectLayout layout;
+      MPI_Request request = MPI_REQUEST_NULL;
+      bool isComplete = false;
+
+      // Must stay alive until the request is complete
+      std::vector<char> sendBuffer;
+      std::vector<char> rcvBuffer;
+      std::vector<int> sizeArray;
+      std::vector<int> displacement;
+    };
+
+    bool isRoot = false;
+    std::vector<Object> objects;
+    std::unordered_map<const DataObjectBase*, size_t> objectIdxs;
+
+    ~PendingGather()
+    {
+      // Waiting after MPI_Finalize is undefined (and MPI is done with the buffers by then).
+      int isFinalized = 0;
+      MPI_Finalized(&isFinalized);
+      if (isFinalized) return;
+
+      // Never free buffers MPI is still using.
+      for (auto& obj : objects)
+      {
+        if (!obj.isComplete) MPI_Wait(&obj.request, MPI_STATUS_IGNORE);
+      }
+    }
+
+    /// \brief Wait for the data of an object to arrive and unpack it (on the root rank).
+    void complete(size_t objIdx)
+    {
+      auto& obj = objects[objIdx];
+      if (obj.isComplete) return;
+
+      MPI_Wait(&obj.request, MPI_STATUS_IGNORE);
+      obj.isComplete = true;
+
+      if (isRoot)
+      {
+        std::vector<const char*> parts(obj.displacement.size());
+        for (size_t rank = 0; rank < parts.size(); ++rank)
+        {
+          parts[rank] = obj.rcvBuffer.data() + obj.displacement[rank];
+        }
+
+        obj.object->unpack(parts, obj.layout.partDims, obj.layout.dims);
+      }
+
+      obj.sendBuffer = {};
+      obj.rcvBuffer = {};
+    }
+
+    /// \brief Complete the gather of an object (if it is part of this gather).
+    void complete(const DataObjectBase* object)
+    {
+      const auto objIdx = objectIdxs.find(object);
+      if (objIdx != objectIdxs.end()) complete(objIdx->second);
+    }
+  };
 
   void DataContainer::gather(const eckit::mpi::Comm& comm)
   {
+    gatherObjects(comm, false);
+    resetRowCounts();
+  }
+
+  void DataContainer::allGather(const eckit::mpi::Comm& comm)
+  {
+    gatherObjects(comm, true);
+    resetRowCounts();
+  }
+
+  void DataContainer::gatherAsync(const eckit::mpi::Comm& comm)
+  {
+    waitForGather();
+
+    const auto objects = detachObjects();
+    if (objects.empty()) return;
+
+    const auto layouts = exchangeLayouts(comm, objects);
+    for (const auto& layout : layouts)
+    {
+      // Every rank has the same layouts, so they all make the same choice.
+      if (!fitsInMessage(layout.totalBytes()))
+      {
+        for (const auto& obj : objects)
+        {
+          obj->gather(comm);
+        }
+
+        return;
+      }
+    }
+
+    const MPI_Comm mpiComm = MPI_Comm_f2c(comm.communicator());
+
+    auto pending = std::make_shared<PendingGather>();
+    pending->isRoot = (comm.rank() == 0);
+    pending->objects.resize(objects.size());
+    for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
+    {
+      auto& obj = pending->objects[objIdx];
+      obj.object = objects[objIdx];
+      obj.layout = layouts[objIdx];
+
+      obj.sendBuffer.resize(obj.object->packedSize());
+      obj.object->pack(obj.sendBuffer.data());
+
+      // The gathered dims are known already (for getMetadata), only the data is on its way.
+      if (pending->isRoot) obj.object->setDims(obj.layout.dims);
+
+      makeCounts(obj.layout.partBytes, obj.sizeArray, obj.displacement);
+      if (pending->isRoot) obj.rcvBuffer.resize(obj.layout.totalBytes());
+
+      MPI_Igatherv(obj.sendBuffer.data(), static_cast<int>(obj.sendBuffer.size()), MPI_BYTE,
+                   obj.rcvBuffer.data(), obj.sizeArray.data(), obj.displacement.data(), MPI_BYTE,
+                   0, mpiComm, &obj.request);
+
+      pending->objectIdxs.insert({obj.object.get(), objIdx});
+    }
+
+    pendingGather_ = std::move(pending);
+  }
+
+  void DataContainer::alignDims(const eckit::mpi::Comm& comm)
+  {
+    waitForGather();
+
+    const auto objects = detachObjects();
+    if (objects.empty()) return;
+
+    const auto layouts = exchangeLayouts(comm, objects);
+    for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
+    {
+      const auto& obj = objects[objIdx];
+      const auto& localDims = layouts[objIdx].partDims[comm.rank()];
+
+      auto dims = layouts[objIdx].dims;
+      dims[0] = localDims[0];
+      if (dims == localDims) continue;
+
+      // Re-pad the local data the same way gather would.
+      std::vector<char> packed(obj->packedSize());
+      obj->pack(packed.data());
+      obj->unpack({packed.data()}, {localDims}, dims);
+    }
+  }
+
+  void DataContainer::waitForGather() const
+  {
+    if (!pendingGather_) return;
+
+    for (size_t objIdx = 0; objIdx < pendingGather_->objects.size(); ++objIdx)
+    {
+      pendingGather_->complete(objIdx);
+    }
+
+    pendingGather_.reset();
+  }
+
+  void DataContainer::completeGather(const std::shared_ptr<DataObjectBase>& object) const
+  {
+    if (pendingGather_) pendingGather_->complete(object.get());
+  }
+
+  std::vector<std::shared_ptr<DataObjectBase>> DataContainer::detachObjects()
+  {
+    auto objects = allObjects();
+
+    size_t objIdx = 0;
     for (const auto &subCat: allSubCategories())
     {
+      auto& fields = mutableFields(subCat);
       for (const auto &field: getFieldNames())
       {
-        auto data = get(field, subCat);
-        data->gather(comm);
+        objects[objIdx] = objects[objIdx]->copy();
+        fields.at(field) = objects[objIdx];
+        ++objIdx;
       }
     }
+
+    return objects;
   }
 
-  void DataContainer::allGather(const eckit::mpi::Comm& comm)
+  std::vector<std::shared_ptr<DataObjectBase>> DataContainer::allObjects() const
   {
+    std::vector<std::shared_ptr<DataObjectBase>> objects;
     for (const auto &subCat: allSubCategories())
     {
       for (const auto &field: getFieldNames())
       {
-        auto data = get(field, subCat);
-        data->allGather(comm);
+        objects.push_back(get(field, subCat));
+      }
+    }
+
+    return objects;
+  }
+
+  void DataContainer::gatherObjects(const eckit::mpi::Comm& comm, bool toAllRanks)
+  {
+    waitForGather();
+
+    const auto objects = detachObjects();
+    if (objects.empty()) return;
+
+    const auto layouts = exchangeLayouts(comm, objects);
+
+    const size_t numRanks = comm.size();
+    std::vector<size_t> rankBytes(numRanks, 0);
+    for (const auto& layout : layouts)
+    {
+      for (size_t rank = 0; rank < numRanks; ++rank)
+      {
+        rankBytes[rank] += layout.partBytes[rank];
+      }
+    }
+
+    size_t totalBytes = 0;
+    for (const auto bytes : rankBytes)
+    {
+      totalBytes += bytes;
+    }
+
+    // Data that does not fit in one message is gathered one object at a time (every rank has
+    // the same layouts, so they all make the same choice).
+    if (!fitsInMessage(totalBytes))
+    {
+      for (const auto& obj : objects)
+      {
+        if (toAllRanks)
+        {
+          obj->allGather(comm);
+        }
+        else
+        {
+          obj->gather(comm);
+        }
+      }
+
+      return;
+    }
+
+    std::vector<char> sendBuffer(rankBytes[comm.rank()]);
+    size_t offset = 0;
+    for (const auto& obj : objects)
+    {
+      obj->pack(sendBuffer.data() + offset);
+      offset += obj->packedSize();
+    }
+
+    std::vector<int> sizeArray;
+    std::vector<int> displacement;
+    makeCounts(rankBytes, sizeArray, displacement);
+
+    std::vector<char> rcvBuffer;
+    if (toAllRanks)
+    {
+      rcvBuffer.resize(totalBytes);
+      comm.allGatherv(sendBuffer.begin(), sendBuffer.end(), rcvBuffer.begin(),
+                      sizeArray.data(), displacement.data());
+    }
+    else
+    {
+      if (comm.rank() == 0) rcvBuffer.resize(totalBytes);
+      comm.gatherv(sendBuffer, rcvBuffer, sizeArray, displacement, 0);
+
+      if (comm.rank() != 0) return;
+    }
+
+    // Unpack each object from the part of every rank's data that belongs to it.
+    std::vector<size_t> rankOffsets(displacement.begin(), displacement.end());
+    for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
+    {
+      std::vector<const char*> parts(numRanks);
+      for (size_t rank = 0; rank < numRanks; ++rank)
+      {
+        parts[rank] = rcvBuffer.data() + rankOffsets[rank];
+        rankOffsets[rank] += layouts[objIdx].partBytes[rank];
       }
+
+      objects[objIdx]->unpack(parts, layouts[objIdx].partDims, layouts[objIdx].dims);
     }
   }
 }  // namespace bufr
@@ -3,6 +3,11 @@
 #include "bufr/DataObject.h"
 #include "bufr/Data.h"
 
+#include <algorithm>
+#include <sstream>
+
+#include "eckit/exception/Exceptions.h"
+
 namespace bufr {
 
   bool DataObjectBase::hasSamePath(const std::shared_ptr<DataObjectBase>& dataObject)
@@ -50,4 +55,179 @@ namespace bufr {
   {
     dimPaths_ = dimPaths;
   }
+
+  void DataObjectBase::setRepeats(size_t repeats)
+  {
+    if (repeats == 0)
+    {
+      throw eckit::BadParameter("DataObject repeat factor must be at least 1.");
+    }
+
+    repeats_ = repeats;
+  }
+
+  void DataObjectBase::padDims(size_t numDims)
+  {
+    if (dims_.empty())
+    {
+      dims_.push_back(static_cast<int>(size()));
+    }
+
+    while (dims_.size() < numDims)
+    {
+      dims_.insert(dims_.end() - 1, 1);
+    }
+  }
+
+  std::shared_ptr<const std::vector<size_t>>
+  DataObjectBase::composeRows(const std::vector<size_t>& rows) const
+  {
+    if (!isView())
+    {
+      return std::make_shared<const std::vector<size_t>>(rows);
+    }
+
+    auto composed = std::make_shared<std::vector<size_t>>(rows.size());
+    for (size_t idx = 0; idx < rows.size(); ++idx)
+    {
+      (*composed)[idx] = (*rowSelection_)[rows[idx]];
+    }
+
+    return composed;
+  }
+
+  std::shared_ptr<DataObjectBase> DataObjectBase::sliceByMask(const ValidityBitmap& rowMask) const
+  {
+    if (dims_.empty() || rowMask.size() != static_cast<size_t>(dims_[0]))
+    {
+      std::ostringstream errStr;
+      errStr << "Row mask for " << fieldName_ << " does not match the number of rows.";
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    std::vector<size_t> rows;
+    rows.reserve(rowMask.countValid());
+    rowMask.forEachValidRun([&rows](size_t begin, size_t end)
+    {
+      for (size_t row = begin; row < end; ++row)
+      {
+        rows.push_back(row);
+      }
+    });
+
+    return slice(rows);
+  }
+
+  const ValidityBitmap& DataObjectBase::getValidity() const
+  {
+    if (!validity_)
+    {
+      validity_ = std::make_shared<const ValidityBitmap>(computeValidity());
+    }
+
+    return *validity_;
+  }
+
+  ValidityBitmap DataObjectBase::getExpandedValidity() const
+  {
+    return isBroadcast() ? getValidity().repeat(repeats_) : getValidity();
+  }
+
+  void DataObjectBase::setValidity(ValidityBitmap validity)
+  {
+    if (validity.size() * repeats_ != size())
+    {
+      std::ostringstream errStr;
+      errStr << "Validity bitmap for " << fieldName_ << " has the wrong size.";
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    validity_ = std::make_shared<const ValidityBitmap>(std::move(validity));
+  }
+
+  void DataObjectBase::expandValidity()
+  {
+    if (validity_ && isBroadcast())
+    {
+      validity_ = std::make_shared<const ValidityBitmap>(validity_->repeat(repeats_));
+    }
+  }
+
+  void DataObjectBase::appendValidity(const DataObjectBase& other)
+  {
+    if (!validity_ || !other.validity_)
+    {
+      resetValidity();
+      return;
+    }
+
+    auto validity = std::make_shared<ValidityBitmap>(*validity_);
+    if (other.repeats_ == repeats_)
+    {
+      validity->append(*other.validity_);
+    }
+    else
+    {
+      validity->append(other.validity_->repeat(other.repeats_));
+    }
+
+    validity_ = std::move(validity);
+  }
+
+  Dimensions DataObjectBase::concatDims(
+    const std::vector<std::shared_ptr<DataObjectBase>>& objects) const
+  {
+    auto dims = objects.empty() ? dims_ : objects.front()->dims_;
+    if (dims.empty()) return dims;
+
+    dims[0] = 0;
+    for (const auto& object : objects)
+    {
+      const auto& objDims = object->dims_;
+      if (objDims.size() != dims.size()
+          || !std::equal(objDims.begin() + 1, objDims.end(), dims.begin() + 1))
+      {
+        std::ostringstream errStr;
+        errStr << "Cannot concatenate data with different dimensions (field ";
+        errStr << object->fieldName_ << ").";
+        throw eckit::BadParameter(errStr.str());
+      }
+
+      dims[0] += objDims[0];
+    }
+
+    return dims;
+  }
+
+  void DataObjectBase::concatValidity(
+    const std::vector<std::shared_ptr<DataObjectBase>>& objects)
+  {
+    size_t numValues = 0;
+    for (const auto& object : objects)
+    {
+      if (!object->validity_)
+      {
+        resetValidity();
+        return;
+      }
+
+      numValues += object->validity_->size() * object->repeats_;
+    }
+
+    ValidityBitmap validity;
+    validity.reserve(numValues);
+    for (const auto& object : objects)
+    {
+      if (object->isBroadcast())
+      {
+        validity.append(object->validity_->repeat(object->repeats_));
+      }
+      else
+      {
+        validity.append(*object->validity_);
+      }
+    }
+
+    validity_ = std::make_shared<const ValidityBitmap>(std::move(validity));
+  }
 }  // namespace bufr
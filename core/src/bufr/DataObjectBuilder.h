@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "bufr/DataProvider.h"
@@ -16,6 +17,17 @@ namespace bufr {
   class DataObjectBuilder
   {
   public:
+    /// \brief Used to pass a type to the visitor given to DataObjectBuilder::visitType.
+    template<typename T>
+    struct TypeTag
+    {
+      typedef T type;
+    };
+
+    /// \brief The type returned by a visitor given to DataObjectBuilder::visitType.
+    template<typename Visitor>
+    using VisitResult = decltype(std::declval<Visitor&>()(TypeTag<float>()));
+
     static std::shared_ptr<DataObjectBase> make(const std::string& fieldName,
                                                 const std::string& groupByFieldName,
                                                 const TypeInfo& info,
@@ -24,23 +36,12 @@ namespace bufr {
                                                 const std::vector<int>& dims,
                                                 const std::vector<Query>& dimPaths)
     {
-      std::shared_ptr<DataObjectBase> object = nullptr;
-      if (overrideType.empty())
-      {
-        object = objectByTypeInfo(info);
-      }
-      else
-      {
-        object = objectByType(overrideType);
-
-        if ((overrideType == "string" && !info.isString())
-            || (overrideType != "string" && info.isString())) {
-          std::ostringstream errMsg;
-          errMsg << "Conversions between numbers and strings are not currently supported. ";
-          errMsg << "See the export definition for \"" << fieldName << "\".";
-          throw eckit::BadParameter(errMsg.str());
-        }
-      }
+      auto object = visitType(fieldName, info, overrideType,
+                              [](auto typeTag) -> std::shared_ptr<DataObjectBase>
+                              {
+                                using T = typename decltype(typeTag)::type;
+                                return std::make_shared<DataObject<T>>();
+                              });
 
       object->setData(data);
       object->setDims(dims);
@@ -52,7 +53,7 @@ namespace bufr {
     }
 
     template<typename T>
-    static std::shared_ptr<DataObjectBase>  make(const std::vector<T>& data,
+    static std::shared_ptr<DataObjectBase>  make(std::vector<T> data,
                                                 const std::string& fieldName,
                                                 const std::string& groupByFieldName,
                                                 const std::vector<int>& dims,
@@ -60,7 +61,7 @@ namespace bufr {
                                                 const std::vector<Query>& dimPaths)
     {
       std::shared_ptr<DataObject<T>> object = std::make_shared<DataObject<T>>();
-      object->setData(data);
+      object->setData(std::move(data));
       object->setDims(dims);
       object->setFieldName(fieldName);
       object->setGroupByFieldName(groupByFieldName);
@@ -70,64 +71,89 @@ namespace bufr {
       return object;
     }
 
+    /// \brief Resolves the output type of a field from its TypeInfo (or from the override type
+    ///        if there is one) and calls the visitor with a TypeTag for that type. This lets
+    ///        callers produce data directly in the final type instead of converting it later.
+    /// \param fieldName The name of the field (used for error messages).
+    /// \param info The meta data for the element.
+    /// \param overrideType The name of the override type (can be empty).
+    /// \param visitor Callable taking a TypeTag<T> (must return the same type for every T).
+    /// \return The result of the visitor.
+    template<typename Visitor>
+    static auto visitType(const std::string& fieldName,
+                          const TypeInfo& info,
+                          const std::string& overrideType,
+                          Visitor&& visitor) -> VisitResult<Visitor>
+    {
+      if (overrideType.empty())
+      {
+        return visitByTypeInfo(info, visitor);
+      }
+
+      if ((overrideType == "string" && !info.isString())
+          || (overrideType != "string" && info.isString())) {
+        std::ostringstream errMsg;
+        errMsg << "Conversions between numbers and strings are not currently supported. ";
+        errMsg << "See the export definition for \"" << fieldName << "\".";
+        throw eckit::BadParameter(errMsg.str());
+      }
+
+      return visitByType(overrideType, visitor);
+    }
+
   private:
 
-    static std::shared_ptr<DataObjectBase> objectByTypeInfo(const TypeInfo& info)
+    template<typename Visitor>
+    static auto visitByTypeInfo(const TypeInfo& info, Visitor& visitor) -> VisitResult<Visitor>
     {
-      std::shared_ptr<DataObjectBase> object;
-
       if (info.isString() || info.isLongString()) {
-        object = std::make_shared<DataObject<std::string>>();
+        return visitor(TypeTag<std::string>());
       } else if (info.isInteger()) {
         if (info.isSigned()) {
           if (info.is64Bit()) {
-            object = std::make_shared<DataObject<int64_t>>();
+            return visitor(TypeTag<int64_t>());
           } else {
-            object = std::make_shared<DataObject<int32_t>>();
+            return visitor(TypeTag<int32_t>());
           }
         } else {
           if (info.is64Bit()) {
-            object = std::make_shared<DataObject<uint64_t>>();
+            return visitor(TypeTag<uint64_t>());
           } else {
-            object = std::make_shared<DataObject<uint32_t>>();
+            return visitor(TypeTag<uint32_t>());
           }
         }
       } else {
         if (info.is64Bit()) {
-          object = std::make_shared<DataObject<double>>();
+          return visitor(TypeTag<double>());
         } else {
-          object = std::make_shared<DataObject<float>>();
+          return visitor(TypeTag<float>());
         }
       }
-
-      return object;
     }
 
-    static std::shared_ptr<DataObjectBase> objectByType(const std::string& overrideType)
+    template<typename Visitor>
+    static auto visitByType(const std::string& overrideType,
+                            Visitor& visitor) -> VisitResult<Visitor>
     {
-      std::shared_ptr<DataObjectBase> object;
-
       if (overrideType == "int" || overrideType == "int32") {
-        object = std::make_shared<DataObject<int32_t>>();
+        return visitor(TypeTag<int32_t>());
       } else if (overrideType == "float" || overrideType == "float32") {
-        object = std::make_shared<DataObject<float>>();
+        return visitor(TypeTag<float>());
       } else if (overrideType == "double" || overrideType == "float64") {
-        object = std::make_shared<DataObject<double>>();
+        return visitor(TypeTag<double>());
       } else if (overrideType == "string") {
-        object = std::make_shared<DataObject<std::string>>();
+        return visitor(TypeTag<std::string>());
       } else if (overrideType == "int64") {
-        object = std::make_shared<DataObject<int64_t>>();
+        return visitor(TypeTag<int64_t>());
       } else if (overrideType == "uint64") {
-        object = std::make_shared<DataObject<uint64_t>>();
+        return visitor(TypeTag<uint64_t>());
       } else if (overrideType == "uint32" || overrideType == "uint") {
-        object = std::make_shared<DataObject<uint32_t>>();
-      } else {
-        std::ostringstream errMsg;
-        errMsg << "Unknown or unsupported type " << overrideType << ".";
-        throw eckit::BadParameter(errMsg.str());
+        return visitor(TypeTag<uint32_t>());
       }
 
-      return object;
+      std::ostringstream errMsg;
+      errMsg << "Unknown or unsupported type " << overrideType << ".";
+      throw eckit::BadParameter(errMsg.str());
     }
   };
 
@@ -0,0 +1,247 @@
+/*
+* (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+*
+* This software is licensed under the terms of the Apache Licence Version 2.0
+* which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+*/
+
+#include "bufr/PackedStrings.h"
+
+#include <algorithm>
+
+#include "bufr/TakeRows.h"
+
+namespace bufr {
+
+  template<typename Strings>
+  void PackedStrings::assign(const Strings& strings)
+  {
+    size_t numChars = 0;
+    size_t maxLength = 0;
+    for (const auto& str : strings)
+    {
+      numChars += str.size();
+      maxLength = std::max(maxLength, str.size());
+    }
+
+    if (maxLength > FixedWidth) makeVariableWidth();
+
+    reserve(strings.size(), numChars);
+    for (const auto& str : strings)
+    {
+      push_back(str);
+    }
+  }
+
+  PackedStrings::PackedStrings(const std::vector<std::string>& strings)
+  {
+    assign(strings);
+  }
+
+  PackedStrings::PackedStrings(const std::vector<std::string_view>& strings)
+  {
+    assign(strings);
+  }
+
+  void PackedStrings::reserve(size_t numStrings, size_t numChars)
+  {
+    if (isFixedWidth())
+    {
+      chars_.reserve(chars_.size() + numStrings * SlotSize);
+    }
+    else
+    {
+      chars_.reserve(chars_.size() + numChars + numStrings);
+      offsets_.reserve(offsets_.size() + numStrings);
+    }
+  }
+
+  void PackedStrings::push_back(std::string_view str)
+  {
+    if (isFixedWidth())
+    {
+      // Embedded NULs would be lost by the strnlen in operator[], so those strings need
+      // offsets too.
+      if (str.empty())
+      {
+        chars_.resize(chars_.size() + SlotSize, '\0');
+        ++size_;
+        return;
+      }
+
+      if (str.size() <= FixedWidth && std::memchr(str.data(), '\0', str.size()) == nullptr)
+      {
+        chars_.resize(chars_.size() + SlotSize, '\0');
+        std::memcpy(chars_.data() + size_ * SlotSize, str.data(), str.size());
+        ++size_;
+        return;
+      }
+
+      makeVariableWidth();
+    }
+
+    chars_.insert(chars_.end(), str.begin(), str.end());
+    chars_.push_back('\0');
+    offsets_.push_back(chars_.size());
+    ++size_;
+  }
+
+  void PackedStrings::appendRange(const PackedStrings& other, size_t start, size_t count)
+  {
+    if (&other == this)
+    {
+      const PackedStrings copy = other;
+      appendRange(copy, start, count);
+      return;
+    }
+
+    if (count == 0) return;
+
+    if (isFixedWidth() && other.isFixedWidth())
+    {
+      chars_.insert(chars_.end(),
+                    other.chars_.begin() + start * SlotSize,
+                    other.chars_.begin() + (start + count) * SlotSize);
+      size_ += count;
+      return;
+    }
+
+    if (other.isFixedWidth())
+    {
+      // Slots have to be unpacked one string at a time.
+      for (size_t idx = start; idx < start + count; ++idx)
+      {
+        push_back(other[idx]);
+      }
+
+      return;
+    }
+
+    makeVariableWidth();
+
+    const size_t srcBegin = other.offsets_[start];
+    const size_t srcEnd = other.offsets_[start + count];
+    const size_t shift = chars_.size() - srcBegin;
+
+    chars_.insert(chars_.end(), other.chars_.begin() + srcBegin, other.chars_.begin() + srcEnd);
+
+    for (size_t idx = start + 1; idx <= start + count; ++idx)
+    {
+      offsets_.push_back(other.offsets_[idx] + shift);
+    }
+
+    size_ += count;
+  }
+
+  PackedStrings PackedStrings::take(const std::vector<size_t>& rows, size_t rowLength) const
+  {
+    PackedStrings taken;
+    if (isFixedWidth())
+    {
+      taken.chars_.resize(rows.size() * rowLength * SlotSize);
+      takeRows(chars_.data(), taken.chars_.data(), rows, rowLength * SlotSize);
+      taken.size_ = rows.size() * rowLength;
+      return taken;
+    }
+
+    // Size the output up front, then copy the characters of each run of rows in one go.
+    size_t numChars = 0;
+    for (const auto row : rows)
+    {
+      numChars += offsets_[(row + 1) * rowLength] - offsets_[row * rowLength];
+    }
+
+    taken.size_ = rows.size() * rowLength;
+    taken.chars_.resize(numChars);
+    taken.offsets_.resize(taken.size_ + 1);
+    taken.offsets_[0] = 0;
+
+    size_t dstStr = 0;
+    size_t idx = 0;
+    while (idx < rows.size())
+    {
+      size_t runEnd = idx + 1;
+      while (runEnd < rows.size() && rows[runEnd] == rows[runEnd - 1] + 1)
+      {
+        ++runEnd;
+      }
+
+      const size_t srcStr = rows[idx] * rowLength;
+      const size_t numStrs = (runEnd - idx) * rowLength;
+      const size_t srcBegin = offsets_[srcStr];
+      const size_t dstBegin = taken.offsets_[dstStr];
+
+      std::memcpy(taken.chars_.data() + dstBegin,
+                  chars_.data() + srcBegin,
+                  offsets_[srcStr + numStrs] - srcBegin);
+
+      for (size_t strIdx = 1; strIdx <= numStrs; ++strIdx)
+      {
+        taken.offsets_[dstStr + strIdx] = offsets_[srcStr + strIdx] - srcBegin + dstBegin;
+      }
+
+      dstStr += numStrs;
+      idx = runEnd;
+    }
+
+    return taken;
+  }
+
+  PackedStrings PackedStrings::repeat(size_t repeats) const
+  {
+    PackedStrings repeated;
+    if (!isFixedWidth())
+    {
+      repeated.makeVariableWidth();
+      repeated.reserve(size_ * repeats, (chars_.size() - size_) * repeats);
+    }
+    else
+    {
+      repeated.reserve(size_ * repeats);
+    }
+
+    for (size_t idx = 0; idx < size_; ++idx)
+    {
+      for (size_t rep = 0; rep < repeats; ++rep)
+      {
+        repeated.appendRange(*this, idx, 1);
+      }
+    }
+
+    return repeated;
+  }
+
+  std::vector<std::string> PackedStrings::toVector() const
+  {
+    std::vector<std::string> strings;
+    strings.reserve(size_);
+    for (size_t idx = 0; idx < size_; ++idx)
+    {
+      strings.emplace_back((*this)[idx]);
+    }
+
+    return strings;
+  }
+
+  void PackedStrings::makeVariableWidth()
+  {
+    if (!isFixedWidth()) return;
+
+    std::vector<char> chars;
+    std::vector<size_t> offsets;
+    chars.reserve(chars_.size());
+    offsets.reserve(size_ + 1);
+    offsets.push_back(0);
+
+    for (size_t idx = 0; idx < size_; ++idx)
+    {
+      const auto str = (*this)[idx];
+      chars.insert(chars.end(), str.begin(), str.end());
+      chars.push_back('\0');
+      offsets.push_back(chars.size());
+    }
+
+    chars_ = std::move(chars);
+    offsets_ = std::move(offsets);
+  }
+}  // namespace bufr
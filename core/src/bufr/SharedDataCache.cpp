@@ -0,0 +1,659 @@
+/*
+* (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+*
+* This software is licensed under the terms of the Apache Licence Version 2.0
+* which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+*/
+
+#include "bufr/SharedDataCache.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "bufr/QueryParser.h"
+
+namespace bufr {
+  namespace {
+    constexpr uint64_t Magic = 0x4255465251434348;  // "BUFRQCCH"
+
+    /// How long to wait between looks at an entry another process is making.
+    constexpr auto PollInterval = std::chrono::milliseconds(10);
+
+    /// How long an entry may go without a header before the process making it is presumed dead.
+    constexpr auto HeaderTimeout = std::chrono::seconds(10);
+
+    /// Alignment of the packed values in the data segment (so the columns can be used in place).
+    constexpr size_t ValueAlignment = alignof(std::max_align_t);
+
+    enum class EntryState : uint32_t
+    {
+      Making = 0,
+      Ready = 1,
+      Failed = 2
+    };
+
+    /// \brief The header segment of an entry. The maker creates it (zero filled, so the state
+    ///        starts out as Making), and the data goes in a second segment once its size is
+    ///        known.
+    struct EntryHeader
+    {
+      std::atomic<uint64_t> magic;
+      std::atomic<uint32_t> state;
+      std::atomic<int64_t> makerPid;
+      std::atomic<uint64_t> dataBytes;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free &&
+                  std::atomic<int64_t>::is_always_lock_free,
+                  "Shared memory entries need lock free atomics.");
+
+    /// \brief An object of a container along with where it goes.
+    struct SharedObject
+    {
+      SubCategory category;
+      std::string fieldName;
+      std::shared_ptr<DataObjectBase> object;
+    };
+
+    /// \brief Memory mapping that is unmapped when it goes out of scope (for the data segment,
+    ///        when the last column that points into it goes away).
+    class Mapping
+    {
+      public:
+        Mapping(int fd, size_t size, bool writable) :
+          size_(size)
+        {
+          ptr_ = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+                      fd, 0);
+          if (ptr_ == MAP_FAILED)
+          {
+            std::ostringstream errStr;
+            errStr << "SharedDataCache: Could not map shared memory (" << std::strerror(errno);
+            errStr << ").";
+            throw eckit::BadParameter(errStr.str());
+          }
+        }
+
+        ~Mapping() { munmap(ptr_, size_); }
+
+        Mapping(const Mapping&) = delete;
+        Mapping& operator=(const Mapping&) = delete;
+
+        char* data() const { return static_cast<char*>(ptr_); }
+
+      private:
+        void* ptr_;
+        size_t size_;
+    };
+
+    /// \brief Writes an entry into a buffer, or just counts its size if there is no buffer.
+    class PackedWriter
+    {
+      public:
+        explicit PackedWriter(char* buffer = nullptr) : buffer_(buffer) {}
+
+        /// \brief Make room for some bytes (returns nullptr when only counting).
+        char* reserve(size_t bytes)
+        {
+          char* dst = buffer_ ? buffer_ + offset_ : nullptr;
+          offset_ += bytes;
+          return dst;
+        }
+
+        /// \brief Skip to the next multiple of an alignment.
+        void align(size_t alignment)
+        {
+          offset_ = (offset_ + alignment - 1) / alignment * alignment;
+        }
+
+        template<typename T>
+        void writeValue(T value)
+        {
+          if (auto dst = reserve(sizeof(T))) std::memcpy(dst, &value, sizeof(T));
+        }
+
+        void writeString(const std::string& str)
+        {
+          writeValue<uint64_t>(str.size());
+          if (auto dst = reserve(str.size())) std::memcpy(dst, str.data(), str.size());
+        }
+
+        void writeStrings(const std::vector<std::string>& strs)
+        {
+          writeValue<uint64_t>(strs.size());
+          for (const auto& str : strs)
+          {
+            writeString(str);
+          }
+        }
+
+        size_t size() const { return offset_; }
+
+      private:
+        char* buffer_;
+        size_t offset_ = 0;
+    };
+
+    /// \brief Reads an entry from a buffer.
+    class PackedReader
+    {
+      public:
+        PackedReader(const char* buffer, size_t size) : buffer_(buffer), size_(size) {}
+
+        const char* readBytes(size_t bytes)
+        {
+          if (bytes > size_ - offset_)
+          {
+            throw eckit::BadParameter("SharedDataCache: Shared memory entry is truncated.");
+          }
+
+          const char* src = buffer_ + offset_;
+          offset_ += bytes;
+          return src;
+        }
+
+        /// \brief Skip to the next multiple of an alignment.
+        void align(size_t alignment)
+        {
+          offset_ = std::min((offset_ + alignment - 1) / alignment * alignment, size_);
+        }
+
+        template<typename T>
+        T readValue()
+        {
+          T value;
+          std::memcpy(&value, readBytes(sizeof(T)), sizeof(T));
+          return value;
+        }
+
+        std::string readString()
+        {
+          const auto length = readValue<uint64_t>();
+          return std::string(readBytes(length), length);
+        }
+
+        std::vector<std::string> readStrings()
+        {
+          std::vector<std::string> strs(readValue<uint64_t>());
+          for (auto& str : strs)
+          {
+            str = readString();
+          }
+
+          return strs;
+        }
+
+      private:
+        const char* buffer_;
+        size_t size_;
+        size_t offset_ = 0;
+    };
+
+    [[noreturn]] void throwSystemError(const std::string& action, const std::string& name)
+    {
+      std::ostringstream errStr;
+      errStr << "SharedDataCache: Could not " << action << " " << name << " (";
+      errStr << std::strerror(errno) << ").";
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    /// \brief 64 bit FNV-1a hash (the same in every process, unlike std::hash).
+    uint64_t hashBytes(const char* bytes, size_t size, uint64_t hash = 0xcbf29ce484222325)
+    {
+      for (size_t idx = 0; idx < size; ++idx)
+      {
+        hash ^= static_cast<unsigned char>(bytes[idx]);
+        hash *= 0x100000001b3;
+      }
+
+      return hash;
+    }
+
+    template<typename T>
+    uint64_t hashValue(T value, uint64_t hash)
+    {
+      return hashBytes(reinterpret_cast<const char*>(&value), sizeof(T), hash);
+    }
+
+    /// \brief Make the shared memory name of an entry from the identity of the source file and
+    ///        the contents of the mapping file.
+    std::string makeName(const std::string& srcPath, const std::string& mapPath)
+    {
+      struct stat srcStat;
+      if (stat(srcPath.c_str(), &srcStat) != 0) throwSystemError("stat", srcPath);
+
+      std::ifstream mapFile(mapPath, std::ios::binary);
+      if (!mapFile)
+      {
+        std::ostringstream errStr;
+        errStr << "SharedDataCache: Could not read the mapping file " << mapPath << ".";
+        throw eckit::BadParameter(errStr.str());
+      }
+
+      const std::string mapping((std::istreambuf_iterator<char>(mapFile)),
+                                std::istreambuf_iterator<char>());
+
+      auto hash = hashBytes(mapping.data(), mapping.size());
+      hash = hashValue(static_cast<uint64_t>(srcStat.st_dev), hash);
+      hash = hashValue(static_cast<uint64_t>(srcStat.st_ino), hash);
+      hash = hashValue(static_cast<uint64_t>(srcStat.st_size), hash);
+      hash = hashValue(static_cast<int64_t>(srcStat.st_mtime), hash);
+
+      char name[32];
+      std::snprintf(name, sizeof(name), "/bufr_query_%016llx",
+                    static_cast<unsigned long long>(hash));
+      return name;
+    }
+
+    std::string dataName(const std::string& name)
+    {
+      return name + "_data";
+    }
+
+    void removeEntry(const std::string& name)
+    {
+      shm_unlink(name.c_str());
+      shm_unlink(dataName(name).c_str());
+    }
+
+    bool isAlive(int64_t pid)
+    {
+      return kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH;
+    }
+
+    std::string typeName(const std::shared_ptr<DataObjectBase>& object)
+    {
+      if (std::dynamic_pointer_cast<DataObject<int32_t>>(object)) return "int32";
+      if (std::dynamic_pointer_cast<DataObject<int64_t>>(object)) return "int64";
+      if (std::dynamic_pointer_cast<DataObject<uint32_t>>(object)) return "uint32";
+      if (std::dynamic_pointer_cast<DataObject<uint64_t>>(object)) return "uint64";
+      if (std::dynamic_pointer_cast<DataObject<float>>(object)) return "float";
+      if (std::dynamic_pointer_cast<DataObject<double>>(object)) return "double";
+      if (std::dynamic_pointer_cast<DataObject<std::string>>(object)) return "string";
+
+      std::ostringstream errStr;
+      errStr << "SharedDataCache: Unsupported type for field " << object->getFieldName() << ".";
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    std::shared_ptr<DataObjectBase> makeObject(const std::string& typeName)
+    {
+      if (typeName == "int32") return std::make_shared<DataObject<int32_t>>();
+      if (typeName == "int64") return std::make_shared<DataObject<int64_t>>();
+      if (typeName == "uint32") return std::make_shared<DataObject<uint32_t>>();
+      if (typeName == "uint64") return std::make_shared<DataObject<uint64_t>>();
+      if (typeName == "float") return std::make_shared<DataObject<float>>();
+      if (typeName == "double") return std::make_shared<DataObject<double>>();
+      if (typeName == "string") return std::make_shared<DataObject<std::string>>();
+
+      std::ostringstream errStr;
+      errStr << "SharedDataCache: Unknown type " << typeName << " in shared memory entry.";
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    /// \brief Get the objects of a container.
+    std::vector<SharedObject> collectObjects(const DataContainer& data)
+    {
+      std::vector<SharedObject> objects;
+      for (const auto& category : data.allSubCategories())
+      {
+        for (const auto& fieldName : data.getFieldNames())
+        {
+          if (!data.hasKey(fieldName, category)) continue;
+
+          objects.push_back({category, fieldName, data.get(fieldName, category)});
+        }
+      }
+
+      return objects;
+    }
+
+    /// \brief Write the category map and the objects (metadata then packed data) of a container.
+    void writeContainer(PackedWriter& writer,
+                        const CategoryMap& categoryMap,
+                        const std::vector<SharedObject>& objects)
+    {
+      writer.writeValue<uint64_t>(categoryMap.size());
+      for (const auto& category : categoryMap)
+      {
+        writer.writeString(category.first);
+        writer.writeStrings(category.second);
+      }
+
+      writer.writeValue<uint64_t>(objects.size());
+      for (const auto& shared : objects)
+      {
+        const auto& object = shared.object;
+        writer.writeStrings(shared.category);
+        writer.writeString(shared.fieldName);
+        writer.writeString(typeName(object));
+        writer.writeString(object->getGroupByFieldName());
+        writer.writeString(object->getPath());
+
+        const auto dimPaths = object->getDimPaths();
+        writer.writeValue<uint64_t>(dimPaths.size());
+        for (const auto& dimPath : dimPaths)
+        {
+          writer.writeString(dimPath.str());
+        }
+
+        const auto dims = object->getDims();
+        writer.writeValue<uint64_t>(dims.size());
+        for (const auto dim : dims)
+        {
+          writer.writeValue<int32_t>(dim);
+        }
+
+        const auto bytes = object->packedSize();
+        writer.writeValue<uint64_t>(bytes);
+        writer.align(ValueAlignment);
+        if (auto dst = writer.reserve(bytes)) object->pack(dst);
+      }
+    }
+
+    /// \brief Point a numeric object at its packed values in the mapped data segment (no
+    ///        copy). The values keep the mapping alive.
+    /// \return false if the object isn't of type T.
+    template<typename T>
+    bool useMappedValues(const std::shared_ptr<DataObjectBase>& object,
+                         const std::shared_ptr<const Mapping>& mapping,
+                         const char* bytes,
+                         size_t numBytes)
+    {
+      auto typedObject = std::dynamic_pointer_cast<DataObject<T>>(object);
+      if (!typedObject) return false;
+
+      typedObject->setExternalData(
+        std::shared_ptr<const T>(mapping, reinterpret_cast<const T*>(bytes)),
+        numBytes / sizeof(T));
+
+      return true;
+    }
+
+    /// \brief Read the container from the mapped data segment. The numeric columns point into
+    ///        the mapping, the strings (which are packed differently) are copied out of it.
+    std::shared_ptr<DataContainer> readContainer(PackedReader& reader,
+                                                 const std::shared_ptr<const Mapping>& mapping)
+    {
+      CategoryMap categoryMap;
+      const auto numCategories = reader.readValue<uint64_t>();
+      for (uint64_t catIdx = 0; catIdx < numCategories; ++catIdx)
+      {
+        auto name = reader.readString();
+        categoryMap[name] = reader.readStrings();
+      }
+
+      auto data = std::make_shared<DataContainer>(categoryMap);
+
+      const auto numObjects = reader.readValue<uint64_t>();
+      for (uint64_t objIdx = 0; objIdx < numObjects; ++objIdx)
+      {
+        const auto category = reader.readStrings();
+        const auto fieldName = reader.readString();
+        auto object = makeObject(reader.readString());
+        object->setFieldName(fieldName);
+        object->setGroupByFieldName(reader.readString());
+        object->setQuery(reader.readString());
+
+        std::vector<Query> dimPaths(reader.readValue<uint64_t>());
+        for (auto& dimPath : dimPaths)
+        {
+          dimPath = QueryParser::parse(reader.readString())[0];
+        }
+
+        object->setDimPaths(dimPaths);
+
+        Dimensions dims(reader.readValue<uint64_t>());
+        for (auto& dim : dims)
+        {
+          dim = reader.readValue<int32_t>();
+        }
+
+        const auto numBytes = reader.readValue<uint64_t>();
+        reader.align(ValueAlignment);
+        const char* bytes = reader.readBytes(numBytes);
+        if (useMappedValues<int32_t>(object, mapping, bytes, numBytes) ||
+            useMappedValues<int64_t>(object, mapping, bytes, numBytes) ||
+            useMappedValues<uint32_t>(object, mapping, bytes, numBytes) ||
+            useMappedValues<uint64_t>(object, mapping, bytes, numBytes) ||
+            useMappedValues<float>(object, mapping, bytes, numBytes) ||
+            useMappedValues<double>(object, mapping, bytes, numBytes))
+        {
+          object->setDims(dims);
+        }
+        else
+        {
+          object->unpack({bytes}, {dims}, dims);
+        }
+
+        data->add(fieldName, object, category);
+      }
+
+      return data;
+    }
+
+    /// \brief Write the data into the data segment of an entry and mark the entry ready.
+    void publish(const std::string& name, const DataContainer& data, EntryHeader* header)
+    {
+      const auto objects = collectObjects(data);
+
+      PackedWriter counter;
+      writeContainer(counter, data.getCategoryMap(), objects);
+      const auto bytes = counter.size();
+
+      // A crashed maker can leave its data segment behind.
+      shm_unlink(dataName(name).c_str());
+      const int fd = shm_open(dataName(name).c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+      if (fd < 0) throwSystemError("create", dataName(name));
+
+      if (ftruncate(fd, static_cast<off_t>(std::max<size_t>(bytes, 1))) != 0)
+      {
+        close(fd);
+        throwSystemError("size", dataName(name));
+      }
+
+      {
+        Mapping mapping(fd, std::max<size_t>(bytes, 1), true);
+        close(fd);
+
+        PackedWriter writer(mapping.data());
+        writeContainer(writer, data.getCategoryMap(), objects);
+      }
+
+      header->dataBytes.store(bytes);
+      header->state.store(static_cast<uint32_t>(EntryState::Ready), std::memory_order_release);
+    }
+
+    /// \brief Make the data in this process and publish it (the header segment was just
+    ///        created by this process).
+    std::shared_ptr<DataContainer> makeEntry(
+      const std::string& name,
+      int fd,
+      const std::function<std::shared_ptr<DataContainer>()>& make)
+    {
+      if (ftruncate(fd, sizeof(EntryHeader)) != 0)
+      {
+        close(fd);
+        removeEntry(name);
+        throwSystemError("size", name);
+      }
+
+      Mapping mapping(fd, sizeof(EntryHeader), true);
+      close(fd);
+
+      auto header = reinterpret_cast<EntryHeader*>(mapping.data());
+      header->makerPid.store(static_cast<int64_t>(getpid()));
+      header->magic.store(Magic, std::memory_order_release);
+
+      try
+      {
+        auto data = make();
+        publish(name, *data, header);
+        return data;
+      }
+      catch (...)
+      {
+        // Let the waiting processes know, and leave the entry free for the next one to make.
+        header->state.store(static_cast<uint32_t>(EntryState::Failed));
+        removeEntry(name);
+        throw;
+      }
+    }
+
+    /// \brief Read the data of an entry made by some process, waiting for it to be finished.
+    /// \return The data, or nullptr if there is no entry (or the maker failed or died).
+    std::shared_ptr<DataContainer> readEntry(const std::string& name)
+    {
+      const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+      if (fd < 0)
+      {
+        if (errno == ENOENT) return nullptr;
+        throwSystemError("open", name);
+      }
+
+      // The maker sizes the header right after creating it.
+      const auto startTime = std::chrono::steady_clock::now();
+      struct stat headerStat;
+      while (fstat(fd, &headerStat) == 0 &&
+             static_cast<size_t>(headerStat.st_size) < sizeof(EntryHeader))
+      {
+        if (std::chrono::steady_clock::now() - startTime > HeaderTimeout)
+        {
+          close(fd);
+          removeEntry(name);
+          return nullptr;
+        }
+
+        std::this_thread::sleep_for(PollInterval);
+      }
+
+      Mapping headerMapping(fd, sizeof(EntryHeader), false);
+      close(fd);
+
+      auto header = reinterpret_cast<const EntryHeader*>(headerMapping.data());
+      while (true)
+      {
+        if (header->magic.load(std::memory_order_acquire) != Magic)
+        {
+          if (std::chrono::steady_clock::now() - startTime > HeaderTimeout)
+          {
+            removeEntry(name);
+            return nullptr;
+          }
+        }
+        else
+        {
+          const auto state = static_cast<EntryState>(
+            header->state.load(std::memory_order_acquire));
+
+          if (state == EntryState::Ready) break;
+          if (state == EntryState::Failed) return nullptr;
+
+          // A maker that died would otherwise be waited on forever. (If several processes
+          // notice at once one of them may remove a newer entry, which only costs a re-parse.)
+          if (!isAlive(header->makerPid.load()))
+          {
+            removeEntry(name);
+            return nullptr;
+          }
+        }
+
+        std::this_thread::sleep_for(PollInterval);
+      }
+
+      const int dataFd = shm_open(dataName(name).c_str(), O_RDONLY, 0);
+      if (dataFd < 0)
+      {
+        // The entry was removed after it was finished.
+        if (errno == ENOENT) return nullptr;
+        throwSystemError("open", dataName(name));
+      }
+
+      const auto bytes = header->dataBytes.load();
+      const auto dataMapping = std::make_shared<const Mapping>(dataFd,
+                                                               std::max<size_t>(bytes, 1),
+                                                               false);
+      close(dataFd);
+
+      PackedReader reader(dataMapping->data(), bytes);
+      return readContainer(reader, dataMapping);
+    }
+  }  // namespace
+
+  std::shared_ptr<DataContainer> SharedDataCache::getOrMake(
+    const std::string& srcPath,
+    const std::string& mapPath,
+    const std::function<std::shared_ptr<DataContainer>()>& make)
+  {
+    const auto name = makeName(srcPath, mapPath);
+    while (true)
+    {
+      const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+      if (fd >= 0) return makeEntry(name, fd, make);
+      if (errno != EEXIST) throwSystemError("create", name);
+
+      if (auto data = readEntry(name)) return data;
+    }
+  }
+
+  bool SharedDataCache::has(const std::string& srcPath, const std::string& mapPath)
+  {
+    const auto name = makeName(srcPath, mapPath);
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat headerStat;
+    if (fstat(fd, &headerStat) != 0 ||
+        static_cast<size_t>(headerStat.st_size) < sizeof(EntryHeader))
+    {
+      close(fd);
+      return false;
+    }
+
+    Mapping mapping(fd, sizeof(EntryHeader), false);
+    close(fd);
+
+    auto header = reinterpret_cast<const EntryHeader*>(mapping.data());
+    return header->magic.load(std::memory_order_acquire) == Magic &&
+           header->state.load(std::memory_order_acquire) ==
+             static_cast<uint32_t>(EntryState::Ready);
+  }
+
+  std::shared_ptr<DataContainer> SharedDataCache::get(const std::string& srcPath,
+                                                      const std::string& mapPath)
+  {
+    auto data = readEntry(makeName(srcPath, mapPath));
+    if (!data)
+    {
+      std::ostringstream errStr;
+      errStr << "SharedDataCache::get: No shared cache entry for " << srcPath << " " << mapPath;
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    return data;
+  }
+
+  void SharedDataCache::remove(const std::string& srcPath, const std::string& mapPath)
+  {
+    removeEntry(makeName(srcPath, mapPath));
+  }
+}  // namespace bufr
@@ -0,0 +1,117 @@
+/*
+* (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+*
+* This software is licensed under the terms of the Apache Licence Version 2.0
+* which can be obtained at http://www.apache.org/licenses/LICENSE-2.0.
+*/
+
+#include "bufr/TakeRows.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace bufr {
+  namespace {
+    // Selections smaller than this are not worth starting threads for.
+    constexpr size_t ParallelBytes = 1 << 22;
+
+    // Number of output rows given to a thread at a time.
+    constexpr size_t RowsPerBlock = 1 << 14;
+
+    // Selections with runs shorter than this (on average) are gathered value by value, which
+    // avoids mispredicted branches on the run boundaries.
+    constexpr size_t ShortRun = 16;
+
+    template<typename Word>
+    void gatherRange(const char* src,
+                     char* dst,
+                     const std::vector<size_t>& rows,
+                     size_t begin,
+                     size_t end)
+    {
+      auto srcWords = reinterpret_cast<const Word*>(src);
+      auto dstWords = reinterpret_cast<Word*>(dst);
+      for (size_t idx = begin; idx < end; ++idx)
+      {
+        dstWords[idx] = srcWords[rows[idx]];
+      }
+    }
+
+    void takeRange(const char* src,
+                   char* dst,
+                   const std::vector<size_t>& rows,
+                   size_t rowBytes,
+                   size_t begin,
+                   size_t end)
+    {
+      if ((rowBytes == sizeof(uint32_t) || rowBytes == sizeof(uint64_t)) &&
+          end - begin < ShortRun * countRuns(rows, begin, end))
+      {
+        if (rowBytes == sizeof(uint32_t))
+        {
+          gatherRange<uint32_t>(src, dst, rows, begin, end);
+        }
+        else
+        {
+          gatherRange<uint64_t>(src, dst, rows, begin, end);
+        }
+
+        return;
+      }
+
+      size_t idx = begin;
+      while (idx < end)
+      {
+        size_t runEnd = idx + 1;
+        while (runEnd < end && rows[runEnd] == rows[runEnd - 1] + 1)
+        {
+          ++runEnd;
+        }
+
+        std::memcpy(dst + idx * rowBytes, src + rows[idx] * rowBytes, (runEnd - idx) * rowBytes);
+        idx = runEnd;
+      }
+    }
+  }  // namespace
+
+  void takeRows(const void* src, void* dst, const std::vector<size_t>& rows, size_t rowBytes)
+  {
+    if (rows.empty() || rowBytes == 0) return;
+
+    const auto srcBytes = static_cast<const char*>(src);
+    const auto dstBytes = static_cast<char*>(dst);
+    const size_t numRows = rows.size();
+
+    if (numRows * rowBytes < ParallelBytes)
+    {
+      takeRange(srcBytes, dstBytes, rows, rowBytes, 0, numRows);
+      return;
+    }
+
+    // Each block writes its own part of the output, so runs that cross a block boundary are
+    // just copied in two pieces.
+    const auto numBlocks = static_cast<long>((numRows + RowsPerBlock - 1) / RowsPerBlock);
+
+    #pragma omp parallel for schedule(static)
+    for (long block = 0; block < numBlocks; ++block)
+    {
+      const size_t begin = static_cast<size_t>(block) * RowsPerBlock;
+      const size_t end = std::min(begin + RowsPerBlock, numRows);
+      takeRange(srcBytes, dstBytes, rows, rowBytes, begin, end);
+    }
+  }
+
+  size_t countRuns(const std::vector<size_t>& rows, size_t begin, size_t end)
+  {
+    if (begin >= end) return 0;
+
+    size_t runs = 1;
+    for (size_t idx = begin + 1; idx < end; ++idx)
+    {
+      runs += (rows[idx] != rows[idx - 1] + 1);
+    }
+
+    return runs;
+  }
+}  // namespace bufr
@@ -0,0 +1,677 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+#include "bufr/ValidityBitmap.h"
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+// The AVX kernels are compiled with target attributes and picked at runtime from the CPU, so
+// they are used by builds for a generic x86-64 target too.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BUFR_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+#include "eckit/exception/Exceptions.h"
+
+#include "bufr/Data.h"
+#include "bufr/TakeRows.h"
+
+namespace bufr {
+
+  namespace {
+    // Tolerance used by Data::isMissing to identify missing octets.
+    const double OctetTolerance = std::numeric_limits<double>::epsilon() * MissingOctetValue * 100;
+
+    inline bool isValidOctet(double octet)
+    {
+      return !(std::fabs(octet - MissingOctetValue) <= OctetTolerance);
+    }
+
+    // The kernels below compute the validity bits for numWords * 64 consecutive values.
+    // Comparisons are unordered so that NaN counts as valid, just like the scalar code.
+    namespace scalar
+    {
+      // Branch free so the compiler is free to vectorize it for the build target.
+      template<typename T>
+      void valueWords(const T* values, T missingValue, uint64_t* words, size_t numWords)
+      {
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const T* wordValues = values + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < ValidityBitmap::WordBits; ++i)
+          {
+            word |= static_cast<uint64_t>(wordValues[i] != missingValue) << i;
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+
+      void octetWords(const double* octets, uint64_t* words, size_t numWords)
+      {
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const double* wordOctets = octets + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < ValidityBitmap::WordBits; ++i)
+          {
+            word |= static_cast<uint64_t>(isValidOctet(wordOctets[i])) << i;
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+    }  // namespace scalar
+
+#ifdef BUFR_X86_KERNELS
+    namespace avx512
+    {
+      __attribute__((target("avx512f")))
+      void floatWords(const float* values, float missingValue, uint64_t* words, size_t numWords)
+      {
+        const __m512 missing = _mm512_set1_ps(missingValue);
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const float* wordValues = values + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < 4; ++i)
+          {
+            const __m512 vals = _mm512_loadu_ps(wordValues + i * 16);
+            word |= static_cast<uint64_t>(_mm512_cmp_ps_mask(vals, missing, _CMP_NEQ_UQ))
+                    << (i * 16);
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+
+      __attribute__((target("avx512f")))
+      void doubleWords(const double* values, double missingValue, uint64_t* words,
+                       size_t numWords)
+      {
+        const __m512d missing = _mm512_set1_pd(missingValue);
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const double* wordValues = values + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < 8; ++i)
+          {
+            const __m512d vals = _mm512_loadu_pd(wordValues + i * 8);
+            word |= static_cast<uint64_t>(_mm512_cmp_pd_mask(vals, missing, _CMP_NEQ_UQ))
+                    << (i * 8);
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+
+      __attribute__((target("avx512f")))
+      void int32Words(const int32_t* values, int32_t missingValue, uint64_t* words,
+                      size_t numWords)
+      {
+        const __m512i missing = _mm512_set1_epi32(missingValue);
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const int32_t* wordValues = values + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < 4; ++i)
+          {
+            const __m512i vals = _mm512_loadu_si512(wordValues + i * 16);
+            word |= static_cast<uint64_t>(_mm512_cmpneq_epi32_mask(vals, missing)) << (i * 16);
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+
+      __attribute__((target("avx512f")))
+      void int64Words(const int64_t* values, int64_t missingValue, uint64_t* words,
+                      size_t numWords)
+      {
+        const __m512i missing = _mm512_set1_epi64(missingValue);
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const int64_t* wordValues = values + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < 8; ++i)
+          {
+            const __m512i vals = _mm512_loadu_si512(wordValues + i * 8);
+            word |= static_cast<uint64_t>(_mm512_cmpneq_epi64_mask(vals, missing)) << (i * 8);
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+
+      __attribute__((target("avx512f")))
+      void octetWords(const double* octets, uint64_t* words, size_t numWords)
+      {
+        const __m512d missing = _mm512_set1_pd(MissingOctetValue);
+        const __m512d tolerance = _mm512_set1_pd(OctetTolerance);
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const double* wordOctets = octets + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < 8; ++i)
+          {
+            const __m512d diff = _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(wordOctets + i * 8),
+                                                             missing));
+            word |= static_cast<uint64_t>(_mm512_cmp_pd_mask(diff, tolerance, _CMP_NLE_UQ))
+                    << (i * 8);
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+    }  // namespace avx512
+
+    namespace avx2
+    {
+      __attribute__((target("avx2")))
+      void floatWords(const float* values, float missingValue, uint64_t* words, size_t numWords)
+      {
+        const __m256 missing = _mm256_set1_ps(missingValue);
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const float* wordValues = values + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < 8; ++i)
+          {
+            const __m256 neq = _mm256_cmp_ps(_mm256_loadu_ps(wordValues + i * 8), missing,
+                                             _CMP_NEQ_UQ);
+            word |= static_cast<uint64_t>(_mm256_movemask_ps(neq)) << (i * 8);
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+
+      __attribute__((target("avx2")))
+      void doubleWords(const double* values, double missingValue, uint64_t* words,
+                       size_t numWords)
+      {
+        const __m256d missing = _mm256_set1_pd(missingValue);
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const double* wordValues = values + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < 16; ++i)
+          {
+            const __m256d neq = _mm256_cmp_pd(_mm256_loadu_pd(wordValues + i * 4), missing,
+                                              _CMP_NEQ_UQ);
+            word |= static_cast<uint64_t>(_mm256_movemask_pd(neq)) << (i * 4);
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+
+      __attribute__((target("avx2")))
+      void int32Words(const int32_t* values, int32_t missingValue, uint64_t* words,
+                      size_t numWords)
+      {
+        const __m256i missing = _mm256_set1_epi32(missingValue);
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const int32_t* wordValues = values + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < 8; ++i)
+          {
+            const __m256i vals =
+              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(wordValues + i * 8));
+            const __m256i eq = _mm256_cmpeq_epi32(vals, missing);
+            word |= static_cast<uint64_t>(~_mm256_movemask_ps(_mm256_castsi256_ps(eq)) & 0xFF)
+                    << (i * 8);
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+
+      __attribute__((target("avx2")))
+      void int64Words(const int64_t* values, int64_t missingValue, uint64_t* words,
+                      size_t numWords)
+      {
+        const __m256i missing = _mm256_set1_epi64x(missingValue);
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const int64_t* wordValues = values + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < 16; ++i)
+          {
+            const __m256i vals =
+              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(wordValues + i * 4));
+            const __m256i eq = _mm256_cmpeq_epi64(vals, missing);
+            word |= static_cast<uint64_t>(~_mm256_movemask_pd(_mm256_castsi256_pd(eq)) & 0xF)
+                    << (i * 4);
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+
+      __attribute__((target("avx2")))
+      void octetWords(const double* octets, uint64_t* words, size_t numWords)
+      {
+        const __m256d missing = _mm256_set1_pd(MissingOctetValue);
+        const __m256d tolerance = _mm256_set1_pd(OctetTolerance);
+        const __m256d signMask = _mm256_set1_pd(-0.0);
+        for (size_t wordIdx = 0; wordIdx < numWords; ++wordIdx)
+        {
+          const double* wordOctets = octets + wordIdx * ValidityBitmap::WordBits;
+          uint64_t word = 0;
+          for (size_t i = 0; i < 16; ++i)
+          {
+            const __m256d diff =
+              _mm256_andnot_pd(signMask,
+                               _mm256_sub_pd(_mm256_loadu_pd(wordOctets + i * 4), missing));
+            word |= static_cast<uint64_t>(
+                      _mm256_movemask_pd(_mm256_cmp_pd(diff, tolerance, _CMP_NLE_UQ))) << (i * 4);
+          }
+
+          words[wordIdx] = word;
+        }
+      }
+    }  // namespace avx2
+#endif
+
+    /// \brief The packing kernels for one instruction set.
+    struct Kernels
+    {
+      void (*floatWords)(const float*, float, uint64_t*, size_t);
+      void (*doubleWords)(const double*, double, uint64_t*, size_t);
+      void (*int32Words)(const int32_t*, int32_t, uint64_t*, size_t);
+      void (*int64Words)(const int64_t*, int64_t, uint64_t*, size_t);
+      void (*octetWords)(const double*, uint64_t*, size_t);
+    };
+
+    const Kernels ScalarKernels = {scalar::valueWords<float>,
+                                   scalar::valueWords<double>,
+                                   scalar::valueWords<int32_t>,
+                                   scalar::valueWords<int64_t>,
+                                   scalar::octetWords};
+
+#ifdef BUFR_X86_KERNELS
+    const Kernels Avx2Kernels = {avx2::floatWords,
+                                 avx2::doubleWords,
+                                 avx2::int32Words,
+                                 avx2::int64Words,
+                                 avx2::octetWords};
+
+    const Kernels Avx512Kernels = {avx512::floatWords,
+                                   avx512::doubleWords,
+                                   avx512::int32Words,
+                                   avx512::int64Words,
+                                   avx512::octetWords};
+#endif
+
+    ValidityBitmap::Simd bestSimd()
+    {
+#ifdef BUFR_X86_KERNELS
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f")) return ValidityBitmap::Simd::Avx512;
+      if (__builtin_cpu_supports("avx2")) return ValidityBitmap::Simd::Avx2;
+#endif
+      return ValidityBitmap::Simd::None;
+    }
+
+    std::atomic<ValidityBitmap::Simd>& currentSimd()
+    {
+      static std::atomic<ValidityBitmap::Simd> simd(bestSimd());
+      return simd;
+    }
+
+    const Kernels& kernels()
+    {
+      switch (currentSimd().load(std::memory_order_relaxed))
+      {
+#ifdef BUFR_X86_KERNELS
+        case ValidityBitmap::Simd::Avx512: return Avx512Kernels;
+        case ValidityBitmap::Simd::Avx2: return Avx2Kernels;
+#endif
+        default: return ScalarKernels;
+      }
+    }
+  }  // namespace
+
+  std::vector<ValidityBitmap::Simd> ValidityBitmap::supportedSimd()
+  {
+    std::vector<Simd> supported = {Simd::None};
+#ifdef BUFR_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) supported.push_back(Simd::Avx2);
+    if (__builtin_cpu_supports("avx512f")) supported.push_back(Simd::Avx512);
+#endif
+    return supported;
+  }
+
+  ValidityBitmap::Simd ValidityBitmap::simd()
+  {
+    return currentSimd().load();
+  }
+
+  void ValidityBitmap::setSimd(Simd simd)
+  {
+    const auto supported = supportedSimd();
+    if (std::find(supported.begin(), supported.end(), simd) == supported.end())
+    {
+      std::ostringstream errStr;
+      errStr << "The CPU does not support the instruction set " << static_cast<int>(simd);
+      errStr << " for the validity bitmap kernels.";
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    currentSimd().store(simd);
+  }
+
+  ValidityBitmap::ValidityBitmap(size_t size, bool valid)
+  {
+    allocate(size);
+
+    if (valid)
+    {
+      std::fill(words_.begin(), words_.end(), ~uint64_t(0));
+      if (size % WordBits != 0)
+      {
+        words_.back() = (uint64_t(1) << (size % WordBits)) - 1;
+      }
+    }
+  }
+
+  void ValidityBitmap::allocate(size_t size)
+  {
+    size_ = size;
+    words_.assign((size + WordBits - 1) / WordBits, 0);
+  }
+
+  template<typename WordKernel, typename IsValid>
+  ValidityBitmap ValidityBitmap::packWords(size_t size, WordKernel&& kernel, IsValid&& isValid)
+  {
+    ValidityBitmap bitmap;
+    bitmap.allocate(size);
+
+    const size_t numFullWords = size / WordBits;
+    kernel(bitmap.words_.data(), numFullWords);
+
+    if (numFullWords < bitmap.words_.size())
+    {
+      uint64_t word = 0;
+      for (size_t idx = numFullWords * WordBits; idx < size; ++idx)
+      {
+        word |= static_cast<uint64_t>(isValid(idx)) << (idx % WordBits);
+      }
+
+      bitmap.words_.back() = word;
+    }
+
+    return bitmap;
+  }
+
+  template<>
+  ValidityBitmap ValidityBitmap::fromValues<float>(const float* values,
+                                                   size_t size,
+                                                   float missingValue)
+  {
+    return packWords(size,
+                     [=](uint64_t* words, size_t numWords)
+                     {
+                       kernels().floatWords(values, missingValue, words, numWords);
+                     },
+                     [=](size_t idx) { return values[idx] != missingValue; });
+  }
+
+  template<>
+  ValidityBitmap ValidityBitmap::fromValues<double>(const double* values,
+                                                    size_t size,
+                                                    double missingValue)
+  {
+    return packWords(size,
+                     [=](uint64_t* words, size_t numWords)
+                     {
+                       kernels().doubleWords(values, missingValue, words, numWords);
+                     },
+                     [=](size_t idx) { return values[idx] != missingValue; });
+  }
+
+  template<>
+  ValidityBitmap ValidityBitmap::fromValues<int32_t>(const int32_t* values,
+                                                     size_t size,
+                                                     int32_t missingValue)
+  {
+    return packWords(size,
+                     [=](uint64_t* words, size_t numWords)
+                     {
+                       kernels().int32Words(values, missingValue, words, numWords);
+                     },
+                     [=](size_t idx) { return values[idx] != missingValue; });
+  }
+
+  template<>
+  ValidityBitmap ValidityBitmap::fromValues<int64_t>(const int64_t* values,
+                                                     size_t size,
+                                                     int64_t missingValue)
+  {
+    return packWords(size,
+                     [=](uint64_t* words, size_t numWords)
+                     {
+                       kernels().int64Words(values, missingValue, words, numWords);
+                     },
+                     [=](size_t idx) { return values[idx] != missingValue; });
+  }
+
+  ValidityBitmap ValidityBitmap::fromOctets(const double* octets, size_t size)
+  {
+    return packWords(size,
+                     [=](uint64_t* words, size_t numWords)
+                     {
+                       kernels().octetWords(octets, words, numWords);
+                     },
+                     [=](size_t idx) { return isValidOctet(octets[idx]); });
+  }
+
+  size_t ValidityBitmap::countValid() const
+  {
+    size_t count = 0;
+    for (const auto& word : words_)
+    {
+      count += __builtin_popcountll(word);
+    }
+
+    return count;
+  }
+
+  uint64_t ValidityBitmap::extractBits(size_t start, size_t count) const
+  {
+    const size_t wordIdx = start / WordBits;
+    const size_t bitIdx = start % WordBits;
+
+    uint64_t bits = words_[wordIdx] >> bitIdx;
+    if (bitIdx != 0 && bitIdx + count > WordBits)
+    {
+      bits |= words_[wordIdx + 1] << (WordBits - bitIdx);
+    }
+
+    return (count == WordBits) ? bits : bits & ((uint64_t(1) << count) - 1);
+  }
+
+  void ValidityBitmap::pushBits(uint64_t bits, size_t count)
+  {
+    if (count == 0) return;
+
+    if (count < WordBits)
+    {
+      bits &= (uint64_t(1) << count) - 1;
+    }
+
+    const size_t bitIdx = size_ % WordBits;
+    if (bitIdx == 0)
+    {
+      words_.push_back(bits);
+    }
+    else
+    {
+      words_.back() |= bits << bitIdx;
+      if (bitIdx + count > WordBits)
+      {
+        words_.push_back(bits >> (WordBits - bitIdx));
+      }
+    }
+
+    size_ += count;
+  }
+
+  void ValidityBitmap::appendRange(const ValidityBitmap& other, size_t start, size_t count)
+  {
+    words_.reserve((size_ + count + WordBits - 1) / WordBits);
+
+    for (size_t offset = 0; offset < count; offset += WordBits)
+    {
+      const size_t numBits = std::min(WordBits, count - offset);
+      pushBits(other.extractBits(start + offset, numBits), numBits);
+    }
+  }
+
+  ValidityBitmap ValidityBitmap::selectRows(const std::vector<size_t>& rows,
+                                            size_t rowLength) const
+  {
+    ValidityBitmap bitmap;
+    bitmap.words_.reserve((rows.size() * rowLength + WordBits - 1) / WordBits);
+
+    // Runs of at least a word of bits are appended in one go, the bits of shorter runs are
+    // collected into a word first.
+    uint64_t pending = 0;
+    size_t numPending = 0;
+
+    if (rows.size() * rowLength < WordBits * countRuns(rows, 0, rows.size()))
+    {
+      // Mostly short runs, so skip looking for them.
+      for (const auto row : rows)
+      {
+        for (size_t bit = row * rowLength; bit < (row + 1) * rowLength; ++bit)
+        {
+          pending |= static_cast<uint64_t>(isValid(bit)) << numPending;
+          if (++numPending == WordBits)
+          {
+            bitmap.pushBits(pending, WordBits);
+            pending = 0;
+            numPending = 0;
+          }
+        }
+      }
+
+      bitmap.pushBits(pending, numPending);
+      return bitmap;
+    }
+
+    size_t idx = 0;
+    while (idx < rows.size())
+    {
+      size_t runEnd = idx + 1;
+      while (runEnd < rows.size() && rows[runEnd] == rows[runEnd - 1] + 1)
+      {
+        ++runEnd;
+      }
+
+      const size_t start = rows[idx] * rowLength;
+      const size_t count = (runEnd - idx) * rowLength;
+
+      if (count >= WordBits)
+      {
+        bitmap.pushBits(pending, numPending);
+        pending = 0;
+        numPending = 0;
+
+        bitmap.appendRange(*this, start, count);
+      }
+      else
+      {
+        for (size_t bit = start; bit < start + count; ++bit)
+        {
+          pending |= static_cast<uint64_t>(isValid(bit)) << numPending;
+          if (++numPending == WordBits)
+          {
+            bitmap.pushBits(pending, WordBits);
+            pending = 0;
+            numPending = 0;
+          }
+        }
+      }
+
+      idx = runEnd;
+    }
+
+    bitmap.pushBits(pending, numPending);
+
+    return bitmap;
+  }
+
+  ValidityBitmap ValidityBitmap::repeat(size_t repeats) const
+  {
+    ValidityBitmap bitmap;
+    bitmap.words_.reserve((size_ * repeats + WordBits - 1) / WordBits);
+
+    for (size_t idx = 0; idx < size_; ++idx)
+    {
+      const uint64_t bits = isValid(idx) ? ~uint64_t(0) : 0;
+      for (size_t offset = 0; offset < repeats; offset += WordBits)
+      {
+        bitmap.pushBits(bits, std::min(WordBits, repeats - offset));
+      }
+    }
+
+    return bitmap;
+  }
+
+  ValidityBitmap& ValidityBitmap::operator&=(const ValidityBitmap& other)
+  {
+    if (other.size_ != size_)
+    {
+      std::ostringstream errStr;
+      errStr << "Can not combine validity bitmaps of different sizes (" << size_ << " and ";
+      errStr << other.size_ << ").";
+      throw eckit::BadParameter(errStr.str());
+    }
+
+    for (size_t wordIdx = 0; wordIdx < words_.size(); ++wordIdx)
+    {
+      words_[wordIdx] &= other.words_[wordIdx];
+    }
+
+    return *this;
+  }
+
+  void ValidityBitmap::fillMissingMask(bool* mask, size_t repeats) const
+  {
+    if (repeats == 1)
+    {
+      for (size_t wordIdx = 0; wordIdx < words_.size(); ++wordIdx)
+      {
+        const uint64_t word = words_[wordIdx];
+        const size_t start = wordIdx * WordBits;
+        const size_t end = std::min(start + WordBits, size_);
+
+        if (word == ~uint64_t(0))
+        {
+          std::fill(mask + start, mask + end, false);
+          continue;
+        }
+
+        for (size_t idx = start; idx < end; ++idx)
+        {
+          mask[idx] = !((word >> (idx - start)) & 1);
+        }
+      }
+    }
+    else
+    {
+      for (size_t idx = 0; idx < size_; ++idx)
+      {
+        std::fill(mask + idx * repeats, mask + (idx + 1) * repeats, isMissing(idx));
+      }
+    }
+  }
+}  // namespace bufr
@@ -2,6 +2,7 @@
 
 #include "bufr/encoders/netcdf/Encoder.h"
 
+#include <algorithm>
 #include <chrono>  // NOLINT
 #include <numeric>
 #include <map>
@@ -11,6 +12,13 @@
 
 #include <netcdf>
 
+// Only netCDF libraries built with parallel I/O have a working nc_create_par (see
+// core/CMakeLists.txt).
+#ifdef BUFR_QUERY_PARALLEL_NETCDF
+#include <mpi.h>
+#include <netcdf_par.h>
+#endif
+
 #include "eckit/exception/Exceptions.h"
 
 #include "../../bufr/Log.h"
@@ -24,6 +32,7 @@ namespace encoders {
 namespace netcdf {
     static const char* LocationName = "Location";
     static const char* DefualtDimName = "dim";
+    static const size_t WriteBlockSize = 1 << 20;  // Elements per block for streamed writes
 
 
     template<typename T>
@@ -98,6 +107,55 @@ namespace netcdf {
             var_.putVar(data.data());
         }
 
+        void writeValues(const T* data, size_t /*size*/) final
+        {
+            var_.putVar(data);
+        }
+
+        /// \brief Expand the broadcast data into blocks of rows and write each block as a
+        ///        hyperslab so the fully expanded array never has to exist in memory.
+        void writeRepeated(const std::vector<T>& data, size_t repeats) final
+        {
+            const auto dims = var_.getDims();
+            if (dims.empty())
+            {
+                return;
+            }
+
+            auto start = std::vector<size_t>(dims.size(), 0);
+            auto count = std::vector<size_t>(dims.size(), 0);
+
+            size_t rowSize = 1;
+            for (size_t dimIdx = 1; dimIdx < dims.size(); ++dimIdx)
+            {
+                count[dimIdx] = dims[dimIdx].getSize();
+                rowSize *= count[dimIdx];
+            }
+
+            const size_t numRows = dims[0].getSize();
+            const size_t numVals = data.size() * repeats;
+            const size_t blockRows =
+              std::max<size_t>(1, WriteBlockSize / std::max<size_t>(1, rowSize));
+
+            std::vector<T> buffer;
+            for (size_t row = 0; row < numRows; row += blockRows)
+            {
+                const size_t rows = std::min(blockRows, numRows - row);
+                const size_t offset = row * rowSize;
+
+                buffer.resize(rows * rowSize);
+                for (size_t idx = 0; idx < buffer.size(); ++idx)
+                {
+                    buffer[idx] = (offset + idx < numVals) ? data[(offset + idx) / repeats]
+                                                           : DataObject<T>::missingValue();
+                }
+
+                start[0] = row;
+                count[0] = rows;
+                var_.putVar(start, count, buffer.data());
+            }
+        }
+
     private:
         nc::NcVar& var_;
     };
@@ -127,17 +185,146 @@ namespace netcdf {
         var_.putVar(c_strs.data());
       }
 
+      /// \brief Write broadcast strings by pointing at the stored strings (no string copies).
+      void writeRepeated(const std::vector<std::string>& data, size_t repeats) final
+      {
+        auto c_strs = std::vector<const char*>(data.size() * repeats);
+        for (size_t i = 0; i < c_strs.size(); i++)
+        {
+          c_strs[i] = data[i / repeats].c_str();
+        }
+
+        var_.putVar(c_strs.data());
+      }
+
+      /// \brief Write packed strings by pointing into the packed characters (no string copies).
+      void writePacked(const PackedStrings& data, size_t repeats) final
+      {
+        auto c_strs = std::vector<const char*>(data.size() * repeats);
+        for (size_t i = 0; i < c_strs.size(); i++)
+        {
+          c_strs[i] = data.c_str(i / repeats);
+        }
+
+        var_.putVar(c_strs.data());
+      }
+
     private:
       nc::NcVar& var_;
     };
 
+    /// \brief Writes the rows of this rank into a variable of a file that all the ranks write
+    ///        together (see Encoder::Backend). The writes are collective, so every rank has to
+    ///        write every variable the same number of times (with no rows if it has none).
+    template <typename T>
+    class ParallelVarWriter : public ObjectWriter<T>
+    {
+    public:
+        ParallelVarWriter() = delete;
+        ParallelVarWriter(nc::NcVar& var, size_t rowOffset) : var_(var), rowOffset_(rowOffset) {}
+
+        void write(const std::vector<T>& data) final
+        {
+            writeRows(data.data(), data.size());
+        }
+
+        void writeValues(const T* data, size_t size) final
+        {
+            writeRows(data, size);
+        }
+
+        /// \brief Write whole rows of values starting at the row offset of this rank.
+        /// \param data The values.
+        /// \param numVals The number of values.
+        void writeRows(const T* data, size_t numVals)
+        {
+            const auto dims = var_.getDims();
+            if (dims.empty())
+            {
+                return;
+            }
+
+            auto start = std::vector<size_t>(dims.size(), 0);
+            auto count = std::vector<size_t>(dims.size(), 0);
+
+            size_t rowSize = 1;
+            for (size_t dimIdx = 1; dimIdx < dims.size(); ++dimIdx)
+            {
+                count[dimIdx] = dims[dimIdx].getSize();
+                rowSize *= count[dimIdx];
+            }
+
+            start[0] = rowOffset_;
+            count[0] = (rowSize > 0) ? numVals / rowSize : 0;
+
+            // Ranks with no rows still take part in the write (netCDF wants a valid pointer).
+            const T noData{};
+            var_.putVar(start, count, (count[0] > 0) ? data : &noData);
+        }
+
+    private:
+        nc::NcVar& var_;
+        const size_t rowOffset_;
+    };
+
+    /// \brief netCDF-4 file that all the ranks of a communicator create and write together
+    ///        (MPI-IO).
+    class ParallelNcFile : public nc::NcFile
+    {
+    public:
+        ParallelNcFile(const std::string& path, const eckit::mpi::Comm& comm)
+        {
+#ifdef BUFR_QUERY_PARALLEL_NETCDF
+            const int status = nc_create_par(path.c_str(),
+                                             NC_NETCDF4 | NC_CLOBBER,
+                                             MPI_Comm_f2c(comm.communicator()),
+                                             MPI_INFO_NULL,
+                                             &myId);
+            if (status != NC_NOERR)
+            {
+                std::ostringstream errStr;
+                errStr << "Could not create " << path << " for parallel writing ("
+                       << nc_strerror(status) << ").";
+                throw eckit::BadParameter(errStr.str());
+            }
+
+            nullObject = false;
+#else
+            std::ostringstream errStr;
+            errStr << "Can not write " << path << " in parallel. bufr-query was built with a ";
+            errStr << "netCDF library that has no parallel I/O.";
+            throw eckit::BadParameter(errStr.str());
+#endif
+        }
+    };
+
+    /// \brief Make every rank take part in the writes to a variable of a parallel file
+    ///        (required for compressed variables).
+    void setCollectiveAccess(const nc::NcVar& var)
+    {
+#ifdef BUFR_QUERY_PARALLEL_NETCDF
+        const int status = nc_var_par_access(var.getParentGroup().getId(),
+                                             var.getId(),
+                                             NC_COLLECTIVE);
+        if (status != NC_NOERR)
+        {
+            std::ostringstream errStr;
+            errStr << "Could not set collective access for " << var.getName() << " ("
+                   << nc_strerror(status) << ").";
+            throw eckit::BadParameter(errStr.str());
+        }
+#endif
+    }
+
     template <typename T>
     nc::NcVar createVar(std::shared_ptr<DataObject<T>>& obj,
                         nc::NcGroup& group,
                         const std::string& name,
                         const std::vector<std::string>& dimNames,
                         std::vector<size_t>& chunks,
-                        const int compressionLevel)
+                        const int compressionLevel,
+                        bool isParallel,
+                        size_t rowOffset)
     {
         auto var = group.addVar(name, encoders::netcdf::getNcType<T>().getName(), dimNames);
 
@@ -152,7 +339,18 @@ namespace netcdf {
         }
 
         addAttribute(var, _FillValue, obj->missingValue());
-        obj->write(std::make_shared<VarWriter<T>>(var));
+
+        if (!isParallel)
+        {
+            obj->write(std::make_shared<VarWriter<T>>(var));
+        }
+        else if constexpr (!std::is_same_v<T, std::string>)
+        {
+            // Strings can't be written in parallel (HDF5 has no parallel I/O for variable
+            // length data), so the encoder writes them after the parallel file is closed.
+            setCollectiveAccess(var);
+            obj->write(std::make_shared<ParallelVarWriter<T>>(var, rowOffset));
+        }
 
         return var;
     }
@@ -162,37 +360,45 @@ namespace netcdf {
                         const std::string& name,
                         const std::vector<std::string>& dimNames,
                         std::vector<size_t>& chunks,
-                        const int compressionLevel)
+                        const int compressionLevel,
+                        bool isParallel = false,
+                        size_t rowOffset = 0)
     {
         nc::NcVar var;
         if (auto fltobj = std::dynamic_pointer_cast<DataObject<float>>(object))
         {
-            var = createVar(fltobj, group, name, dimNames, chunks, compressionLevel);
+            var = createVar(fltobj, group, name, dimNames, chunks, compressionLevel,
+                            isParallel, rowOffset);
         }
         else if (auto dblobj = std::dynamic_pointer_cast<DataObject<double>>(object))
         {
-            var = createVar(dblobj, group, name, dimNames, chunks, compressionLevel);
+            var = createVar(dblobj, group, name, dimNames, chunks, compressionLevel,
+                            isParallel, rowOffset);
         }
         else if (auto intobj = std::dynamic_pointer_cast<DataObject<int32_t >>(object))
         {
-            var = createVar(intobj, group, name, dimNames, chunks, compressionLevel);
+            var = createVar(intobj, group, name, dimNames, chunks, compressionLevel,
+                            isParallel, rowOffset);
         }
         else if (auto uintobj = std::dynamic_pointer_cast<DataObject<uint32_t>>(object))
         {
-            var = createVar(uintobj, group, name, dimNames, chunks, compressionLevel);
+            var = createVar(uintobj, group, name, dimNames, chunks, compressionLevel,
+                            isParallel, rowOffset);
         }
         else if (auto int64obj = std::dynamic_pointer_cast<DataObject<int64_t>>(object))
         {
-            var = createVar(int64obj, group, name, dimNames, chunks, compressionLevel);
+            var = createVar(int64obj, group, name, dimNames, chunks, compressionLevel,
+                            isParallel, rowOffset);
         }
         else if (auto uint64obj = std::dynamic_pointer_cast<DataObject<uint64_t>>(object))
         {
-            var = createVar(uint64obj, group, name, dimNames, chunks, compressionLevel);
+            var = createVar(uint64obj, group, name, dimNames, chunks, compressionLevel,
+                            isParallel, rowOffset);
         }
         else if (auto strobj = std::dynamic_pointer_cast<DataObject<std::string>>(object))
         {
             // Can not compress string data
-            var = createVar(strobj, group, name, dimNames, chunks, 0);
+            var = createVar(strobj, group, name, dimNames, chunks, 0, isParallel, rowOffset);
         }
         else
         {
@@ -202,6 +408,52 @@ namespace netcdf {
         return var;
     }
 
+    /// \brief A string variable of a parallel file, which is written after the file is closed
+    ///        (see createVar).
+    struct DeferredStrings
+    {
+        std::string groupName;
+        std::string varName;
+        std::shared_ptr<DataObjectBase> data;
+    };
+
+    /// \brief Close the parallel files, gather the deferred string variables into rank 0 and
+    ///        write them into the reopened files from there.
+    /// \param files The parallel files (closed and removed).
+    /// \param deferredStrings The string variables of each file.
+    /// \param comm The ranks that wrote the files.
+    void writeDeferredStrings(
+        std::map<SubCategory, std::shared_ptr<nc::NcFile>>& files,
+        const std::map<std::string, std::vector<DeferredStrings>>& deferredStrings,
+        const eckit::mpi::Comm& comm)
+    {
+        for (auto& file : files)
+        {
+            file.second->close();
+        }
+
+        files.clear();
+
+        for (const auto& [fileName, vars] : deferredStrings)
+        {
+            std::vector<std::shared_ptr<DataObjectBase>> gathered;
+            for (const auto& var : vars)
+            {
+                gathered.push_back(var.data->copy());
+                gathered.back()->gather(comm);
+            }
+
+            if (comm.rank() != 0) continue;
+
+            nc::NcFile file(fileName, nc::NcFile::write);
+            for (size_t varIdx = 0; varIdx < vars.size(); ++varIdx)
+            {
+                auto var = file.getGroup(vars[varIdx].groupName).getVar(vars[varIdx].varName);
+                gathered[varIdx]->write(std::make_shared<VarWriter<std::string>>(var));
+            }
+        }
+    }
+
     Encoder::Encoder(const std::string &yamlPath) :
         description_(Description(yamlPath))
     {
@@ -226,6 +478,20 @@ namespace netcdf {
 
         std::map<SubCategory, std::shared_ptr<nc::NcFile>> obsGroups;
 
+        // For parallel files every rank has to agree on all the dimensions except Location.
+        if (backend.isParallel())
+        {
+            if (append)
+            {
+                throw eckit::BadParameter("Can not append to a file written in parallel.");
+            }
+
+            dataContainer->alignDims(*backend.comm);
+        }
+
+        // String variables of parallel files (by file name)
+        std::map<std::string, std::vector<DeferredStrings>> deferredStrings;
+
         // Get the named dimensions
         NamedPathDims namedLocDims;
         NamedPathDims namedExtraDims;
@@ -277,11 +543,59 @@ namespace netcdf {
             // Create the dimensions variables
             std::map<std::string, std::shared_ptr<DimensionDataBase>> dimMap;
 
-            auto dataObjectGroupBy = dataContainer->getGroupByObject(
+            // Only the metadata is needed until a variable is written, so with a gather in
+            // progress (see DataContainer::gatherAsync) the data is only waited for then.
+            auto dataObjectGroupBy = dataContainer->getGroupByMetadata(
                 description_.getVariables()[0].source, categories);
 
+            // Number of Locations in the file, and where the rows of this rank go in a parallel
+            // file. Dimension variables hold the same values on every rank, so only the first
+            // rank with data writes them.
+            size_t numLocs = dataObjectGroupBy->getDims()[0];
+            size_t rowOffset = 0;
+            size_t dimWriterRank = 0;
+            if (backend.isParallel())
+            {
+                const auto& comm = *backend.comm;
+                std::vector<size_t> rankLocs(comm.size());
+                comm.allGather(numLocs, rankLocs.begin(), rankLocs.end());
+
+                rowOffset = std::accumulate(rankLocs.begin(), rankLocs.begin() + comm.rank(),
+                                            size_t(0));
+                numLocs = std::accumulate(rankLocs.begin(), rankLocs.end(), size_t(0));
+
+                const auto firstWithData = std::find_if(rankLocs.begin(), rankLocs.end(),
+                                                        [](size_t locs) { return locs > 0; });
+                if (firstWithData != rankLocs.end())
+                {
+                    dimWriterRank = std::distance(rankLocs.begin(), firstWithData);
+                }
+            }
+
+            auto writeDimension = [&backend, dimWriterRank](
+                const std::shared_ptr<DimensionDataBase>& dimData,
+                nc::NcVar& dimVar)
+            {
+                if (!backend.isParallel())
+                {
+                    dimData->write(std::make_shared<VarWriter<int>>(dimVar));
+                    return;
+                }
+
+                setCollectiveAccess(dimVar);
+                auto writer = std::make_shared<ParallelVarWriter<int>>(dimVar, 0);
+                if (backend.comm->rank() == dimWriterRank)
+                {
+                    dimData->write(writer);
+                }
+                else
+                {
+                    writer->writeRows(nullptr, 0);
+                }
+            };
+
             // When we find that the primary index is zero we need to skip this category
-            if (dataObjectGroupBy->getDims()[0] == 0)
+            if (numLocs == 0)
             {
                 log::warning() << "Category (";
                 for (auto category: categories)
@@ -298,8 +612,7 @@ namespace netcdf {
             }
 
             // Create the root Location dimension for this category
-            auto rootDim = std::make_shared<DimensionData<int>>(LocationName,
-                                                                dataObjectGroupBy->getDims()[0]);
+            auto rootDim = std::make_shared<DimensionData<int>>(LocationName, numLocs);
             dimMap[LocationName] = rootDim;
 
             // Add the root Location dimension as a named dimension
@@ -338,7 +651,7 @@ namespace netcdf {
             int autoGenDimNumber = 2;
             for (const auto &varDesc: description_.getVariables())
             {
-                auto dataObject = dataContainer->get(varDesc.source, categories);
+                auto dataObject = dataContainer->getMetadata(varDesc.source, categories);
 
                 for (std::size_t dimIdx = 1; dimIdx < dataObject->getDimPaths().size(); dimIdx++)
                 {
@@ -388,14 +701,22 @@ namespace netcdf {
 
             auto fileName = makeStrWithSubstitions(path, substitutions);
 
-            auto file = std::make_shared<nc::NcFile>();
-            if (backend.isMemoryFile)
+            std::shared_ptr<nc::NcFile> file;
+            if (backend.isParallel())
             {
-              file->create(fileName, NC_NETCDF4 | NC_CLOBBER | NC_DISKLESS);
+              file = std::make_shared<ParallelNcFile>(fileName, *backend.comm);
             }
             else
             {
-              file->create(fileName, NC_NETCDF4 | NC_CLOBBER);
+              file = std::make_shared<nc::NcFile>();
+              if (backend.isMemoryFile)
+              {
+                file->create(fileName, NC_NETCDF4 | NC_CLOBBER | NC_DISKLESS);
+              }
+              else
+              {
+                file->create(fileName, NC_NETCDF4 | NC_CLOBBER);
+              }
             }
 
             // Create the Globals
@@ -436,7 +757,7 @@ namespace netcdf {
                 const auto& dim = file->addDim(dimPair.first, dimPair.second->size());
                 auto dimVar = file->addVar(dimPair.first, nc::NcType::nc_INT, dim);
                 addAttribute(dimVar, _FillValue, DataObject<int>::missingValue());
-                dimPair.second->write(std::make_shared<VarWriter<int>>(dimVar));
+                writeDimension(dimPair.second, dimVar);
             }
 
             for (const auto& dimDesc : description_.getDims())
@@ -445,7 +766,14 @@ namespace netcdf {
                 {
                     auto dataObject = dataContainer->get(dimDesc.source, categories);
 
-                    if (dataObject->size() == 0)
+                    // Every rank has to skip the same dimensions of a parallel file.
+                    size_t hasData = (dataObject->size() > 0);
+                    if (backend.isParallel())
+                    {
+                        backend.comm->allReduce(hasData, hasData, eckit::mpi::Operation::MAX);
+                    }
+
+                    if (!hasData)
                     {
                         log::warning() << "Dimension source ";
                         log::warning() << dimDesc.source;
@@ -483,14 +811,20 @@ namespace netcdf {
 
                         if (const auto obj = std::dynamic_pointer_cast<DataObject<int>>(dataObject))
                         {
-                            dimVar.putVar(obj->getRawData().data());
+                            // Only the dimension values below go into a parallel file (this
+                            // rank's data does not cover the whole dimension).
+                            if (!backend.isParallel())
+                            {
+                                obj->materialize();
+                                dimVar.putVar(obj->getDataView().data());
+                            }
                         }
                         else
                         {
                             throw eckit::BadParameter("Dimension data type not supported.");
                         }
 
-                        dimMap[dimName]->write(std::make_shared<VarWriter<int>>(dimVar));
+                        writeDimension(dimMap[dimName], dimVar);
                     }
                 }
             }
@@ -528,6 +862,11 @@ namespace netcdf {
                     auto dimVar = group.getVar(dimForDimPath(dimPath, namedPathDims).name);
 
                     auto dimChunk = static_cast<size_t>(dataObject->getDims()[dimIdx]);
+                    if (dimIdx == 0 && backend.isParallel())
+                    {
+                      dimChunk = numLocs;
+                    }
+
                     auto chunkMode = nc::NcVar::ChunkMode::nc_CHUNKED;
                     if (!dimVar.isNull())
                     {
@@ -561,7 +900,15 @@ namespace netcdf {
                                             varName,
                                             dimNames,
                                             chunks,
-                                            varDesc.compressionLevel);
+                                            varDesc.compressionLevel,
+                                            backend.isParallel(),
+                                            rowOffset);
+
+                if (backend.isParallel() &&
+                    std::dynamic_pointer_cast<DataObject<std::string>>(dataObject))
+                {
+                    deferredStrings[fileName].push_back({groupName, varName, dataObject});
+                }
 
                 var.putAtt("long_name", varDesc.longName);
                 if (!varDesc.units.empty())
@@ -584,6 +931,11 @@ namespace netcdf {
             obsGroups.insert({categories, file});
         }
 
+        if (backend.isParallel())
+        {
+            writeDeferredStrings(obsGroups, deferredStrings, *backend.comm);
+        }
+
         auto timeElapsed = std::chrono::steady_clock::now() - startTime;
         auto timeElapsedDuration = std::chrono::duration_cast<std::chrono::milliseconds>
           (timeElapsed);
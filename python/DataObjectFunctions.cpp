@@ -50,12 +50,14 @@ namespace bufr {
   template <>
   py::array pyArrayFromObj<std::string>(const std::shared_ptr<DataObject<std::string>>& obj)
   {
-    auto data = obj->getRawData();
-    py::list pyStrList(data.size());
+    const auto size = obj->size();
+    py::list pyStrList(size);
 
-    // Convert the std::vector<std::string> into a list of Python Unicode strings
-    for (size_t i = 0; i < data.size(); ++i) {
-      pyStrList[i] = py::str(data[i]);
+    // Convert the strings into a list of Python Unicode strings (expands broadcast data). The
+    // Python strings are made straight from the packed characters.
+    for (size_t i = 0; i < size; ++i) {
+      const auto str = obj->valueAt(i);
+      pyStrList[i] = py::str(str.data(), str.size());
     }
 
     // Create a NumPy array of Python Unicode strings with the correct dimensions
@@ -63,15 +65,71 @@ namespace bufr {
     py::array pyData = numpyModule.attr("array")(pyStrList, py::dtype("O"));
     pyData = pyData.attr("reshape")(obj->getDims());
 
-    // Create the mask array
+    // Create the mask array (from the shared validity bitmap)
     py::array_t<bool> mask(obj->getDims());
-    bool* maskPtr = static_cast<bool*>(mask.mutable_data());
-    for (size_t idx = 0; idx < data.size(); idx++)
+    obj->getValidity().fillMissingMask(static_cast<bool*>(mask.mutable_data()),
+                                       obj->getRepeats());
+
+    // Create a masked array from the data and mask arrays
+    py::array maskedArray = numpyModule.attr("ma").attr("masked_array")(pyData, mask);
+    numpyModule.attr("ma").attr("set_fill_value")(maskedArray, "");
+
+    return maskedArray;
+  }
+
+  py::tuple pyRaggedFromObj(const std::shared_ptr<RaggedDataObjectBase>& obj)
+  {
+    const auto& rowOffsets = obj->getRowOffsets();
+    py::array_t<int64_t> pyOffsets(rowOffsets.size());
+    std::copy(rowOffsets.begin(),
+              rowOffsets.end(),
+              static_cast<int64_t*>(pyOffsets.mutable_data()));
+
+    py::array pyValues;
+    if (const auto& strObj = std::dynamic_pointer_cast<RaggedDataObject<std::string>>(obj))
+    {
+      pyValues = pyValuesFromRaggedObj(strObj);
+    }
+    else if (const auto& intObj = std::dynamic_pointer_cast<RaggedDataObject<int>>(obj))
+    {
+      pyValues = pyValuesFromRaggedObj(intObj);
+    }
+    else if (const auto& int64Obj = std::dynamic_pointer_cast<RaggedDataObject<int64_t>>(obj))
+    {
+      pyValues = pyValuesFromRaggedObj(int64Obj);
+    }
+    else if (const auto& floatObj = std::dynamic_pointer_cast<RaggedDataObject<float>>(obj))
+    {
+      pyValues = pyValuesFromRaggedObj(floatObj);
+    }
+    else if (const auto& doubleObj = std::dynamic_pointer_cast<RaggedDataObject<double>>(obj))
+    {
+      pyValues = pyValuesFromRaggedObj(doubleObj);
+    }
+    else
     {
-      maskPtr[idx] = obj->isMissing(idx);
+      throw std::runtime_error("ResultSet Python Binding: Unsupported type encountered");
     }
 
-    // Create a masked array from the data and mask arrays
+    return py::make_tuple(pyOffsets, pyValues);
+  }
+
+  template <>
+  py::array pyValuesFromRaggedObj<std::string>(
+    const std::shared_ptr<RaggedDataObject<std::string>>& obj)
+  {
+    const auto& values = obj->getValues();
+    py::list pyStrList(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+      pyStrList[i] = py::str(values[i]);
+    }
+
+    py::object numpyModule = py::module::import("numpy");
+    py::array pyData = numpyModule.attr("array")(pyStrList, py::dtype("O"));
+
+    py::array_t<bool> mask(values.size());
+    obj->getValidity().fillMissingMask(static_cast<bool*>(mask.mutable_data()));
+
     py::array maskedArray = numpyModule.attr("ma").attr("masked_array")(pyData, mask);
     numpyModule.attr("ma").attr("set_fill_value")(maskedArray, "");
 
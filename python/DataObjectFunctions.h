@@ -13,6 +13,7 @@
 #include <pybind11/stl.h>
 
 #include "bufr/DataObject.h"
+#include "bufr/RaggedDataObject.h"
 
 namespace py = pybind11;
 
@@ -22,19 +23,25 @@ namespace bufr {
 
   template <typename T>
   py::array pyArrayFromObj(const std::shared_ptr<DataObject<T>>& obj) {
-    auto data = obj->getRawData();
+    const auto size = obj->size();
 
-    // Create the data array
+    // Create the data array (broadcast data and sliced views are expanded straight into the
+    // numpy buffer)
     py::array_t<T> pyData(obj->getDims());
     T* dataPtr = static_cast<T*>(pyData.mutable_data());
-    std::copy(data.begin(), data.end(), dataPtr);
+    if (obj->isBroadcast() || obj->isView()) {
+      for (size_t idx = 0; idx < size; idx++) {
+        dataPtr[idx] = obj->valueAt(idx);
+      }
+    } else {
+      const auto data = obj->getDataView();
+      std::copy(data.begin(), data.end(), dataPtr);
+    }
 
-    // Create the mask array
+    // Create the mask array (from the shared validity bitmap)
     py::array_t<bool> mask(obj->getDims());
-    bool* maskPtr = static_cast<bool*>(mask.mutable_data());
-    for (size_t idx = 0; idx < data.size(); idx++) {
-      maskPtr[idx] = obj->isMissing(idx);
-    }
+    obj->getValidity().fillMissingMask(static_cast<bool*>(mask.mutable_data()),
+                                       obj->getRepeats());
 
     // Create a masked array from the data and mask arrays
     py::object numpyModule = py::module::import("numpy");
@@ -47,6 +54,29 @@ namespace bufr {
   template <>
   py::array pyArrayFromObj<std::string>(const std::shared_ptr<DataObject<std::string>>& obj);
 
+  py::tuple pyRaggedFromObj(const std::shared_ptr<RaggedDataObjectBase>& obj);
+
+  template <typename T>
+  py::array pyValuesFromRaggedObj(const std::shared_ptr<RaggedDataObject<T>>& obj) {
+    const auto& values = obj->getValues();
+
+    py::array_t<T> pyData(values.size());
+    std::copy(values.begin(), values.end(), static_cast<T*>(pyData.mutable_data()));
+
+    py::array_t<bool> mask(values.size());
+    obj->getValidity().fillMissingMask(static_cast<bool*>(mask.mutable_data()));
+
+    py::object numpyModule = py::module::import("numpy");
+    py::array maskedArray  = numpyModule.attr("ma").attr("masked_array")(pyData, mask);
+    numpyModule.attr("ma").attr("set_fill_value")(maskedArray, DataObject<T>::missingValue());
+
+    return maskedArray;
+  }
+
+  template <>
+  py::array pyValuesFromRaggedObj<std::string>(
+    const std::shared_ptr<RaggedDataObject<std::string>>& obj);
+
   template <typename T>
   std::shared_ptr<DataObjectBase> _makeObject(const std::string& fieldName,
                                               const py::array& pyData,
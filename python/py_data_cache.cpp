@@ -7,19 +7,40 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/functional.h>
 
 #include <memory>
 #include <vector>
 #include <string>
 
 #include "bufr/DataCache.h"
+#include "bufr/SharedDataCache.h"
 
 namespace py = pybind11;
 
 using bufr::DataCache;
+using bufr::DataCacheStats;
+using bufr::SharedDataCache;
 
 void setupDataCache(py::module& m)
 {
+  py::class_<DataCacheStats>(m, "DataCacheStats")
+      .def_readonly("hits", &DataCacheStats::hits,
+           "Number of has or get calls that found an entry.")
+      .def_readonly("misses", &DataCacheStats::misses,
+           "Number of has or get calls that found no entry.")
+      .def_readonly("evictions", &DataCacheStats::evictions,
+           "Number of times an entry was spilled to disk.")
+      .def_readonly("reloads", &DataCacheStats::reloads,
+           "Number of times a spilled entry was read back from disk.")
+      .def_readonly("num_entries", &DataCacheStats::numEntries,
+           "Number of entries in the cache.")
+      .def_readonly("memory_bytes", &DataCacheStats::memoryBytes,
+           "Number of bytes of data held in memory (including spilled entries whose data is "
+           "still used outside the cache).")
+      .def_readonly("spilled_bytes", &DataCacheStats::spilledBytes,
+           "Number of bytes of data held in spill files.");
+
   py::class_<DataCache>(m, "DataCache")
       .def_static("has", &DataCache::has,
            py::arg("src_path"),
@@ -39,5 +60,50 @@ void setupDataCache(py::module& m)
            py::arg("src_path"),
            py::arg("map_path"),
            py::arg("category"),
-           "Mark a category as finished. Delete entry when all \"cachedCategories\" are finished.");
+           "Mark a category as finished. Delete entry when all \"cachedCategories\" are finished.")
+      .def_static("set_memory_budget", &DataCache::setMemoryBudget,
+           py::arg("bytes"),
+           "Set the number of bytes of data the cache may hold in memory.")
+      .def_static("memory_budget", &DataCache::getMemoryBudget,
+           "Get the number of bytes of data the cache may hold in memory.")
+      .def_static("set_spill_dir", &DataCache::setSpillDir,
+           py::arg("path"),
+           "Set the directory evicted entries are spilled to.")
+      .def_static("stats", &DataCache::getStats,
+           "Get the usage counters of the cache.")
+      .def_static("reset_stats", &DataCache::resetStats,
+           "Reset the hit, miss, eviction and reload counters.");
+
+  py::class_<SharedDataCache>(m, "SharedDataCache")
+      .def_static("get_or_make", [](const std::string& srcPath,
+                                    const std::string& mapPath,
+                                    const py::function& make)
+           {
+             // Other Python threads keep running while this waits for another process.
+             py::gil_scoped_release release;
+             return SharedDataCache::getOrMake(srcPath, mapPath, [&make]()
+             {
+               py::gil_scoped_acquire acquire;
+               return make().cast<std::shared_ptr<bufr::DataContainer>>();
+             });
+           },
+           py::arg("src_path"),
+           py::arg("map_path"),
+           py::arg("make"),
+           "Get the data for the given paths from shared memory, calling make to parse it (and "
+           "sharing the result with the other processes on the node) if no process has yet.")
+      .def_static("has", &SharedDataCache::has,
+           py::arg("src_path"),
+           py::arg("map_path"),
+           "Does shared memory contain finished data for the given paths.")
+      .def_static("get", &SharedDataCache::get,
+           py::arg("src_path"),
+           py::arg("map_path"),
+           py::call_guard<py::gil_scoped_release>(),
+           "Get the DataContainer for the given paths from shared memory (waits if another "
+           "process is making it).")
+      .def_static("remove", &SharedDataCache::remove,
+           py::arg("src_path"),
+           py::arg("map_path"),
+           "Remove the data for the given paths from shared memory.");
 }
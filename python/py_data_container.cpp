@@ -133,6 +133,10 @@ void setupDataContainer(py::module& m)
    .def("append", &DataContainer::append,
         py::arg("other"),
         "Append contents of another container. Must have the same category map and fields.")
+   .def_static("concat", &DataContainer::concat,
+        py::arg("containers"),
+        "Make a container with the contents of several containers one after the other. They "
+        "must have the same category map and fields.")
    .def("gather", [](DataContainer& self, bufr::mpi::Comm& comm)
         {
           return self.gather(comm.getComm());
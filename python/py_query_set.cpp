@@ -7,6 +7,7 @@
 
 #include <pybind11/pybind11.h>
 
+#include <limits>
 #include <memory>
 #include <vector>
 #include <string>
@@ -23,6 +24,13 @@ void setupQuerySet(py::module& m)
    .def(py::init<>())
    .def(py::init<const std::vector<std::string>&>())
    .def("size", &QuerySet::size, "Get the number of queries in the query set.")
-   .def("add", &QuerySet::add, "Add a query to the query set.");
+   .def("add", &QuerySet::add, "Add a query to the query set.")
+   .def("add_bounds", &QuerySet::addBounds,
+        py::arg("name"),
+        py::arg("lower_bound") = -std::numeric_limits<float>::infinity(),
+        py::arg("upper_bound") = std::numeric_limits<float>::infinity(),
+        py::arg("type") = "",
+        "Only collect the subsets where the value of the query is within the bounds (compared "
+        "in the type the query is read as, see ResultSet.get).");
 
 }
@@ -43,6 +43,19 @@ void setupResultSet(py::module& m)
         "Get a numpy array of the specified field name. If the group_by "
         "field is specified, the array is grouped by the specified field."
         "It is also possible to specify a type to override the default type.")
+   .def("get_ragged", [](const ResultSet& self,
+                         const std::string& field_name,
+                         const std::string& type)
+        {
+          return bufr::pyRaggedFromObj(self.getRagged(field_name, type));
+        },
+        py::arg("field_name"),
+        py::arg("type") = std::string(""),
+        "Get a jagged field as an (offsets, values) tuple. values is a flat masked array "
+        "holding only the values that are actually in the data and offsets (int64, one entry "
+        "per subset + 1) gives the start of each subset's values, so the values for subset i "
+        "are values[offsets[i]:offsets[i+1]]. The field may have at most one repeated "
+        "dimension. It is also possible to specify a type to override the default type.")
    .def("get_datetime", [](const ResultSet& self,
                            const std::string& year,
                            const std::string& month,
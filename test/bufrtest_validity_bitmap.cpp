@@ -0,0 +1,132 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+// Checks the packing kernels of every instruction set the CPU supports against
+// the value by value packing (ValidityBitmap::fromStrings, which uses pack).
+// The sizes are chosen so the data ends partway through a word as well as on a
+// word boundary.
+
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bufr/Data.h"
+#include "bufr/ValidityBitmap.h"
+
+namespace bufr {
+  namespace {
+    const std::vector<size_t> Sizes =
+      {0, 1, 31, 63, 64, 65, 127, 128, 200, 1000, 1023};
+
+    /// \brief Make values where about a third of them are missing.
+    template<typename T>
+    std::vector<T> makeValues(size_t size, T missingValue)
+    {
+      std::mt19937_64 gen(size);
+      std::bernoulli_distribution isMissing(1.0 / 3.0);
+
+      std::vector<T> values(size);
+      for (size_t idx = 0; idx < size; ++idx)
+      {
+        values[idx] = isMissing(gen) ? missingValue : static_cast<T>(idx % 100);
+      }
+
+      return values;
+    }
+
+    /// \brief Pack the expected bits value by value (empty strings are
+    ///        missing).
+    template<typename IsValid>
+    ValidityBitmap expectedBitmap(size_t size, IsValid&& isValid)
+    {
+      std::vector<std::string> strs(size);
+      for (size_t idx = 0; idx < size; ++idx)
+      {
+        if (isValid(idx)) strs[idx] = "x";
+      }
+
+      return ValidityBitmap::fromStrings(strs);
+    }
+
+    bool sameBits(const ValidityBitmap& bitmap,
+                  const ValidityBitmap& expected,
+                  const std::string& name,
+                  ValidityBitmap::Simd simd,
+                  size_t size)
+    {
+      if (bitmap.size() == expected.size()
+          && bitmap.getWords() == expected.getWords())
+      {
+        return true;
+      }
+
+      std::cerr << "Wrong validity bits for " << name << " values (size ";
+      std::cerr << size << ", instruction set " << static_cast<int>(simd);
+      std::cerr << ")." << std::endl;
+      return false;
+    }
+
+    template<typename T>
+    bool checkValues(const std::string& name, ValidityBitmap::Simd simd)
+    {
+      const T missingValue = std::numeric_limits<T>::max();
+
+      bool passed = true;
+      for (const auto size : Sizes)
+      {
+        const auto values = makeValues<T>(size, missingValue);
+        const auto expected = expectedBitmap(size, [&](size_t idx)
+          {
+            return values[idx] != missingValue;
+          });
+
+        const auto bitmap =
+          ValidityBitmap::fromValues<T>(values.data(), size, missingValue);
+        passed &= sameBits(bitmap, expected, name, simd, size);
+      }
+
+      return passed;
+    }
+
+    bool checkOctets(ValidityBitmap::Simd simd)
+    {
+      bool passed = true;
+      for (const auto size : Sizes)
+      {
+        const auto octets = makeValues<double>(size, MissingOctetValue);
+        const auto expected = expectedBitmap(size, [&](size_t idx)
+          {
+            return octets[idx] != MissingOctetValue;
+          });
+
+        const auto bitmap = ValidityBitmap::fromOctets(octets.data(), size);
+        passed &= sameBits(bitmap, expected, "octet", simd, size);
+      }
+
+      return passed;
+    }
+  }  // namespace
+}  // namespace bufr
+
+int main(int, char**)
+{
+  using bufr::ValidityBitmap;
+
+  bool passed = true;
+  for (const auto simd : ValidityBitmap::supportedSimd())
+  {
+    ValidityBitmap::setSimd(simd);
+    std::cout << "Checking the instruction set " << static_cast<int>(simd);
+    std::cout << std::endl;
+
+    passed &= bufr::checkValues<float>("float", simd);
+    passed &= bufr::checkValues<double>("double", simd);
+    passed &= bufr::checkValues<int32_t>("int32", simd);
+    passed &= bufr::checkValues<int64_t>("int64", simd);
+    passed &= bufr::checkOctets(simd);
+  }
+
+  return passed ? 0 : 1;
+}
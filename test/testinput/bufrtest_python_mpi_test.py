@@ -81,8 +81,66 @@ def test_mpi_all_gather():
         run_compare(OUTPUT_PATH, COMP_PATH)
 
 
+def test_mpi_mismatched_dims():
+    bufr.mpi.App(sys.argv) # Don't do this if passing in MPI communicator
+    comm = bufr.mpi.Comm("world")
+
+    # The extra dimensions of each field depend on the rank (in the second, the third and in
+    # both dimensions), so the gathered data has to be padded with missing values.
+    def shape(rank, name):
+        return {'inner': (2, 3, rank + 1),
+                'middle': (2, rank + 1, 3),
+                'both': (2, rank + 1, 2 * rank + 1)}[name]
+
+    def make_data(rank, name):
+        rows, middle, inner = shape(rank, name)
+        data = np.fromfunction(lambda i, j, k: rank * 10000 + i * 1000 + j * 10 + k,
+                               (rows, middle, inner))
+        return data.astype(np.int32)
+
+    dim_paths = ['*', '*/BRITCSTC', '*/BRITCSTC/CHNM']
+    names = ['inner', 'middle', 'both']
+
+    for gather_all in [False, True]:
+        container = bufr.DataContainer()
+        for name in names:
+            container.add(name, make_data(comm.rank(), name), dim_paths)
+            container.add(f'{name}_str', make_data(comm.rank(), name).astype(str), dim_paths)
+
+        if gather_all:
+            container.all_gather(comm)
+        else:
+            container.gather(comm)
+            if comm.rank() != 0:
+                continue
+
+        for name in names:
+            shapes = [shape(rank, name) for rank in range(comm.size())]
+            middle = max(s[1] for s in shapes)
+            inner = max(s[2] for s in shapes)
+
+            data = container.get(name)
+            strs = container.get(f'{name}_str')
+            assert data.shape == (2 * comm.size(), middle, inner)
+            assert strs.shape == data.shape
+
+            for rank, (_, rank_middle, rank_inner) in enumerate(shapes):
+                rank_data = data[2 * rank:2 * rank + 2]
+                rank_strs = strs[2 * rank:2 * rank + 2]
+                expected = make_data(rank, name)
+
+                valid = np.zeros(rank_data.shape, dtype=bool)
+                valid[:, :rank_middle, :rank_inner] = True
+
+                assert np.array_equal(rank_data.data[valid], expected.flatten())
+                assert np.array_equal(rank_strs.data[valid], expected.astype(str).flatten())
+                assert np.array_equal(rank_data.mask, ~valid)
+                assert np.array_equal(rank_strs.mask, ~valid)
+
+
 if __name__ == '__main__':
     test_mpi_basic()
     test_mpi_categories()
     test_mpi_sub_container()
     test_mpi_all_gather()
+    test_mpi_mismatched_dims()
@@ -104,6 +104,111 @@ def test_type_override():
     assert lat_int.dtype == 'int32'
     assert lat_int.fill_value == 2147483647  # the max int32 value
 
+def test_mixed_filtered_query():
+    # Only one of the query branches is filtered, so subsets with BRIT and with BRITCSTC go
+    # through different paths while the result is assembled.
+    for data_path in ['testdata/gdas.t18z.1bmhs.tm00.bufr_d',
+                      'testdata/gdas.t12z.esmhs.tm00.bufr_d']:
+        q = bufr.QuerySet()
+        q.add('radiance', '[*/BRITCSTC/TMBR, */BRIT/TMBR]')
+        q.add('radiance_filtered', '[*/BRITCSTC/TMBR, */BRIT{1-3}/TMBR]')
+
+        with bufr.File(data_path) as f:
+            r = f.execute(q)
+
+        rad = r.get('radiance')
+        rad_filtered = r.get('radiance_filtered')
+
+        assert rad_filtered.shape[0] == rad.shape[0]
+        assert rad_filtered.shape[1] <= rad.shape[1]
+        assert np.ma.allequal(rad_filtered[:, :3], rad[:, :3])
+
+def test_query_bounds():
+    DATA_PATH = 'testdata/gdas.t00z.1bhrs4.tm00.bufr_d'
+
+    q = bufr.QuerySet()
+    q.add('latitude', '*/CLAT')
+    q.add('radiance', '*/BRIT/TMBR')
+
+    with bufr.File(DATA_PATH) as f:
+        r = f.execute(q)
+
+    lat = r.get('latitude')
+    rad = r.get('radiance')
+    in_bounds = (lat >= 20.0) & (lat <= 55.0)
+
+    # Subsets outside the bounds are dropped while the file is read
+    q.add_bounds('latitude', lower_bound=20.0, upper_bound=55.0)
+    with bufr.File(DATA_PATH) as f:
+        r_bounded = f.execute(q)
+
+    lat_bounded = r_bounded.get('latitude')
+    assert 0 < lat_bounded.shape[0] < lat.shape[0]
+    assert np.allclose(lat_bounded, lat[in_bounds])
+    assert np.allclose(r_bounded.get('radiance'), rad[in_bounds])
+
+    # Queries with several values per subset are not checked
+    q.add_bounds('radiance', upper_bound=0.0)
+    with bufr.File(DATA_PATH) as f:
+        assert f.execute(q).get('latitude').shape == lat_bounded.shape
+
+    # Integer fields are compared as integers (missing values as the int32 fill value)
+    q = bufr.QuerySet()
+    q.add('fov', '*/FOVN')
+    q.add('latitude', '*/CLAT')
+
+    with bufr.File(DATA_PATH) as f:
+        r = f.execute(q)
+
+    fov = r.get('fov')
+    lat_int = r.get('latitude', type='int')
+    assert fov.dtype == 'int32'
+
+    q.add_bounds('fov', lower_bound=10.0, upper_bound=20.0)
+    with bufr.File(DATA_PATH) as f:
+        fov_bounded = f.execute(q).get('fov')
+
+    assert 0 < fov_bounded.shape[0] < fov.shape[0]
+    assert np.array_equal(fov_bounded.data, fov.data[(fov.data >= 10) & (fov.data <= 20)])
+
+    # So are fields read with an integer override type
+    q = bufr.QuerySet()
+    q.add('fov', '*/FOVN')
+    q.add('latitude', '*/CLAT')
+    q.add_bounds('latitude', lower_bound=20.0, upper_bound=55.0, type='int')
+    with bufr.File(DATA_PATH) as f:
+        lat_bounded = f.execute(q).get('latitude', type='int')
+
+    in_bounds = (lat_int.data >= 20) & (lat_int.data <= 55)
+    assert np.array_equal(lat_bounded.data, lat_int.data[in_bounds])
+
+
+def test_ragged_field():
+    DATA_PATH = 'testdata/gdas.t12z.adpupa.tm00.bufr_d'
+
+    # Make the QuerySet for all the data we want
+    q = bufr.QuerySet()
+    q.add('pressure', '*/UARLV/PRLC')
+
+    # Open the BUFR file and execute the QuerySet
+    with bufr.File(DATA_PATH) as f:
+        r = f.execute(q)
+
+    pressure = r.get('pressure')
+    offsets, values = r.get_ragged('pressure')
+
+    assert offsets.dtype == 'int64'
+    assert len(offsets) == pressure.shape[0] + 1
+    assert offsets[-1] == len(values)
+    assert values.dtype == pressure.dtype
+
+    # Each ragged row matches the start of the padded row and the rest of it is padding
+    for row in range(pressure.shape[0]):
+        row_vals = values[offsets[row]:offsets[row + 1]]
+        assert np.ma.allequal(row_vals, pressure[row, :len(row_vals)])
+        assert np.all(pressure[row, len(row_vals):].mask)
+
+
 def test_invalid_query():
     q = bufr.QuerySet()
 
@@ -176,6 +281,86 @@ def test_highlevel_append():
     assert orig_data.shape == data.shape
     assert np.allclose(orig_data, data)
 
+def test_highlevel_transforms():
+    DATA_PATH = 'testdata/gdas.t00z.1bhrs4.tm00.bufr_d'
+    YAML_PATH = 'testinput/bufrtest_transforms_mapping.yaml'
+
+    container = bufr.Parser(DATA_PATH, YAML_PATH).parse()
+
+    # Float fields get the chain folded algebraically (equal up to rounding)
+    lat = container.get('variables/latitude')
+    assert np.ma.allclose(container.get('variables/latitudeChained'), lat * 10, atol=1e-3)
+    assert np.ma.allclose(container.get('variables/latitudeClamped'),
+                          np.clip(lat * 2, -30, 30))
+
+    # Integer fields only get the integer part of each offset, just like applying the steps
+    # one at a time.
+    channel = container.get('variables/channel')
+    assert channel.dtype == np.int32
+    assert np.ma.allequal(container.get('variables/channelChained'), channel * 10)
+    assert np.ma.allequal(container.get('variables/channelClamped'),
+                          np.clip(channel * 2 - 1, 5, 20))
+
+def test_highlevel_concat():
+    DATA_PATH = 'testdata/gdas.t00z.1bhrs4.tm00.bufr_d'
+    YAML_PATH = 'testinput/bufrtest_hrs_basic_mapping.yaml'
+
+    container = bufr.Parser(DATA_PATH, YAML_PATH).parse()
+
+    new_container = bufr.DataContainer.concat([container, bufr.DataContainer(), container,
+                                              container])
+
+    for var in ['variables/brightnessTemp', 'variables/latitude']:
+        data = new_container.get(var)
+
+        orig_data = container.get(var)
+        orig_data = np.concatenate((orig_data, orig_data, orig_data))
+
+        assert orig_data.shape == data.shape
+        assert np.allclose(orig_data, data)
+
+def test_highlevel_expression_filter():
+    DATA_PATH = 'testdata/gdas.t18z.1bmhs.tm00.bufr_d'
+    BOUNDING_YAML_PATH = 'testinput/bufrtest_filtering_mapping.yaml'
+    EXPRESSION_YAML_PATH = 'testinput/bufrtest_expression_filter_mapping.yaml'
+
+    # The expression keeps the same rows as the list of bounding filters
+    bounded = bufr.Parser(DATA_PATH, BOUNDING_YAML_PATH).parse()
+    filtered = bufr.Parser(DATA_PATH, EXPRESSION_YAML_PATH).parse()
+
+    for var in ['latitude', 'longitude', 'brightnessTemperature']:
+        bounded_data = bounded.get(f'variables/{var}')
+        filtered_data = filtered.get(f'variables/{var}')
+
+        assert bounded_data.shape[0] > 0
+        assert filtered_data.shape == bounded_data.shape
+        assert np.allclose(filtered_data, bounded_data)
+
+def test_highlevel_grid_split():
+    DATA_PATH = 'testdata/gdas.t18z.1bmhs.tm00.bufr_d'
+    YAML_PATH = 'testinput/bufrtest_grid_split_mapping.yaml'
+    BASIC_YAML_PATH = 'testinput/bufrtest_mhs_basic_mapping.yaml'
+
+    container = bufr.Parser(DATA_PATH, YAML_PATH).parse()
+    all_data = bufr.Parser(DATA_PATH, BASIC_YAML_PATH).parse()
+
+    categories = container.all_sub_categories()
+    assert len(categories) == 6 * 8
+
+    num_rows = 0
+    for category in categories:  # [lat_-90_-60__lon_-180_-135]
+        lat_range, lon_range = category[0][len('lat_'):].split('__lon_')
+        lat_min, lat_max = [float(val) for val in lat_range.split('_', 1)]
+        lon_min, lon_max = [float(val) for val in lon_range.split('_', 1)]
+
+        lat = container.get('variables/latitude', category)
+        lon = container.get('variables/longitude', category)
+        assert np.all((lat >= lat_min) & (lat <= lat_max))
+        assert np.all((lon >= lon_min) & (lon <= lon_max))
+        num_rows += lat.shape[0]
+
+    assert num_rows == all_data.get('variables/latitude').shape[0]
+
 def test_highlevel_w_category():
     DATA_PATH = 'testdata/gdas.t12z.1bamua.tm00.bufr_d'
     YAML_PATH = 'testinput/bufrtest_amua_ta_mapping.yaml'
@@ -201,6 +386,22 @@ def test_highlevel_w_category():
 
         assert np.allclose(obs_orig, obs_new)
 
+def test_highlevel_sub_container():
+    DATA_PATH = 'testdata/gdas.t12z.1bamua.tm00.bufr_d'
+    YAML_PATH = 'testinput/bufrtest_amua_ta_mapping.yaml'
+
+    container = bufr.Parser(DATA_PATH, YAML_PATH).parse()
+
+    for category in container.all_sub_categories():
+        sub_container = container.get_sub_container(category)
+        assert sub_container.all_sub_categories() == [category]
+
+        for var in container.list():
+            data = container.get(var, category)
+            sub_data = sub_container.get(var, category)
+            assert data.shape == sub_data.shape
+            assert np.array_equal(data, sub_data)
+
 def test_highlevel_cache():
     DATA_PATH = 'testdata/gdas.t12z.1bamua.tm00.bufr_d'
     YAML_PATH = 'testinput/bufrtest_amua_ta_mapping.yaml'
@@ -228,18 +429,137 @@ def test_highlevel_cache():
         assert False, "Data Cache still contains entry."
 
 
+def test_highlevel_cache_spill():
+    DATA_PATH = 'testdata/gdas.t12z.1bamua.tm00.bufr_d'
+    YAML_PATH = 'testinput/bufrtest_amua_ta_mapping.yaml'
+    OTHER_YAML_PATH = 'testinput/bufrtest_amua_ta_mapping_copy.yaml'  # only a cache key
+
+    budget = bufr.DataCache.memory_budget()
+    bufr.DataCache.set_spill_dir('testrun')
+    bufr.DataCache.reset_stats()
+
+    dat = bufr.Parser(DATA_PATH, YAML_PATH).parse()
+    categories = dat.all_sub_categories()
+
+    # Only room for one entry, so adding the second one spills the first to disk (the cache
+    # holds the only reference to the added containers)
+    bufr.DataCache.add(DATA_PATH, YAML_PATH, categories, bufr.Parser(DATA_PATH, YAML_PATH).parse())
+    entry_bytes = bufr.DataCache.stats().memory_bytes
+    bufr.DataCache.set_memory_budget(entry_bytes)
+    bufr.DataCache.add(DATA_PATH, OTHER_YAML_PATH, categories,
+                       bufr.Parser(DATA_PATH, YAML_PATH).parse())
+
+    stats = bufr.DataCache.stats()
+    assert stats.num_entries == 2
+    assert stats.evictions == 1
+    assert stats.spilled_bytes == entry_bytes
+    assert stats.memory_bytes == entry_bytes
+
+    # Getting the spilled entry reads it back (and spills the other one)
+    assert bufr.DataCache.has(DATA_PATH, YAML_PATH)
+    cache_dat = bufr.DataCache.get(DATA_PATH, YAML_PATH)
+    for category in categories:
+        assert np.array_equal(dat.get('variables/antennaTemperature', category),
+                              cache_dat.get('variables/antennaTemperature', category))
+
+    stats = bufr.DataCache.stats()
+    assert stats.hits == 2
+    assert stats.reloads == 1
+    assert stats.evictions == 2
+    assert stats.memory_bytes == entry_bytes
+
+    # An entry spilled while its data is still in use (cache_dat) is still counted as memory
+    other_dat = bufr.DataCache.get(DATA_PATH, OTHER_YAML_PATH)
+    stats = bufr.DataCache.stats()
+    assert stats.reloads == 2
+    assert stats.evictions == 3
+    assert stats.memory_bytes == 2 * entry_bytes
+
+    # Getting it again takes that data back instead of reading the spill file (and spills the
+    # other entry, which is no longer used so its memory is freed)
+    del other_dat
+    cache_dat_again = bufr.DataCache.get(DATA_PATH, YAML_PATH)
+    stats = bufr.DataCache.stats()
+    assert stats.reloads == 2
+    assert stats.evictions == 4
+    assert stats.memory_bytes == entry_bytes
+    for category in categories:
+        assert np.array_equal(cache_dat.get('variables/antennaTemperature', category),
+                              cache_dat_again.get('variables/antennaTemperature', category))
+
+    # The memory of a spilled entry is freed once its data is no longer used
+    other_dat = bufr.DataCache.get(DATA_PATH, OTHER_YAML_PATH)
+    assert bufr.DataCache.stats().memory_bytes == 2 * entry_bytes
+
+    del cache_dat, cache_dat_again
+    assert bufr.DataCache.stats().memory_bytes == entry_bytes
+
+    for category in categories:
+        bufr.DataCache.mark_finished(DATA_PATH, YAML_PATH, category)
+        bufr.DataCache.mark_finished(DATA_PATH, OTHER_YAML_PATH, category)
+
+    stats = bufr.DataCache.stats()
+    assert stats.num_entries == 0
+    assert stats.memory_bytes == 0
+    assert stats.spilled_bytes == 0
+
+    bufr.DataCache.set_memory_budget(budget)
+
+
+def test_highlevel_shared_cache():
+    DATA_PATH = 'testdata/gdas.t12z.1bamua.tm00.bufr_d'
+    YAML_PATH = 'testinput/bufrtest_amua_ta_mapping.yaml'
+
+    bufr.SharedDataCache.remove(DATA_PATH, YAML_PATH)
+    assert not bufr.SharedDataCache.has(DATA_PATH, YAML_PATH)
+
+    dat = bufr.SharedDataCache.get_or_make(DATA_PATH, YAML_PATH,
+                                           lambda: bufr.Parser(DATA_PATH, YAML_PATH).parse())
+    assert bufr.SharedDataCache.has(DATA_PATH, YAML_PATH)
+
+    def parse_again():
+        assert False, "Shared cache entry was not used."
+
+    shared_dat = bufr.SharedDataCache.get_or_make(DATA_PATH, YAML_PATH, parse_again)
+
+    assert shared_dat.all_sub_categories() == dat.all_sub_categories()
+    for category in dat.all_sub_categories():
+        assert np.array_equal(dat.get('variables/antennaTemperature', category),
+                              shared_dat.get('variables/antennaTemperature', category))
+        assert shared_dat.get_paths('variables/antennaTemperature', category) == \
+            dat.get_paths('variables/antennaTemperature', category)
+
+    bufr.SharedDataCache.remove(DATA_PATH, YAML_PATH)
+    assert not bufr.SharedDataCache.has(DATA_PATH, YAML_PATH)
+
+    # The columns that point into the shared memory stay valid after the entry is removed
+    for category in dat.all_sub_categories():
+        assert np.array_equal(dat.get('variables/antennaTemperature', category),
+                              shared_dat.get('variables/antennaTemperature', category))
+
+
 if __name__ == '__main__':
     # Low level interface tests
     test_basic_query()
     test_string_field()
     test_long_str_field()
     test_type_override()
+    test_mixed_filtered_query()
+    test_query_bounds()
+    test_ragged_field()
     test_invalid_query()
 
     # High level interface tests
     test_highlevel_replace()
     test_highlevel_add()
     test_highlevel_w_category()
+    test_highlevel_sub_container()
+    test_highlevel_expression_filter()
+    test_highlevel_grid_split()
     test_highlevel_cache()
+    test_highlevel_cache_spill()
+    test_highlevel_shared_cache()
     test_highlevel_append()
+    test_highlevel_transforms()
+    test_highlevel_concat()
 
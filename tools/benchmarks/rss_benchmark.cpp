@@ -0,0 +1,193 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+// Memory benchmark for a full conversion (ex: a large MHS or IASI file). The file is parsed,
+// every column is read the way the filters, the encoder and the Python bindings read them,
+// and the result is optionally written to netCDF. The peak RSS is printed after each step.
+//
+// With --copy every column is read through a copy (getRawData, which is what the consumers
+// did before the data views), otherwise through getDataView. Run the two modes as separate
+// processes since the peak RSS of a process never goes down:
+//
+//   rss_benchmark.x --copy gdas.t12z.mtiasi.tm00.bufr_d mtiasi_mapping.yaml
+//   rss_benchmark.x gdas.t12z.mtiasi.tm00.bufr_d mtiasi_mapping.yaml
+
+#include <sys/resource.h>
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "eckit/config/YAMLConfiguration.h"
+#include "eckit/filesystem/PathName.h"
+#include "eckit/runtime/Main.h"
+
+#include "bufr/BufrParser.h"
+#include "bufr/DataContainer.h"
+#include "bufr/DataObject.h"
+#include "bufr/encoders/netcdf/Encoder.h"
+
+namespace bufr {
+  namespace {
+    class App : public eckit::Main
+    {
+     public:
+      App(int argc, char **argv) : eckit::Main(argc, argv)
+      {
+        name_ = "rss_benchmark";
+      }
+    };
+
+    /// \brief Peak resident set size of the process so far (MB).
+    double peakRssMb()
+    {
+      struct rusage usage;
+      getrusage(RUSAGE_SELF, &usage);
+      return usage.ru_maxrss / 1024.0;  // ru_maxrss is in KB on Linux
+    }
+
+    void printPeakRss(const std::string& step)
+    {
+      std::cout << std::left << std::setw(24) << step << std::right << std::fixed
+                << std::setprecision(1) << std::setw(10) << peakRssMb() << " MB" << std::endl;
+    }
+
+    /// \brief Read every value of a typed column. The copies are kept until all the columns
+    ///        have been read, like a consumer that holds on to its copy while it works.
+    template<typename T>
+    bool readColumn(const std::shared_ptr<DataObjectBase>& obj,
+                    bool copy,
+                    std::vector<std::shared_ptr<void>>& copies,
+                    double& checksum)
+    {
+      auto typedObj = std::dynamic_pointer_cast<DataObject<T>>(obj);
+      if (!typedObj) return false;
+
+      if (copy)
+      {
+        auto values = std::make_shared<std::vector<T>>(typedObj->getRawData());
+        for (const auto& value : *values) checksum += static_cast<double>(value);
+        copies.push_back(values);
+      }
+      else
+      {
+        typedObj->materialize();
+        for (const auto& value : typedObj->getDataView()) checksum += static_cast<double>(value);
+      }
+
+      return true;
+    }
+
+    template<>
+    bool readColumn<std::string>(const std::shared_ptr<DataObjectBase>& obj,
+                                 bool copy,
+                                 std::vector<std::shared_ptr<void>>& copies,
+                                 double& checksum)
+    {
+      auto typedObj = std::dynamic_pointer_cast<DataObject<std::string>>(obj);
+      if (!typedObj) return false;
+
+      if (copy)
+      {
+        auto values = std::make_shared<std::vector<std::string>>(typedObj->getRawData());
+        for (const auto& value : *values) checksum += static_cast<double>(value.size());
+        copies.push_back(values);
+      }
+      else
+      {
+        typedObj->materialize();
+        const auto& values = typedObj->getDataView();
+        for (size_t idx = 0; idx < values.size(); ++idx)
+        {
+          checksum += static_cast<double>(values[idx].size());
+        }
+      }
+
+      return true;
+    }
+  }  // namespace
+}  // namespace bufr
+
+static void showHelp()
+{
+  std::cerr << "Usage: rss_benchmark.x [--copy] [-t TABLE_PATH] SRC_FILE MAPPING_FILE"
+            << " [OUT_FILE]\n"
+            << "Options:\n"
+            << "  --copy, Read the columns through copies (getRawData) instead of views.\n"
+            << "  -t TABLE_PATH,  Path to BUFR table files (use with WMO BUFR files)\n"
+            << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+  using namespace bufr;  // NOLINT
+
+  bool copy = false;
+  std::string tablePath;
+  std::vector<std::string> args;
+  for (int argIdx = 1; argIdx < argc; ++argIdx)
+  {
+    if (strcmp(argv[argIdx], "--copy") == 0)
+    {
+      copy = true;
+    }
+    else if (strcmp(argv[argIdx], "-t") == 0 && argIdx + 1 < argc)
+    {
+      tablePath = argv[++argIdx];
+    }
+    else
+    {
+      args.push_back(argv[argIdx]);
+    }
+  }
+
+  if (args.size() < 2 || args.size() > 3)
+  {
+    showHelp();
+    return 1;
+  }
+
+  App app(argc, argv);
+  const eckit::YAMLConfiguration yaml{eckit::PathName(args[1])};
+
+  std::cout << "Peak RSS (" << (copy ? "copies" : "views") << ")" << std::endl;
+  printPeakRss("start");
+
+  auto data = BufrParser(args[0], yaml.getSubConfiguration("bufr"), tablePath).parse();
+  printPeakRss("parse");
+
+  double checksum = 0;
+  std::vector<std::shared_ptr<void>> copies;
+  for (const auto& category : data->allSubCategories())
+  {
+    for (const auto& fieldName : data->getFieldNames())
+    {
+      const auto obj = data->get(fieldName, category);
+      if (!(readColumn<float>(obj, copy, copies, checksum)
+            || readColumn<double>(obj, copy, copies, checksum)
+            || readColumn<int32_t>(obj, copy, copies, checksum)
+            || readColumn<int64_t>(obj, copy, copies, checksum)
+            || readColumn<uint32_t>(obj, copy, copies, checksum)
+            || readColumn<uint64_t>(obj, copy, copies, checksum)
+            || readColumn<std::string>(obj, copy, copies, checksum)))
+      {
+        std::cerr << "Skipping " << fieldName << " (unknown type)" << std::endl;
+      }
+    }
+  }
+
+  printPeakRss("read columns");
+  copies.clear();
+
+  if (args.size() == 3)
+  {
+    auto backend = encoders::netcdf::Encoder::Backend(false, args[2]);
+    encoders::netcdf::Encoder(yaml.getSubConfiguration("encoder")).encode(data, backend);
+    printPeakRss("encode");
+  }
+
+  std::cout << "(checksum " << checksum << ")" << std::endl;
+  return 0;
+}
@@ -0,0 +1,155 @@
+// (C) Copyright 2024 NOAA/NWS/NCEP/EMC
+
+// Micro benchmark for DataObject::slice (followed by materialize, which is where the rows are
+// actually copied). Rows are kept either at random or in long runs (like a bounding filter on
+// sorted data) at 1%, 50% and 99% selectivity, for numeric and string columns.
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bufr/DataObject.h"
+
+namespace bufr {
+  namespace {
+    constexpr size_t NumTrials = 5;
+    constexpr size_t MeanRunLength = 1000;
+
+    /// \brief Pick rows to keep (at random or in runs) so that about `fraction` of them are kept.
+    std::vector<size_t> makeSelection(size_t numRows, double fraction, bool runs)
+    {
+      std::mt19937_64 gen(42);
+      std::vector<size_t> rows;
+      rows.reserve(static_cast<size_t>(numRows * fraction) + 1);
+
+      if (!runs)
+      {
+        std::bernoulli_distribution keep(fraction);
+        for (size_t row = 0; row < numRows; ++row)
+        {
+          if (keep(gen)) rows.push_back(row);
+        }
+
+        return rows;
+      }
+
+      // Alternate kept and dropped runs with exponential lengths.
+      std::exponential_distribution<double> keptLength(1.0 / (MeanRunLength * fraction));
+      std::exponential_distribution<double> droppedLength(1.0 / (MeanRunLength * (1 - fraction)));
+
+      size_t row = 0;
+      while (row < numRows)
+      {
+        const auto kept = static_cast<size_t>(keptLength(gen)) + 1;
+        for (size_t idx = 0; idx < kept && row < numRows; ++idx, ++row)
+        {
+          rows.push_back(row);
+        }
+
+        row += static_cast<size_t>(droppedLength(gen)) + 1;
+      }
+
+      return rows;
+    }
+
+    /// \brief Best time in ms to slice the object and materialize the result.
+    double timeSlice(const std::shared_ptr<DataObjectBase>& obj, const std::vector<size_t>& rows)
+    {
+      double best = std::numeric_limits<double>::max();
+      for (size_t trial = 0; trial < NumTrials; ++trial)
+      {
+        const auto startTime = std::chrono::steady_clock::now();
+
+        auto sliced = obj->slice(rows);
+        sliced->materialize();
+
+        const std::chrono::duration<double, std::milli> elapsed =
+          std::chrono::steady_clock::now() - startTime;
+        best = std::min(best, elapsed.count());
+      }
+
+      return best;
+    }
+
+    std::shared_ptr<DataObjectBase> makeFloatObject(size_t numRows, int rowLength)
+    {
+      std::vector<float> data(numRows * rowLength);
+      for (size_t idx = 0; idx < data.size(); ++idx)
+      {
+        data[idx] = static_cast<float>(idx % 1000);
+      }
+
+      auto obj = std::make_shared<DataObject<float>>();
+      obj->setData(std::move(data));
+      obj->setDims({static_cast<int>(numRows), rowLength});
+      return obj;
+    }
+
+    std::shared_ptr<DataObjectBase> makeStringObject(size_t numRows, size_t strLength)
+    {
+      std::vector<std::string> data(numRows);
+      for (size_t idx = 0; idx < numRows; ++idx)
+      {
+        data[idx] = std::to_string(idx);
+        data[idx].resize(strLength, 'X');
+      }
+
+      auto obj = std::make_shared<DataObject<std::string>>();
+      obj->setData(data);
+      obj->setDims({static_cast<int>(numRows)});
+      return obj;
+    }
+  }  // namespace
+}  // namespace bufr
+
+int main(int argc, char **argv)
+{
+  using namespace bufr;  // NOLINT
+
+  size_t numRows = 4000000;
+  if (argc > 1)
+  {
+    numRows = std::strtoul(argv[1], nullptr, 10);
+  }
+
+  const std::vector<std::pair<std::string, std::shared_ptr<DataObjectBase>>> columns = {
+    {"float", makeFloatObject(numRows, 1)},
+    {"float x16", makeFloatObject(numRows / 16, 16)},
+    {"string (8 chars)", makeStringObject(numRows, 8)},
+    {"string (24 chars)", makeStringObject(numRows, 24)},
+  };
+
+  std::cout << "Slice + materialize, " << numRows << " rows, best of " << NumTrials
+            << " trials (ms)" << std::endl;
+  std::cout << std::left << std::setw(20) << "column" << std::setw(10) << "pattern"
+            << std::right << std::setw(10) << "1%" << std::setw(10) << "50%"
+            << std::setw(10) << "99%" << std::endl;
+
+  for (const auto& column : columns)
+  {
+    const size_t columnRows = column.second->getDims()[0];
+    for (const bool runs : {false, true})
+    {
+      std::cout << std::left << std::setw(20) << column.first
+                << std::setw(10) << (runs ? "runs" : "random") << std::right << std::fixed
+                << std::setprecision(2);
+
+      for (const double fraction : {0.01, 0.5, 0.99})
+      {
+        const auto rows = makeSelection(columnRows, fraction, runs);
+        std::cout << std::setw(10) << timeSlice(column.second, rows);
+      }
+
+      std::cout << std::endl;
+    }
+  }
+
+  return 0;
+}
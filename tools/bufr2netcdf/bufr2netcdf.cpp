@@ -103,7 +103,8 @@ namespace mpi {
                        const std::string& mappingFile,
                        const std::string& outputFile,
                        const std::string& tablePath = "",
-                       bool separateFiles = false)
+                       bool separateFiles = false,
+                       bool parallelWrite = false)
   {
     auto startTime = std::chrono::steady_clock::now();
 
@@ -127,9 +128,18 @@ namespace mpi {
       auto encoderConf = yaml->getSubConfiguration("encoder");
       encoders::netcdf::Encoder(encoderConf).encode(data, backend);
     }
+    else if (parallelWrite)
+    {
+      // Every task writes its own rows into the one output file.
+      auto backend = encoders::netcdf::Encoder::Backend(outputFile, comm);
+
+      auto encoderConf = yaml->getSubConfiguration("encoder");
+      encoders::netcdf::Encoder(encoderConf).encode(data, backend);
+    }
     else
     {
-      data->gather(comm);
+      // Rank 0 writes each variable as soon as its data has arrived.
+      data->gatherAsync(comm);
 
       if (comm.rank() == 0)
       {
@@ -138,6 +148,9 @@ namespace mpi {
         auto encoderConf = yaml->getSubConfiguration("encoder");
         encoders::netcdf::Encoder(encoderConf).encode(data, backend);
       }
+
+      // Every rank has to finish its part of the gather before MPI is finalized.
+      data->waitForGather();
     }
 
     comm.barrier();
@@ -156,6 +169,9 @@ static void showHelp()
               << "Options:\n"
               << "  -h,  Show this help message\n"
               << "  --no-gather, Don't gather the data into 1 output file. Makes 1 file per task.\n"
+              << "  --parallel, Write 1 output file from all the tasks with parallel netCDF\n"
+              << "              (needs netCDF built with parallel I/O, strings are still\n"
+              << "              written from rank 0).\n"
               << "  -t TABLE_PATH,  Path to BUFR table files (use with WMO BUFR files)\n"
               << "  -n NUM_MESSAGES,  Number of BUFR messages to parse.\n"
               << "Example:\n"
@@ -186,6 +202,7 @@ int main(int argc, char **argv)
     };
 
     bool separateFiles = false;
+    bool parallelWrite = false;
     auto reqArgIdx = ReqArgType::ObsFile;
     std::size_t argIdx = 1;
     while (argIdx < static_cast<std::size_t> (argc))
@@ -222,6 +239,10 @@ int main(int argc, char **argv)
         {
           separateFiles = true;
           argIdx += 1;
+        } else if (strcmp(argv[argIdx], "--parallel") == 0)
+        {
+          parallelWrite = true;
+          argIdx += 1;
         } else
         {
             switch (reqArgIdx)
@@ -252,7 +273,8 @@ int main(int argc, char **argv)
                      mappingFile,
                      outputFile,
                      tablePath,
-                     separateFiles);
+                     separateFiles,
+                     parallelWrite);
     }
     else
     {
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# run a converter on several MPI tasks and use nccmp to compare its output with the reference
+# output of the serial run
+#
+# argument 1: the command to launch MPI tasks (ex: "mpiexec -n 4")
+# argument 2: the command to run the converter
+# argument 3: the filename the converter writes (in testrun)
+# argument 4: the reference filename to compare with (in testoutput)
+
+set -eu
+
+mpi_cmd=$1
+cmd=$2
+file_name=$3
+ref_file_name=$4
+tol=${5:-"0.0"}
+verbose=${6:-${VERBOSE:-"N"}}
+
+[[ $verbose == [YyTt] || \
+   $verbose == [Yy][Ee][Ss] || \
+   $verbose == [Tt][Rr][Uu][Ee] ]] && set -x
+
+$mpi_cmd $cmd && \
+nccmp testrun/$file_name testoutput/$ref_file_name -d -m -g -f -S -T ${tol}
+rc=${?}
+
+exit $rc